@@ -29,6 +29,22 @@ def handler(request):
                 'body': json.dumps({'error': 'Missing strategy or data'})
             }
         
+        # Forward to a running `fluxback serve` process when configured;
+        # it keeps parsed data and indicators warm between requests
+        server_url = os.environ.get('FLUXBACK_SERVER_URL')
+        if server_url:
+            import urllib.request
+            forward = urllib.request.Request(
+                server_url.rstrip('/') + '/api/backtest',
+                data=json.dumps({'strategy': strategy_yaml, 'data': csv_data}).encode(),
+                headers={'Content-Type': 'application/json'}
+            )
+            with urllib.request.urlopen(forward) as response:
+                return {
+                    'statusCode': response.status,
+                    'body': response.read().decode()
+                }
+        
         # Try to import fluxback_py (Python bindings)
         try:
             import fluxback_py
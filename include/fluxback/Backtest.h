@@ -0,0 +1,131 @@
+#pragma once
+
+// FluxBack embedding API: run backtests from another C++ program on bars
+// it already holds in memory. This header only depends on the standard
+// library; link against FluxBack::fluxback_core (see BUILD.md).
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fluxback {
+namespace api {
+
+// Bumped whenever a type or signature in this header changes
+constexpr int VERSION = 1;
+
+struct Bar {
+    int64_t time = 0; // exchange-local wall-clock time, seconds since 1970-01-01
+    double open = 0.0;
+    double high = 0.0;
+    double low = 0.0;
+    double close = 0.0;
+    int64_t volume = 0;
+};
+
+// Non-owning view of contiguous bars in time order
+class BarSpan {
+public:
+    BarSpan() = default;
+    BarSpan(const Bar* data, size_t size) : bars(data), count(size) {}
+    BarSpan(const std::vector<Bar>& bars) : bars(bars.data()), count(bars.size()) {}
+    
+    const Bar* data() const { return bars; }
+    size_t size() const { return count; }
+    const Bar* begin() const { return bars; }
+    const Bar* end() const { return bars + count; }
+    const Bar& operator[](size_t i) const { return bars[i]; }
+
+private:
+    const Bar* bars = nullptr;
+    size_t count = 0;
+};
+
+enum class Regime { TREND = 0, VOLATILE = 1, SIDEWAYS = 2 };
+
+struct Trade {
+    int64_t entry_time = 0;
+    int64_t exit_time = 0;
+    double entry_price = 0.0;
+    double exit_price = 0.0;
+    int quantity = 0; // shares closed
+    double pnl = 0.0; // after costs
+    double pnl_pct = 0.0;
+    Regime entry_regime = Regime::SIDEWAYS;
+    Regime exit_regime = Regime::SIDEWAYS;
+};
+
+struct EquityPoint {
+    int64_t time = 0;
+    double equity = 0.0;
+};
+
+struct Summary {
+    double total_return_pct = 0.0;
+    double annualized_return_pct = 0.0;
+    double sharpe_ratio = 0.0;
+    double max_drawdown_pct = 0.0;
+    int total_trades = 0;
+    int winning_trades = 0;
+    int losing_trades = 0;
+    double win_rate_pct = 0.0;
+    double profit_factor = 0.0;
+    double initial_cash = 0.0;
+    double final_cash = 0.0;
+    
+    // Costs by category, already taken out of final_cash
+    double commission = 0.0;
+    double exchange_fees = 0.0;
+    double borrow_cost = 0.0;
+    double financing_cost = 0.0;
+    double vwap_shortfall_bps = 0.0;
+};
+
+struct Result {
+    Summary summary;
+    std::vector<Trade> trades;
+    std::vector<EquityPoint> equity_curve;
+    size_t bars = 0;         // bars processed
+    size_t skipped_bars = 0; // invalid bars (non-positive close) ignored
+};
+
+// One strategy, run over bars either all at once (run) or as they arrive
+// (add_bar, then result). Not thread-safe; use one Backtest per thread.
+class Backtest {
+public:
+    // Strategy from YAML text or a YAML file in the format of config/*.yaml;
+    // nullptr (with the reason in *error if given) when it can't be parsed
+    static std::unique_ptr<Backtest> from_yaml(const std::string& yaml_text, std::string* error = nullptr);
+    static std::unique_ptr<Backtest> from_file(const std::string& yaml_path, std::string* error = nullptr);
+    
+    ~Backtest();
+    Backtest(const Backtest&) = delete;
+    Backtest& operator=(const Backtest&) = delete;
+    
+    const std::string& name() const;
+    
+    // Starting cash for the next run (default 100000); resets the run
+    void set_initial_cash(double cash);
+    
+    // Fresh run over `bars`
+    Result run(BarSpan bars);
+    
+    // Streaming: feed one bar; false if it was skipped as invalid
+    bool add_bar(const Bar& bar);
+    
+    // Results of the bars added since the last reset
+    Result result() const;
+    
+    void reset();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+    
+    explicit Backtest(std::unique_ptr<Impl> impl);
+};
+
+} // namespace api
+} // namespace fluxback
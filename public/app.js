@@ -1,6 +1,8 @@
 // FluxBack Web Interface
 class FluxBackApp {
     constructor() {
+        // Local `fluxback serve` process; keeps parsed data warm between runs
+        this.serverUrl = localStorage.getItem('fluxbackServer') || 'http://127.0.0.1:8765';
         this.init();
     }
 
@@ -78,18 +80,19 @@ execution:
         const strategyYaml = document.getElementById('strategyYaml').value;
         const csvData = document.getElementById('csvData').value;
 
+        const payload = JSON.stringify({
+            strategy: strategyYaml,
+            data: csvData
+        });
+
         try {
-            // Try API endpoint first
-            const response = await fetch('/api/backtest', {
-                method: 'POST',
-                headers: {
-                    'Content-Type': 'application/json',
-                },
-                body: JSON.stringify({
-                    strategy: strategyYaml,
-                    data: csvData
-                })
-            });
+            // Prefer a local backtest server, then fall back to the API endpoint
+            let response;
+            try {
+                response = await this.postBacktest(`${this.serverUrl}/api/backtest`, payload);
+            } catch (serverError) {
+                response = await this.postBacktest('/api/backtest', payload);
+            }
 
             const result = await response.json();
 
@@ -108,6 +111,16 @@ execution:
         }
     }
 
+    postBacktest(url, payload) {
+        return fetch(url, {
+            method: 'POST',
+            headers: {
+                'Content-Type': 'application/json',
+            },
+            body: payload
+        });
+    }
+
     showLocalInstructions(error) {
         const resultsDiv = document.getElementById('results');
         resultsDiv.innerHTML = `
@@ -8,6 +8,7 @@
 #include "analytics/Analytics.h"
 #include "regime/RegimeDetector.h"
 #include "utils/ConfigParser.h"
+#include "engine/BacktestRunner.h"
 #include <string>
 #include <map>
 
@@ -34,34 +35,15 @@ std::map<std::string, py::object> run_backtest(
     
     // Initialize components
     DataLoader loader(data_path);
-    IndicatorEngine indicators;
-    StrategyEngine strategy(config);
-    ExecutionSimulator executor(config);
-    RegimeDetector regime_detector;
-    Analytics analytics;
-    
-    executor.reset(100000.0);
-    analytics.reset();
+    BacktestRunner runner(config);
     
     // Main event loop
     while (loader.has_next()) {
-        OHLCV tick = loader.next();
-        if (tick.close <= 0.0) continue;
-        
-        indicators.add_price(tick.close, tick.volume);
-        Regime current_regime = regime_detector.update_and_get(tick);
-        std::vector<Order> orders = strategy.on_tick(tick, indicators);
-        
-        for (const auto& order : orders) {
-            double realized_vol = indicators.get_realized_vol(20);
-            Fill fill = executor.execute(order, tick, realized_vol);
-            double position_value = executor.get_position().size * tick.close;
-            analytics.record_fill(fill, current_regime, executor.get_cash(), position_value);
-        }
+        runner.on_bar(loader.next());
     }
     
     // Get summary
-    BacktestSummary summary = analytics.summary();
+    BacktestSummary summary = runner.summary();
     
     // Convert to Python dictionary
     std::map<std::string, py::object> result;
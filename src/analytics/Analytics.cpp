@@ -1,89 +1,155 @@
 #include "analytics/Analytics.h"
-#include <fstream>
-#include <sstream>
+#include "analytics/ResultWriter.h"
 #include <algorithm>
 #include <cmath>
-#include <iomanip>
-#include <iostream>
 
 namespace fluxback {
 
-Analytics::Analytics()
-    : initial_cash(100000.0), current_cash(100000.0), peak_equity(100000.0), max_drawdown(0.0) {
-    open_position.is_open = false;
+namespace {
+
+// `part` units' share of `amount` spread over `whole` units; exact when
+// the part is the whole
+double share(double amount, int part, int whole) {
+    if (amount == 0.0 || part == whole) return amount;
+    return amount * part / whole;
+}
+
+} // namespace
+
+Analytics::Analytics(std::pmr::memory_resource* resource)
+    : fills(resource), trades(resource), equity_curve(resource), initial_cash(100000.0), current_cash(100000.0), peak_equity(100000.0), max_drawdown(0.0),
+      commission(0.0), exchange_fees(0.0), borrow_cost(0.0), financing_cost(0.0),
+      vwap_shortfall(0.0), vwap_notional(0.0), years(0.0), lots(resource), lot_head(0), position(0),
+      cost_basis(0.0), carry_per_unit(0.0), realized(0.0), lot_method(StrategyConfig::LotMethod::FIFO) {
 }
 
-void Analytics::reset() {
+void Analytics::reset(double cash) {
     fills.clear();
     trades.clear();
     equity_curve.clear();
-    initial_cash = 100000.0;
-    current_cash = 100000.0;
-    peak_equity = 100000.0;
+    initial_cash = cash;
+    current_cash = cash;
+    peak_equity = cash;
     max_drawdown = 0.0;
-    open_position.is_open = false;
+    commission = 0.0;
+    exchange_fees = 0.0;
+    borrow_cost = 0.0;
+    financing_cost = 0.0;
+    vwap_shortfall = 0.0;
+    vwap_notional = 0.0;
+    years = 0.0;
+    lots.clear();
+    lot_head = 0;
+    position = 0;
+    cost_basis = 0.0;
+    carry_per_unit = 0.0;
+    realized = 0.0;
 }
 
-void Analytics::record_fill(const Fill& fill, Regime regime, double current_cash, double current_position_value) {
+const Fill& Analytics::record_fill(const Fill& fill, Regime regime, double current_cash, double current_position_value) {
     fills.push_back(fill);
+    Fill& recorded = fills.back();
     this->current_cash = current_cash;
+    commission += fill.commission;
+    exchange_fees += fill.fees;
     
     double current_equity = current_cash + current_position_value;
-    equity_curve.push_back({fill.timestamp, current_equity});
+    equity_curve.emplace_back(fill.timestamp, current_equity);
     update_drawdown(current_equity);
     
-    // Handle position tracking
-    if (!open_position.is_open) {
-        // Opening a new position
-        if ((fill.order.type == Order::BUY && fill.order.size > 0) ||
-            (fill.order.type == Order::SELL && fill.order.size > 0)) {
-            open_position.entry_fill = fill;
-            open_position.entry_regime = regime;
-            open_position.is_open = true;
+    const int side = fill.order.type == Order::BUY ? 1 : -1;
+    if (fill.vwap > 0.0) {
+        vwap_shortfall += side * (fill.fill_price - fill.vwap) * fill.filled_size;
+        vwap_notional += fill.vwap * fill.filled_size;
+    }
+    
+    const double fill_costs = fill.commission + fill.fees;
+    int remaining = fill.filled_size;
+    
+    // Close open lots on the other side, oldest first
+    double closed = 0.0;
+    while (remaining > 0 && position * side < 0) {
+        Lot& lot = lots[lot_head];
+        int quantity = std::min(remaining, lot.quantity);
+        closed += close_lot(lot, quantity, fill, share(fill_costs, quantity, fill.filled_size), regime);
+        remaining -= quantity;
+        if (lot.quantity == 0 && ++lot_head == lots.size()) {
+            lots.clear();
+            lot_head = 0;
         }
-    } else {
-        // Check if this fill closes the position
-        bool closes_position = false;
-        
-        if (open_position.entry_fill.order.type == Order::BUY) {
-            // Long position: closes on SELL
-            closes_position = (fill.order.type == Order::SELL);
+    }
+    
+    // Whatever is left opens (or adds to) a position on the fill's side
+    if (remaining > 0) {
+        double costs = share(fill_costs, remaining, fill.filled_size);
+        if (lot_method == StrategyConfig::LotMethod::AVERAGE && lot_head < lots.size()) {
+            Lot& lot = lots[lot_head];
+            double total = static_cast<double>(lot.quantity) + remaining;
+            lot.price = (lot.price * lot.quantity + fill.fill_price * remaining) / total;
+            lot.carry_mark = (lot.carry_mark * lot.quantity + carry_per_unit * remaining) / total;
+            lot.costs += costs;
+            lot.quantity += remaining;
         } else {
-            // Short position: closes on BUY
-            closes_position = (fill.order.type == Order::BUY);
-        }
-        
-        if (closes_position) {
-            close_trade(fill, regime);
-            open_position.is_open = false;
+            lots.push_back({remaining, fill.fill_price, costs, carry_per_unit, fills.size() - 1, regime});
         }
+        position += side * remaining;
+        cost_basis += side * remaining * fill.fill_price;
     }
+    
+    realized += closed;
+    recorded.realized_pnl = closed;
+    recorded.unrealized_pnl = position != 0 ? current_position_value - cost_basis : 0.0;
+    return recorded;
 }
 
-void Analytics::close_trade(const Fill& exit_fill, Regime exit_regime) {
-    Trade trade;
-    trade.entry_timestamp = open_position.entry_fill.timestamp;
+void Analytics::record_carry(const CarryCosts& carry) {
+    borrow_cost += carry.borrow;
+    financing_cost += carry.financing;
+    if (position != 0) {
+        carry_per_unit += (carry.borrow + carry.financing) / std::abs(position);
+    }
+}
+
+double Analytics::close_lot(Lot& lot, int quantity, const Fill& exit_fill, double exit_costs, Regime exit_regime) {
+    Trade& trade = trades.emplace_back();
+    trade.entry_timestamp = fills[lot.fill_index].timestamp;
     trade.exit_timestamp = exit_fill.timestamp;
-    trade.entry_price = open_position.entry_fill.fill_price;
+    trade.entry_price = lot.price;
     trade.exit_price = exit_fill.fill_price;
-    trade.entry_regime = open_position.entry_regime;
+    trade.entry_regime = lot.regime;
     trade.exit_regime = exit_regime;
+    trade.size = quantity;
     
     // Calculate PnL
-    if (open_position.entry_fill.order.type == Order::BUY) {
+    if (position > 0) {
         // Long position
-        trade.size = open_position.entry_fill.filled_size;
-        trade.pnl = (exit_fill.fill_price - open_position.entry_fill.fill_price) * trade.size;
-        trade.pnl_pct = ((exit_fill.fill_price - open_position.entry_fill.fill_price) / open_position.entry_fill.fill_price) * 100.0;
+        trade.pnl = (exit_fill.fill_price - lot.price) * trade.size;
+        trade.pnl_pct = ((exit_fill.fill_price - lot.price) / lot.price) * 100.0;
     } else {
         // Short position
-        trade.size = open_position.entry_fill.filled_size;
-        trade.pnl = (open_position.entry_fill.fill_price - exit_fill.fill_price) * trade.size;
-        trade.pnl_pct = ((open_position.entry_fill.fill_price - exit_fill.fill_price) / open_position.entry_fill.fill_price) * 100.0;
+        trade.pnl = (lot.price - exit_fill.fill_price) * trade.size;
+        trade.pnl_pct = ((lot.price - exit_fill.fill_price) / lot.price) * 100.0;
+    }
+    
+    // Net of this lot's share of entry, exit and carry costs; cost-free
+    // runs skip this so their figures are unchanged
+    double entry_costs = share(lot.costs, quantity, lot.quantity);
+    double carry = carry_per_unit != lot.carry_mark ? (carry_per_unit - lot.carry_mark) * quantity : 0.0;
+    double costs = entry_costs + exit_costs + carry;
+    if (costs != 0.0) {
+        trade.pnl -= costs;
+        trade.pnl_pct -= costs / (lot.price * trade.size) * 100.0;
     }
     
+    const int sign = position > 0 ? 1 : -1;
+    position -= sign * quantity;
+    cost_basis -= sign * quantity * lot.price;
+    lot.costs -= entry_costs;
+    lot.quantity -= quantity;
+    if (position == 0) cost_basis = 0.0; // no rounding residue once flat
+    
     trade.is_win = trade.pnl > 0.0;
-    trades.push_back(trade);
+    return trade.pnl;
 }
 
 BacktestSummary Analytics::summary() const {
@@ -98,12 +164,9 @@ BacktestSummary Analytics::summary() const {
         s.total_return_pct = ((s.final_cash - initial_cash) / initial_cash) * 100.0;
     }
     
-    // Annualized return (assuming ~252 trading days, ~390 minutes per day)
-    // For 1-month demo: ~20 trading days = ~7800 minutes
-    // This is a simplification - in production, calculate actual time span
-    double time_span_years = 1.0 / 12.0; // Assume 1 month for demo
-    if (time_span_years > 0) {
-        s.annualized_return_pct = (std::pow(s.final_cash / initial_cash, 1.0 / time_span_years) - 1.0) * 100.0;
+    // Annualized over the trading days the run covered
+    if (years > 0.0) {
+        s.annualized_return_pct = (std::pow(s.final_cash / initial_cash, 1.0 / years) - 1.0) * 100.0;
     } else {
         s.annualized_return_pct = s.total_return_pct;
     }
@@ -135,7 +198,12 @@ BacktestSummary Analytics::summary() const {
     
     s.sharpe_ratio = calculate_sharpe_ratio();
     s.max_drawdown_pct = max_drawdown;
-    s.equity_curve = equity_curve;
+    s.commission = commission;
+    s.exchange_fees = exchange_fees;
+    s.borrow_cost = borrow_cost;
+    s.financing_cost = financing_cost;
+    s.vwap_shortfall_bps = vwap_notional > 0.0 ? vwap_shortfall / vwap_notional * 10000.0 : 0.0;
+    s.equity_curve.assign(equity_curve.begin(), equity_curve.end());
     
     return s;
 }
@@ -169,8 +237,10 @@ double Analytics::calculate_sharpe_ratio() const {
     
     if (stddev == 0.0) return 0.0;
     
-    // Annualized Sharpe (assuming 252 trading days)
-    return (mean / stddev) * std::sqrt(252.0);
+    // Annualized by how many returns fell in a year of the run; 252 per
+    // year when the span is unknown
+    double per_year = years > 0.0 ? returns.size() / years : 252.0;
+    return (mean / stddev) * std::sqrt(per_year);
 }
 
 void Analytics::update_drawdown(double current_equity) {
@@ -185,62 +255,18 @@ void Analytics::update_drawdown(double current_equity) {
 }
 
 void Analytics::export_trade_log(const std::string& csv_path) const {
-    std::ofstream file(csv_path);
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open file for writing: " << csv_path << std::endl;
-        return;
-    }
-    
-    // Header
-    file << "entry_timestamp,exit_timestamp,entry_price,exit_price,size,pnl,pnl_pct,entry_regime,exit_regime,is_win\n";
-    
-    // Data
-    for (const auto& trade : trades) {
-        file << trade.entry_timestamp << ","
-             << trade.exit_timestamp << ","
-             << std::fixed << std::setprecision(2) << trade.entry_price << ","
-             << trade.exit_price << ","
-             << trade.size << ","
-             << trade.pnl << ","
-             << std::setprecision(4) << trade.pnl_pct << ","
-             << regime_to_string(trade.entry_regime) << ","
-             << regime_to_string(trade.exit_regime) << ","
-             << (trade.is_win ? "1" : "0") << "\n";
-    }
-    
-    file.close();
+    ResultWriter::write_trade_log(csv_path, trades);
 }
 
 void Analytics::export_summary_json(const std::string& json_path) const {
-    auto s = summary();
-    
-    std::ofstream file(json_path);
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open file for writing: " << json_path << std::endl;
-        return;
-    }
-    
-    file << std::fixed << std::setprecision(4);
-    file << "{\n";
-    file << "  \"total_return_pct\": " << s.total_return_pct << ",\n";
-    file << "  \"annualized_return_pct\": " << s.annualized_return_pct << ",\n";
-    file << "  \"sharpe_ratio\": " << s.sharpe_ratio << ",\n";
-    file << "  \"max_drawdown_pct\": " << s.max_drawdown_pct << ",\n";
-    file << "  \"total_trades\": " << s.total_trades << ",\n";
-    file << "  \"winning_trades\": " << s.winning_trades << ",\n";
-    file << "  \"losing_trades\": " << s.losing_trades << ",\n";
-    file << "  \"win_rate_pct\": " << s.win_rate_pct << ",\n";
-    file << "  \"avg_win_pct\": " << s.avg_win_pct << ",\n";
-    file << "  \"avg_loss_pct\": " << s.avg_loss_pct << ",\n";
-    file << "  \"profit_factor\": " << s.profit_factor << ",\n";
-    file << "  \"initial_cash\": " << s.initial_cash << ",\n";
-    file << "  \"final_cash\": " << s.final_cash << "\n";
-    file << "}\n";
-    
-    file.close();
+    ResultWriter::write_summary_json(json_path, summary());
+}
+
+void Analytics::export_binary(const std::string& path, const std::string& label) const {
+    ResultWriter::write_binary(path, summary(), trades, label);
 }
 
-std::string Analytics::regime_to_string(Regime r) const {
+std::string Analytics::regime_to_string(Regime r) {
     switch (r) {
         case Regime::TREND: return "TREND";
         case Regime::VOLATILE: return "VOLATILE";
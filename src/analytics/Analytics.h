@@ -5,22 +5,38 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <memory_resource>
 
 namespace fluxback {
 
 struct Trade {
-    std::string entry_timestamp;
-    std::string exit_timestamp;
-    double entry_price;
-    double exit_price;
-    int size;
-    double pnl;
-    double pnl_pct;
-    Regime entry_regime;
-    Regime exit_regime;
-    bool is_win;
+    // Timestamps are allocated from the memory resource of the TradeLog
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+    
+    std::pmr::string entry_timestamp;
+    std::pmr::string exit_timestamp;
+    double entry_price = 0.0;
+    double exit_price = 0.0;
+    int size = 0;
+    double pnl = 0.0;
+    double pnl_pct = 0.0;
+    Regime entry_regime = Regime::SIDEWAYS;
+    Regime exit_regime = Regime::SIDEWAYS;
+    bool is_win = false;
+    
+    Trade() = default;
+    explicit Trade(const allocator_type& alloc) : entry_timestamp(alloc), exit_timestamp(alloc) {}
+    Trade(const Trade&) = default;
+    Trade(Trade&&) = default;
+    Trade& operator=(const Trade&) = default;
+    Trade& operator=(Trade&&) = default;
+    Trade(const Trade& other, const allocator_type& alloc) : Trade(alloc) { *this = other; }
+    Trade(Trade&& other, const allocator_type& alloc) : Trade(alloc) { *this = std::move(other); }
 };
 
+// Closed trades of a run; allocated from the run's memory resource
+using TradeLog = std::pmr::vector<Trade>;
+
 struct BacktestSummary {
     double total_return_pct;
     double annualized_return_pct;
@@ -36,6 +52,17 @@ struct BacktestSummary {
     double initial_cash;
     double final_cash;
     
+    // Trading costs by category; already taken out of final_cash and
+    // trade PnL
+    double commission = 0.0;
+    double exchange_fees = 0.0;
+    double borrow_cost = 0.0;
+    double financing_cost = 0.0;
+    
+    // Fill prices against the session VWAP, volume-weighted and signed so
+    // positive means worse than VWAP; 0 without vwap.benchmark
+    double vwap_shortfall_bps = 0.0;
+    
     // Per-regime statistics
     std::map<Regime, int> trades_by_regime;
     std::map<Regime, double> pnl_by_regime;
@@ -46,10 +73,25 @@ struct BacktestSummary {
 
 class Analytics {
 public:
-    Analytics();
+    // Fills, trades and the equity curve are allocated from `resource`
+    explicit Analytics(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    
+    // Record a fill and update statistics. The fill is matched against the
+    // open lots; each lot it closes (in part or whole) becomes a Trade and
+    // any remainder opens a new lot, so scale-ins, partial exits and
+    // reversals are all recorded. Returns the stored copy with its realized
+    // and unrealized PnL filled in.
+    const Fill& record_fill(const Fill& fill, Regime regime, double current_cash, double current_position_value);
+    
+    // Span of the run in years (trading days / days per year), for
+    // annualizing; 0 leaves returns unannualized
+    void set_years(double span) { years = span; }
     
-    // Record a fill and update statistics
-    void record_fill(const Fill& fill, Regime regime, double current_cash, double current_position_value);
+    // Lot matching for closing fills (FIFO by default)
+    void set_lot_method(StrategyConfig::LotMethod method) { lot_method = method; }
+    
+    // Record overnight borrow / financing charged on the open position
+    void record_carry(const CarryCosts& carry);
     
     // Get backtest summary
     BacktestSummary summary() const;
@@ -57,36 +99,68 @@ public:
     // Export trade log to CSV
     void export_trade_log(const std::string& csv_path) const;
     
-    // Export summary to JSON (simple format)
+    // Export summary to JSON, including per-regime stats and equity curve
     void export_summary_json(const std::string& json_path) const;
     
-    // Reset analytics
-    void reset();
+    // Export summary, trades and equity curve in columnar binary form (.fxr)
+    void export_binary(const std::string& path, const std::string& label = "") const;
+    
+    const TradeLog& get_trades() const { return trades; }
+    const std::pmr::vector<Fill>& get_fills() const { return fills; }
+    
+    // Signed units held across the open lots
+    int open_quantity() const { return position; }
+    
+    // PnL of closed lots, net of costs
+    double realized_pnl() const { return realized; }
+    
+    // Reset analytics for a run starting with `cash`
+    void reset(double cash = 100000.0);
+    
+    static std::string regime_to_string(Regime r);
 
 private:
-    std::vector<Fill> fills;
-    std::vector<Trade> trades;
-    std::vector<std::pair<std::string, double>> equity_curve;
+    std::pmr::vector<Fill> fills;
+    TradeLog trades;
+    std::pmr::vector<std::pair<std::pmr::string, double>> equity_curve;
     double initial_cash;
     double current_cash;
     double peak_equity;
     double max_drawdown;
+    double commission;
+    double exchange_fees;
+    double borrow_cost;
+    double financing_cost;
+    double vwap_shortfall;   // sum of side * (fill - vwap) * units over benchmarked fills
+    double vwap_notional;    // sum of vwap * units over the same fills
+    double years;
     
-    // Track open position for trade construction
-    struct OpenPosition {
-        Fill entry_fill;
-        Regime entry_regime;
-        bool is_open;
-        
-        OpenPosition() : entry_regime(Regime::SIDEWAYS), is_open(false) {}
+    // Open lots, oldest first, in one buffer consumed from `lot_head`;
+    // all lots share the position's side. The buffer is rewound whenever
+    // the position goes flat, so it stays as small as the deepest
+    // scale-in and a fill costs O(lots it closes).
+    struct Lot {
+        int quantity;      // units still open, > 0
+        double price;
+        double costs;      // entry commission / fees not yet charged to a trade
+        double carry_mark; // carry_per_unit when the lot opened
+        size_t fill_index; // entry fill, for its timestamp
+        Regime regime;
     };
-    OpenPosition open_position;
+    std::pmr::vector<Lot> lots;
+    size_t lot_head;
+    int position;          // signed sum of open lots
+    double cost_basis;     // signed sum of quantity * price over open lots
+    double carry_per_unit; // carry charged per unit held, accumulated
+    double realized;
+    StrategyConfig::LotMethod lot_method;
     
     // Helper methods
-    void close_trade(const Fill& exit_fill, Regime exit_regime);
+    // Book `quantity` units of `lot` closed by `exit_fill` as a Trade;
+    // returns its PnL net of costs
+    double close_lot(Lot& lot, int quantity, const Fill& exit_fill, double exit_costs, Regime exit_regime);
     double calculate_sharpe_ratio() const;
     void update_drawdown(double current_equity);
-    std::string regime_to_string(Regime r) const;
 };
 
 } // namespace fluxback
@@ -0,0 +1,148 @@
+#include "analytics/MonteCarlo.h"
+#include "concurrency/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+
+namespace fluxback {
+
+namespace {
+
+uint64_t splitmix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Stateless generator: draw n of stream k is hash(key(k), n)
+class CounterRng {
+public:
+    CounterRng(uint64_t seed, uint64_t stream)
+        : key(splitmix64(seed ^ splitmix64(stream))), counter(0) {}
+    
+    // Uniform integer in [0, bound)
+    size_t below(size_t bound) {
+        uint64_t x = splitmix64(key + 0x632BE59BD9B4E019ull * counter++);
+        return static_cast<size_t>((x >> 11) * (1.0 / 9007199254740992.0) * bound);
+    }
+
+private:
+    uint64_t key;
+    uint64_t counter;
+};
+
+struct PathMetrics {
+    double total_return_pct;
+    double sharpe_ratio;
+    double max_drawdown_pct;
+    bool ruined;
+};
+
+ConfidenceInterval interval(std::vector<double>& values) {
+    ConfidenceInterval ci;
+    if (values.empty()) return ci;
+    double sum = 0.0;
+    for (double v : values) sum += v;
+    ci.mean = sum / values.size();
+    
+    auto at = [&values](double q) {
+        size_t k = static_cast<size_t>(q * (values.size() - 1));
+        std::nth_element(values.begin(), values.begin() + k, values.end());
+        return values[k];
+    };
+    ci.p5 = at(0.05);
+    ci.p50 = at(0.50);
+    ci.p95 = at(0.95);
+    return ci;
+}
+
+} // namespace
+
+MonteCarloResult MonteCarlo::bootstrap_trades(const std::vector<double>& trade_pnl,
+                                              const MonteCarloConfig& config) {
+    return run(trade_pnl, Mode::PNL, config);
+}
+
+MonteCarloResult MonteCarlo::bootstrap_returns(const std::vector<double>& returns,
+                                               const MonteCarloConfig& config) {
+    return run(returns, Mode::RETURNS, config);
+}
+
+MonteCarloResult MonteCarlo::run(const std::vector<double>& samples, Mode mode,
+                                 const MonteCarloConfig& config) {
+    MonteCarloResult result;
+    result.paths = config.paths;
+    result.samples_per_path = samples.size();
+    if (samples.empty() || config.paths == 0 || config.initial_cash <= 0.0) return result;
+    
+    const size_t n = samples.size();
+    const size_t block = std::max<size_t>(1, std::min(config.block_size, n));
+    const double ruin_level = config.initial_cash * (1.0 - config.ruin_pct / 100.0);
+    
+    // One slot per path, written once; nothing is allocated inside a path
+    std::vector<PathMetrics> metrics(config.paths);
+    
+    auto simulate = [&](size_t begin, size_t end) {
+        for (size_t path = begin; path < end; ++path) {
+            CounterRng rng(config.seed, path);
+            double equity = config.initial_cash;
+            double peak = equity;
+            double max_dd = 0.0;
+            double sum = 0.0, sum_sq = 0.0;
+            bool ruined = false;
+            
+            size_t drawn = 0;
+            while (drawn < n) {
+                size_t start = rng.below(n - block + 1);
+                for (size_t j = 0; j < block && drawn < n; ++j, ++drawn) {
+                    double s = samples[start + j];
+                    double prev = equity;
+                    equity = (mode == Mode::PNL) ? equity + s : equity * (1.0 + s);
+                    double ret = prev > 0.0 ? (equity - prev) / prev : 0.0;
+                    sum += ret;
+                    sum_sq += ret * ret;
+                    
+                    if (equity > peak) peak = equity;
+                    double dd = peak > 0.0 ? (peak - equity) / peak * 100.0 : 0.0;
+                    if (dd > max_dd) max_dd = dd;
+                    if (equity <= ruin_level) ruined = true;
+                }
+            }
+            
+            double mean = sum / n;
+            double variance = sum_sq / n - mean * mean;
+            double stddev = variance > 0.0 ? std::sqrt(variance) : 0.0;
+            
+            PathMetrics& m = metrics[path];
+            m.total_return_pct = (equity - config.initial_cash) / config.initial_cash * 100.0;
+            m.sharpe_ratio = stddev > 0.0 ? (mean / stddev) * std::sqrt(config.periods_per_year) : 0.0;
+            m.max_drawdown_pct = max_dd;
+            m.ruined = ruined;
+        }
+    };
+    
+    size_t thread_count = static_cast<size_t>(std::max(1, config.threads));
+    thread_count = std::min(thread_count, config.paths);
+    size_t chunk = (config.paths + thread_count - 1) / thread_count;
+    ThreadPool::shared().run_workers(static_cast<int>(thread_count), [&](int slot) {
+        size_t begin = static_cast<size_t>(slot) * chunk;
+        size_t end = std::min(config.paths, begin + chunk);
+        if (begin < end) simulate(begin, end);
+    });
+    
+    std::vector<double> values(config.paths);
+    auto collect = [&](double PathMetrics::*field) {
+        for (size_t i = 0; i < config.paths; ++i) values[i] = metrics[i].*field;
+        return interval(values);
+    };
+    result.total_return_pct = collect(&PathMetrics::total_return_pct);
+    result.sharpe_ratio = collect(&PathMetrics::sharpe_ratio);
+    result.max_drawdown_pct = collect(&PathMetrics::max_drawdown_pct);
+    
+    size_t ruined = 0;
+    for (const auto& m : metrics) ruined += m.ruined ? 1 : 0;
+    result.risk_of_ruin_pct = 100.0 * ruined / config.paths;
+    return result;
+}
+
+} // namespace fluxback
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace fluxback {
+
+struct MonteCarloConfig {
+    size_t paths = 10000;
+    size_t block_size = 1;          // >1 resamples contiguous blocks
+    int threads = 1;
+    uint64_t seed = 42;
+    double initial_cash = 100000.0;
+    double ruin_pct = 50.0;         // ruin = equity falls this far below initial cash
+    double periods_per_year = 252.0; // samples per year, for annualizing Sharpe
+};
+
+struct ConfidenceInterval {
+    double mean = 0.0;
+    double p5 = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+};
+
+struct MonteCarloResult {
+    size_t paths = 0;
+    size_t samples_per_path = 0;
+    ConfidenceInterval total_return_pct;
+    ConfidenceInterval sharpe_ratio;
+    ConfidenceInterval max_drawdown_pct;
+    double risk_of_ruin_pct = 0.0;
+};
+
+// Bootstrap robustness analysis. Each path draws from a counter-based RNG
+// keyed by (seed, path index), so results do not depend on the thread
+// count, and a path walks its equity without allocating.
+class MonteCarlo {
+public:
+    // Resample trade PnL (in cash) with replacement
+    static MonteCarloResult bootstrap_trades(const std::vector<double>& trade_pnl,
+                                             const MonteCarloConfig& config);
+    
+    // Resample fractional returns (e.g. equity-curve returns) in blocks of
+    // config.block_size to keep short-range autocorrelation
+    static MonteCarloResult bootstrap_returns(const std::vector<double>& returns,
+                                              const MonteCarloConfig& config);
+
+private:
+    enum class Mode { PNL, RETURNS };
+    static MonteCarloResult run(const std::vector<double>& samples, Mode mode,
+                                const MonteCarloConfig& config);
+};
+
+} // namespace fluxback
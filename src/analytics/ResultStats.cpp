@@ -0,0 +1,257 @@
+#include "analytics/ResultStats.h"
+#include "analytics/ResultWriter.h"
+#include "concurrency/ThreadPool.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+
+namespace fluxback {
+
+namespace {
+
+bool read_file(const std::string& path, std::string& content) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) return false;
+    std::fseek(file, 0, SEEK_END);
+    long size = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    content.resize(size > 0 ? static_cast<size_t>(size) : 0);
+    size_t read = content.empty() ? 0 : std::fread(&content[0], 1, content.size(), file);
+    std::fclose(file);
+    return read == content.size();
+}
+
+// Locate `"key":` and parse the number after it
+bool json_number(const std::string& text, const char* key, double& value) {
+    std::string needle = std::string("\"") + key + "\"";
+    size_t pos = text.find(needle);
+    if (pos == std::string::npos) return false;
+    pos = text.find(':', pos + needle.size());
+    if (pos == std::string::npos) return false;
+    ++pos;
+    while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t')) ++pos;
+    auto result = std::from_chars(text.data() + pos, text.data() + text.size(), value);
+    return result.ec == std::errc();
+}
+
+std::string json_string(const std::string& text, const char* key) {
+    std::string needle = std::string("\"") + key + "\"";
+    size_t pos = text.find(needle);
+    if (pos == std::string::npos) return "";
+    pos = text.find('"', text.find(':', pos + needle.size()) + 1);
+    if (pos == std::string::npos) return "";
+    size_t end = text.find('"', pos + 1);
+    return end == std::string::npos ? "" : text.substr(pos + 1, end - pos - 1);
+}
+
+double percentile(const std::vector<double>& sorted, double q) {
+    if (sorted.empty()) return 0.0;
+    double rank = q * (sorted.size() - 1);
+    size_t lo = static_cast<size_t>(rank);
+    size_t hi = std::min(lo + 1, sorted.size() - 1);
+    return sorted[lo] + (rank - lo) * (sorted[hi] - sorted[lo]);
+}
+
+bool dominates(const ResultRecord& a, const ResultRecord& b) {
+    bool no_worse = a.total_return_pct >= b.total_return_pct && a.sharpe_ratio >= b.sharpe_ratio &&
+                    a.max_drawdown_pct <= b.max_drawdown_pct;
+    bool better = a.total_return_pct > b.total_return_pct || a.sharpe_ratio > b.sharpe_ratio ||
+                  a.max_drawdown_pct < b.max_drawdown_pct;
+    return no_worse && better;
+}
+
+void print_distribution(const char* name, const Distribution& d) {
+    std::cout << std::left << std::setw(18) << name << std::right << std::fixed << std::setprecision(4)
+              << std::setw(11) << d.mean << std::setw(11) << d.stddev << std::setw(11) << d.min
+              << std::setw(11) << d.p5 << std::setw(11) << d.median << std::setw(11) << d.p95
+              << std::setw(11) << d.max << "\n";
+}
+
+void print_table(const std::vector<ResultRecord>& rows) {
+    std::cout << std::right << std::setw(5) << "#" << std::setw(11) << "Return%" << std::setw(11) << "Sharpe"
+              << std::setw(11) << "MaxDD%" << std::setw(9) << "Trades" << "  Run\n";
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const auto& r = rows[i];
+        std::cout << std::setw(5) << i + 1 << std::fixed << std::setprecision(4)
+                  << std::setw(11) << r.total_return_pct << std::setw(11) << r.sharpe_ratio
+                  << std::setw(11) << r.max_drawdown_pct << std::setw(9) << r.total_trades
+                  << "  " << (r.label.empty() ? r.path : r.label) << "\n";
+    }
+}
+
+} // namespace
+
+std::vector<std::string> ResultStats::collect_files(const std::string& path) {
+    std::vector<std::string> files;
+    std::error_code ec;
+    if (!std::filesystem::is_directory(path, ec)) {
+        if (std::filesystem::exists(path, ec)) files.push_back(path);
+        return files;
+    }
+    for (const auto& entry : std::filesystem::directory_iterator(path, ec)) {
+        if (!entry.is_regular_file()) continue;
+        std::string ext = entry.path().extension().string();
+        if (ext == ".json" || ext == ".fxr") {
+            files.push_back(entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+bool ResultStats::parse_json(const std::string& path, ResultRecord& record) {
+    std::string text;
+    if (!read_file(path, text)) return false;
+    
+    double trades = 0.0;
+    if (!json_number(text, "total_return_pct", record.total_return_pct) ||
+        !json_number(text, "sharpe_ratio", record.sharpe_ratio) ||
+        !json_number(text, "max_drawdown_pct", record.max_drawdown_pct)) {
+        return false;
+    }
+    json_number(text, "win_rate_pct", record.win_rate_pct);
+    json_number(text, "profit_factor", record.profit_factor);
+    json_number(text, "total_trades", trades);
+    record.total_trades = static_cast<int>(trades);
+    record.label = json_string(text, "label");
+    record.path = path;
+    return true;
+}
+
+bool ResultStats::parse_binary(const std::string& path, ResultRecord& record) {
+    BacktestSummary s;
+    if (!ResultWriter::read_binary(path, s, nullptr, &record.label, true)) return false;
+    record.path = path;
+    record.total_return_pct = s.total_return_pct;
+    record.sharpe_ratio = s.sharpe_ratio;
+    record.max_drawdown_pct = s.max_drawdown_pct;
+    record.win_rate_pct = s.win_rate_pct;
+    record.profit_factor = s.profit_factor;
+    record.total_trades = s.total_trades;
+    return true;
+}
+
+std::vector<ResultRecord> ResultStats::load(const std::vector<std::string>& files, int parallel,
+                                            size_t* failed) {
+    std::vector<ResultRecord> parsed(files.size());
+    std::vector<char> ok(files.size(), 0);
+    ThreadPool::shared().parallel_for(files.size(), parallel, [&](size_t i) {
+        const std::string& f = files[i];
+        bool binary = f.size() > 4 && f.compare(f.size() - 4, 4, ".fxr") == 0;
+        ok[i] = binary ? parse_binary(f, parsed[i]) : parse_json(f, parsed[i]);
+    });
+    
+    std::vector<ResultRecord> records;
+    records.reserve(files.size());
+    size_t bad = 0;
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (ok[i]) {
+            records.push_back(std::move(parsed[i]));
+        } else {
+            bad++;
+        }
+    }
+    if (failed != nullptr) *failed = bad;
+    return records;
+}
+
+Distribution ResultStats::distribution(std::vector<double> values) {
+    Distribution d;
+    d.count = values.size();
+    if (values.empty()) return d;
+    
+    std::sort(values.begin(), values.end());
+    double sum = 0.0;
+    for (double v : values) sum += v;
+    d.mean = sum / values.size();
+    double variance = 0.0;
+    for (double v : values) variance += (v - d.mean) * (v - d.mean);
+    d.stddev = values.size() > 1 ? std::sqrt(variance / (values.size() - 1)) : 0.0;
+    
+    d.min = values.front();
+    d.max = values.back();
+    d.p5 = percentile(values, 0.05);
+    d.p25 = percentile(values, 0.25);
+    d.median = percentile(values, 0.5);
+    d.p75 = percentile(values, 0.75);
+    d.p95 = percentile(values, 0.95);
+    return d;
+}
+
+std::vector<ResultRecord> ResultStats::pareto_frontier(const std::vector<ResultRecord>& records) {
+    std::vector<const ResultRecord*> order;
+    order.reserve(records.size());
+    for (const auto& r : records) order.push_back(&r);
+    std::sort(order.begin(), order.end(), [](const ResultRecord* a, const ResultRecord* b) {
+        if (a->sharpe_ratio != b->sharpe_ratio) return a->sharpe_ratio > b->sharpe_ratio;
+        if (a->total_return_pct != b->total_return_pct) return a->total_return_pct > b->total_return_pct;
+        return a->max_drawdown_pct < b->max_drawdown_pct;
+    });
+    
+    // Only records earlier in Sharpe order can dominate later ones, and the
+    // frontier stays small, so each candidate is checked against it alone
+    std::vector<const ResultRecord*> frontier;
+    for (const ResultRecord* candidate : order) {
+        bool dominated = false;
+        for (const ResultRecord* f : frontier) {
+            if (dominates(*f, *candidate)) {
+                dominated = true;
+                break;
+            }
+        }
+        if (!dominated) frontier.push_back(candidate);
+    }
+    
+    std::vector<ResultRecord> result;
+    result.reserve(frontier.size());
+    for (const ResultRecord* f : frontier) result.push_back(*f);
+    return result;
+}
+
+void ResultStats::print_report(const std::vector<ResultRecord>& records, size_t top_n,
+                               const std::string& sort_key) {
+    std::vector<double> returns, sharpes, drawdowns, win_rates;
+    returns.reserve(records.size());
+    sharpes.reserve(records.size());
+    drawdowns.reserve(records.size());
+    win_rates.reserve(records.size());
+    for (const auto& r : records) {
+        returns.push_back(r.total_return_pct);
+        sharpes.push_back(r.sharpe_ratio);
+        drawdowns.push_back(r.max_drawdown_pct);
+        win_rates.push_back(r.win_rate_pct);
+    }
+    
+    std::cout << "\n=== Distributions (" << records.size() << " runs) ===\n";
+    std::cout << std::left << std::setw(18) << "Metric" << std::right << std::setw(11) << "Mean"
+              << std::setw(11) << "StdDev" << std::setw(11) << "Min" << std::setw(11) << "P5"
+              << std::setw(11) << "Median" << std::setw(11) << "P95" << std::setw(11) << "Max" << "\n";
+    print_distribution("Total Return %", distribution(returns));
+    print_distribution("Sharpe Ratio", distribution(sharpes));
+    print_distribution("Max Drawdown %", distribution(drawdowns));
+    print_distribution("Win Rate %", distribution(win_rates));
+    
+    std::vector<ResultRecord> ranked = records;
+    auto key = [&sort_key](const ResultRecord& r) {
+        if (sort_key == "return") return r.total_return_pct;
+        if (sort_key == "drawdown") return -r.max_drawdown_pct;
+        return r.sharpe_ratio;
+    };
+    size_t n = std::min(top_n, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + n, ranked.end(),
+                      [&key](const ResultRecord& a, const ResultRecord& b) { return key(a) > key(b); });
+    ranked.resize(n);
+    std::cout << "\n=== Top " << n << " by " << sort_key << " ===\n";
+    print_table(ranked);
+    
+    auto frontier = pareto_frontier(records);
+    std::cout << "\n=== Pareto Frontier (return, Sharpe, drawdown): " << frontier.size() << " runs ===\n";
+    if (frontier.size() > top_n) frontier.resize(top_n);
+    print_table(frontier);
+}
+
+} // namespace fluxback
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace fluxback {
+
+// Headline metrics of one result file
+struct ResultRecord {
+    std::string path;
+    std::string label;
+    double total_return_pct = 0.0;
+    double sharpe_ratio = 0.0;
+    double max_drawdown_pct = 0.0;
+    double win_rate_pct = 0.0;
+    double profit_factor = 0.0;
+    int total_trades = 0;
+};
+
+struct Distribution {
+    size_t count = 0;
+    double mean = 0.0;
+    double stddev = 0.0;
+    double min = 0.0;
+    double p5 = 0.0;
+    double p25 = 0.0;
+    double median = 0.0;
+    double p75 = 0.0;
+    double p95 = 0.0;
+    double max = 0.0;
+};
+
+// Aggregates many result files (.json summaries and .fxr binaries),
+// e.g. the per-run output of a sweep
+class ResultStats {
+public:
+    // Expand a file or directory into result file paths (sorted)
+    static std::vector<std::string> collect_files(const std::string& path);
+    
+    // Parse files on `parallel` threads; unreadable files are counted, not fatal
+    static std::vector<ResultRecord> load(const std::vector<std::string>& files, int parallel,
+                                          size_t* failed = nullptr);
+    
+    static bool parse_json(const std::string& path, ResultRecord& record);
+    static bool parse_binary(const std::string& path, ResultRecord& record);
+    
+    static Distribution distribution(std::vector<double> values);
+    
+    // Records not dominated on (higher return, higher Sharpe, lower drawdown),
+    // ordered by Sharpe descending
+    static std::vector<ResultRecord> pareto_frontier(const std::vector<ResultRecord>& records);
+    
+    // Print distributions, the top-N table by `sort_key` and the frontier
+    static void print_report(const std::vector<ResultRecord>& records, size_t top_n,
+                             const std::string& sort_key);
+};
+
+} // namespace fluxback
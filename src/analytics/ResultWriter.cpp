@@ -0,0 +1,474 @@
+#include "analytics/ResultWriter.h"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace fluxback {
+
+// ---------------------------------------------------------------------------
+// OutputBuffer
+// ---------------------------------------------------------------------------
+
+OutputBuffer::OutputBuffer(size_t capacity)
+    : capacity(capacity) {
+    buffer.reserve(capacity + 256);
+}
+
+OutputBuffer::~OutputBuffer() {
+    close();
+}
+
+bool OutputBuffer::open(const std::string& path, bool binary) {
+    close();
+    file = std::fopen(path.c_str(), binary ? "wb" : "w");
+    failed = (file == nullptr);
+    if (failed) {
+        std::cerr << "Error: Could not open file for writing: " << path << std::endl;
+    }
+    return !failed;
+}
+
+bool OutputBuffer::close() {
+    if (file == nullptr) return !failed;
+    flush();
+    failed |= (std::fclose(file) != 0);
+    file = nullptr;
+    return !failed;
+}
+
+void OutputBuffer::flush() {
+    if (file == nullptr || buffer.empty()) return;
+    if (std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) {
+        failed = true;
+    }
+    buffer.clear();
+}
+
+void OutputBuffer::flush_if_full() {
+    if (file != nullptr && buffer.size() >= capacity) flush();
+}
+
+OutputBuffer& OutputBuffer::append(std::string_view text) {
+    buffer.append(text.data(), text.size());
+    flush_if_full();
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::append(char c) {
+    buffer.push_back(c);
+    flush_if_full();
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::append_int(long long value) {
+    char tmp[24];
+    auto result = std::to_chars(tmp, tmp + sizeof(tmp), value);
+    buffer.append(tmp, result.ptr);
+    flush_if_full();
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::append_fixed(double value, int precision) {
+    if (!std::isfinite(value)) {
+        buffer.append("0"); // JSON has no inf/nan
+        return *this;
+    }
+    char tmp[64];
+    auto result = std::to_chars(tmp, tmp + sizeof(tmp), value, std::chars_format::fixed, precision);
+    if (result.ec != std::errc()) {
+        result = std::to_chars(tmp, tmp + sizeof(tmp), value, std::chars_format::scientific, precision);
+    }
+    buffer.append(tmp, result.ptr);
+    flush_if_full();
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::append_json_string(std::string_view text) {
+    buffer.push_back('"');
+    for (char c : text) {
+        switch (c) {
+            case '"': buffer.append("\\\""); break;
+            case '\\': buffer.append("\\\\"); break;
+            case '\n': buffer.append("\\n"); break;
+            case '\r': buffer.append("\\r"); break;
+            case '\t': buffer.append("\\t"); break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char tmp[8];
+                    std::snprintf(tmp, sizeof(tmp), "\\u%04x", static_cast<unsigned char>(c));
+                    buffer.append(tmp);
+                } else {
+                    buffer.push_back(c);
+                }
+                break;
+        }
+    }
+    buffer.push_back('"');
+    flush_if_full();
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::append_raw(const void* data, size_t size) {
+    buffer.append(static_cast<const char*>(data), size);
+    flush_if_full();
+    return *this;
+}
+
+// ---------------------------------------------------------------------------
+// ResultWriter
+// ---------------------------------------------------------------------------
+
+namespace {
+
+const char BINARY_MAGIC[4] = {'F', 'X', 'R', '4'};
+
+template <typename T>
+void put(OutputBuffer& out, T value) {
+    out.append_raw(&value, sizeof(T));
+}
+
+void put_strings(OutputBuffer& out, const std::vector<std::string_view>& strings) {
+    for (std::string_view s : strings) put(out, static_cast<uint32_t>(s.size()));
+    for (std::string_view s : strings) out.append(s);
+}
+
+template <typename T>
+bool get(std::ifstream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+// Counts and lengths come from the file, so they are checked against the
+// bytes actually left before anything is sized by them
+uint64_t bytes_left(std::ifstream& in, uint64_t file_size) {
+    std::streamoff pos = in.tellg();
+    return pos < 0 || static_cast<uint64_t>(pos) > file_size ? 0 : file_size - static_cast<uint64_t>(pos);
+}
+
+template <typename T>
+bool get_column(std::ifstream& in, std::vector<T>& column, uint64_t count, uint64_t file_size) {
+    if (count > bytes_left(in, file_size) / sizeof(T)) return false;
+    column.resize(count);
+    return count == 0 || static_cast<bool>(in.read(reinterpret_cast<char*>(column.data()),
+                                                    static_cast<std::streamsize>(count * sizeof(T))));
+}
+
+bool get_strings(std::ifstream& in, std::vector<std::string>& strings, uint64_t count, uint64_t file_size) {
+    std::vector<uint32_t> lengths;
+    if (!get_column(in, lengths, count, file_size)) return false;
+    uint64_t total = 0;
+    for (uint32_t length : lengths) total += length;
+    if (total > bytes_left(in, file_size)) return false;
+    strings.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        strings[i].resize(lengths[i]);
+        if (lengths[i] > 0 && !in.read(&strings[i][0], lengths[i])) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+void ResultWriter::summary_json(OutputBuffer& out, const BacktestSummary& s, bool include_equity) {
+    auto field = [&out](const char* name, double value) {
+        out.append("  \"").append(name).append("\": ").append_fixed(value, 4).append(",\n");
+    };
+    auto int_field = [&out](const char* name, long long value) {
+        out.append("  \"").append(name).append("\": ").append_int(value).append(",\n");
+    };
+    
+    out.append("{\n");
+    field("total_return_pct", s.total_return_pct);
+    field("annualized_return_pct", s.annualized_return_pct);
+    field("sharpe_ratio", s.sharpe_ratio);
+    field("max_drawdown_pct", s.max_drawdown_pct);
+    int_field("total_trades", s.total_trades);
+    int_field("winning_trades", s.winning_trades);
+    int_field("losing_trades", s.losing_trades);
+    field("win_rate_pct", s.win_rate_pct);
+    field("avg_win_pct", s.avg_win_pct);
+    field("avg_loss_pct", s.avg_loss_pct);
+    field("profit_factor", s.profit_factor);
+    field("initial_cash", s.initial_cash);
+    field("final_cash", s.final_cash);
+    field("commission", s.commission);
+    field("exchange_fees", s.exchange_fees);
+    field("borrow_cost", s.borrow_cost);
+    field("financing_cost", s.financing_cost);
+    field("vwap_shortfall_bps", s.vwap_shortfall_bps);
+    
+    out.append("  \"trades_by_regime\": {");
+    bool first = true;
+    for (const auto& [regime, count] : s.trades_by_regime) {
+        out.append(first ? "" : ", ").append_json_string(Analytics::regime_to_string(regime))
+           .append(": ").append_int(count);
+        first = false;
+    }
+    out.append("},\n  \"pnl_by_regime\": {");
+    first = true;
+    for (const auto& [regime, pnl] : s.pnl_by_regime) {
+        out.append(first ? "" : ", ").append_json_string(Analytics::regime_to_string(regime))
+           .append(": ").append_fixed(pnl, 4);
+        first = false;
+    }
+    out.append("}");
+    
+    if (include_equity) {
+        out.append(",\n  \"equity_curve\": [");
+        for (size_t i = 0; i < s.equity_curve.size(); ++i) {
+            out.append(i == 0 ? "\n    [" : ",\n    [")
+               .append_json_string(s.equity_curve[i].first).append(", ")
+               .append_fixed(s.equity_curve[i].second, 4).append("]");
+        }
+        out.append(s.equity_curve.empty() ? "]" : "\n  ]");
+    }
+    out.append("\n}\n");
+}
+
+std::string ResultWriter::summary_json(const BacktestSummary& s, bool include_equity) {
+    OutputBuffer out;
+    summary_json(out, s, include_equity);
+    return out.str();
+}
+
+bool ResultWriter::write_summary_json(const std::string& path, const BacktestSummary& s) {
+    OutputBuffer out;
+    if (!out.open(path)) return false;
+    summary_json(out, s);
+    return out.close();
+}
+
+bool ResultWriter::write_trade_log(const std::string& path, const TradeLog& trades) {
+    OutputBuffer out;
+    if (!out.open(path)) return false;
+    
+    // Header
+    out.append("entry_timestamp,exit_timestamp,entry_price,exit_price,size,pnl,pnl_pct,entry_regime,exit_regime,is_win\n");
+    
+    // Data
+    for (const auto& trade : trades) {
+        out.append(trade.entry_timestamp).append(',')
+           .append(trade.exit_timestamp).append(',')
+           .append_fixed(trade.entry_price, 2).append(',')
+           .append_fixed(trade.exit_price, 2).append(',')
+           .append_int(trade.size).append(',')
+           .append_fixed(trade.pnl, 2).append(',')
+           .append_fixed(trade.pnl_pct, 4).append(',')
+           .append(Analytics::regime_to_string(trade.entry_regime)).append(',')
+           .append(Analytics::regime_to_string(trade.exit_regime)).append(',')
+           .append(trade.is_win ? "1\n" : "0\n");
+    }
+    return out.close();
+}
+
+bool ResultWriter::write_binary(const std::string& path, const BacktestSummary& s,
+                                const TradeLog& trades, const std::string& label) {
+    OutputBuffer out;
+    if (!out.open(path, true)) return false;
+    
+    out.append_raw(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    put(out, static_cast<uint32_t>(label.size()));
+    out.append(label);
+    for (double v : {s.total_return_pct, s.annualized_return_pct, s.sharpe_ratio, s.max_drawdown_pct,
+                     s.win_rate_pct, s.avg_win_pct, s.avg_loss_pct, s.profit_factor,
+                     s.initial_cash, s.final_cash, s.commission, s.exchange_fees,
+                     s.borrow_cost, s.financing_cost, s.vwap_shortfall_bps}) {
+        put(out, v);
+    }
+    put(out, static_cast<int32_t>(s.total_trades));
+    put(out, static_cast<int32_t>(s.winning_trades));
+    put(out, static_cast<int32_t>(s.losing_trades));
+    
+    put(out, static_cast<uint32_t>(s.trades_by_regime.size()));
+    for (const auto& [regime, count] : s.trades_by_regime) {
+        auto pnl = s.pnl_by_regime.find(regime);
+        put(out, static_cast<uint8_t>(regime));
+        put(out, static_cast<int32_t>(count));
+        put(out, pnl != s.pnl_by_regime.end() ? pnl->second : 0.0);
+    }
+    
+    // Trades, one column at a time
+    put(out, static_cast<uint64_t>(trades.size()));
+    for (const auto& t : trades) put(out, t.entry_price);
+    for (const auto& t : trades) put(out, t.exit_price);
+    for (const auto& t : trades) put(out, static_cast<int32_t>(t.size));
+    for (const auto& t : trades) put(out, t.pnl);
+    for (const auto& t : trades) put(out, t.pnl_pct);
+    for (const auto& t : trades) put(out, static_cast<uint8_t>(t.entry_regime));
+    for (const auto& t : trades) put(out, static_cast<uint8_t>(t.exit_regime));
+    for (const auto& t : trades) put(out, static_cast<uint8_t>(t.is_win ? 1 : 0));
+    std::vector<std::string_view> timestamps;
+    timestamps.reserve(trades.size() * 2);
+    for (const auto& t : trades) timestamps.push_back(t.entry_timestamp);
+    for (const auto& t : trades) timestamps.push_back(t.exit_timestamp);
+    put_strings(out, timestamps);
+    
+    // Equity curve
+    put(out, static_cast<uint64_t>(s.equity_curve.size()));
+    for (const auto& point : s.equity_curve) put(out, point.second);
+    timestamps.clear();
+    for (const auto& point : s.equity_curve) timestamps.push_back(point.first);
+    put_strings(out, timestamps);
+    
+    return out.close();
+}
+
+bool ResultWriter::read_binary(const std::string& path, BacktestSummary& s, TradeLog* trades,
+                               std::string* label, bool summary_only) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) return false;
+    const uint64_t file_size = static_cast<uint64_t>(in.tellg());
+    in.seekg(0);
+    
+    char magic[4];
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, BINARY_MAGIC, sizeof(magic)) != 0) return false;
+    uint32_t label_size = 0;
+    if (!get(in, label_size) || label_size > bytes_left(in, file_size)) return false;
+    std::string run_label(label_size, '\0');
+    if (label_size > 0 && !in.read(&run_label[0], label_size)) return false;
+    if (label != nullptr) *label = std::move(run_label);
+    
+    double* scalars[] = {&s.total_return_pct, &s.annualized_return_pct, &s.sharpe_ratio, &s.max_drawdown_pct,
+                         &s.win_rate_pct, &s.avg_win_pct, &s.avg_loss_pct, &s.profit_factor,
+                         &s.initial_cash, &s.final_cash, &s.commission, &s.exchange_fees,
+                         &s.borrow_cost, &s.financing_cost, &s.vwap_shortfall_bps};
+    for (double* v : scalars) {
+        if (!get(in, *v)) return false;
+    }
+    int32_t total = 0, wins = 0, losses = 0;
+    if (!get(in, total) || !get(in, wins) || !get(in, losses)) return false;
+    s.total_trades = total;
+    s.winning_trades = wins;
+    s.losing_trades = losses;
+    
+    uint32_t regime_count = 0;
+    if (!get(in, regime_count)) return false;
+    s.trades_by_regime.clear();
+    s.pnl_by_regime.clear();
+    for (uint32_t i = 0; i < regime_count; ++i) {
+        uint8_t regime = 0;
+        int32_t count = 0;
+        double pnl = 0.0;
+        if (!get(in, regime) || !get(in, count) || !get(in, pnl)) return false;
+        s.trades_by_regime[static_cast<Regime>(regime)] = count;
+        s.pnl_by_regime[static_cast<Regime>(regime)] = pnl;
+    }
+    if (summary_only) return true;
+    
+    uint64_t trade_count = 0;
+    if (!get(in, trade_count)) return false;
+    std::vector<double> entry_price, exit_price, pnl, pnl_pct;
+    std::vector<int32_t> size;
+    std::vector<uint8_t> entry_regime, exit_regime, is_win;
+    std::vector<std::string> trade_times;
+    if (!get_column(in, entry_price, trade_count, file_size) ||
+        !get_column(in, exit_price, trade_count, file_size) ||
+        !get_column(in, size, trade_count, file_size) ||
+        !get_column(in, pnl, trade_count, file_size) ||
+        !get_column(in, pnl_pct, trade_count, file_size) ||
+        !get_column(in, entry_regime, trade_count, file_size) ||
+        !get_column(in, exit_regime, trade_count, file_size) ||
+        !get_column(in, is_win, trade_count, file_size) ||
+        !get_strings(in, trade_times, trade_count * 2, file_size)) {
+        return false;
+    }
+    if (trades != nullptr) {
+        trades->resize(trade_count);
+        for (size_t i = 0; i < trade_count; ++i) {
+            Trade& t = (*trades)[i];
+            t.entry_timestamp = trade_times[i];
+            t.exit_timestamp = trade_times[trade_count + i];
+            t.entry_price = entry_price[i];
+            t.exit_price = exit_price[i];
+            t.size = size[i];
+            t.pnl = pnl[i];
+            t.pnl_pct = pnl_pct[i];
+            t.entry_regime = static_cast<Regime>(entry_regime[i]);
+            t.exit_regime = static_cast<Regime>(exit_regime[i]);
+            t.is_win = is_win[i] != 0;
+        }
+    }
+    
+    uint64_t equity_count = 0;
+    std::vector<double> equity;
+    std::vector<std::string> equity_times;
+    if (!get(in, equity_count) || !get_column(in, equity, equity_count, file_size) ||
+        !get_strings(in, equity_times, equity_count, file_size)) {
+        return false;
+    }
+    s.equity_curve.clear();
+    s.equity_curve.reserve(equity_count);
+    for (size_t i = 0; i < equity_count; ++i) {
+        s.equity_curve.emplace_back(std::move(equity_times[i]), equity[i]);
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// AsyncExporter
+// ---------------------------------------------------------------------------
+
+AsyncExporter::AsyncExporter()
+    : jobs(1024), worker(&AsyncExporter::loop, this) {
+}
+
+AsyncExporter::~AsyncExporter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping.store(true, std::memory_order_release);
+    }
+    work_ready.notify_one();
+    worker.join();
+}
+
+void AsyncExporter::submit(std::function<void()> job) {
+    submitted.fetch_add(1);
+    while (true) {
+        size_t seen = finished.load(std::memory_order_acquire);
+        if (jobs.try_push(std::move(job))) break; // only moved from on success
+        
+        // Full: wait for the worker to finish a job
+        std::unique_lock<std::mutex> lock(mutex);
+        progress.wait(lock, [&] { return finished.load(std::memory_order_acquire) != seen; });
+    }
+    
+    // Taking the lock orders this against the worker checking for work
+    // before it sleeps, so the wakeup can't be lost
+    { std::lock_guard<std::mutex> lock(mutex); }
+    work_ready.notify_one();
+}
+
+void AsyncExporter::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    progress.wait(lock, [this] { return finished.load(std::memory_order_acquire) == submitted.load(); });
+}
+
+void AsyncExporter::loop() {
+    std::function<void()> job;
+    while (true) {
+        // Every submit() happened before the flag was set, so an empty
+        // queue after reading it means the work is done
+        bool finishing = stopping.load(std::memory_order_acquire);
+        if (jobs.try_pop(job)) {
+            job();
+            job = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.fetch_add(1, std::memory_order_release);
+            }
+            progress.notify_all();
+        } else if (finishing) {
+            return;
+        } else {
+            // A job counted in `submitted` but not yet finished is either
+            // queued or about to be pushed
+            std::unique_lock<std::mutex> lock(mutex);
+            work_ready.wait(lock, [this] {
+                return stopping.load(std::memory_order_acquire) ||
+                       submitted.load() != finished.load(std::memory_order_relaxed);
+            });
+        }
+    }
+}
+
+} // namespace fluxback
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "analytics/Analytics.h"
+#include "concurrency/MpscRing.h"
+#include <charconv>
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace fluxback {
+
+// Append-only text buffer with std::to_chars number formatting.
+// Flushes to its file in large blocks.
+class OutputBuffer {
+public:
+    explicit OutputBuffer(size_t capacity = 1 << 20);
+    ~OutputBuffer();
+    
+    bool open(const std::string& path, bool binary = false);
+    bool close();
+    
+    // Without an open file the buffer just accumulates (see str())
+    const std::string& str() const { return buffer; }
+    void clear() { buffer.clear(); }
+    
+    OutputBuffer& append(std::string_view text);
+    OutputBuffer& append(char c);
+    OutputBuffer& append_int(long long value);
+    OutputBuffer& append_fixed(double value, int precision);
+    OutputBuffer& append_json_string(std::string_view text);
+    OutputBuffer& append_raw(const void* data, size_t size);
+
+private:
+    std::string buffer;
+    size_t capacity;
+    std::FILE* file = nullptr;
+    bool failed = false;
+    
+    void flush_if_full();
+    void flush();
+};
+
+// Structured result output: JSON summary (with per-regime stats and the
+// equity curve), CSV trade log, and a columnar binary file (.fxr)
+class ResultWriter {
+public:
+    // Complete summary JSON; the equity curve can be left out for compact replies
+    static void summary_json(OutputBuffer& out, const BacktestSummary& s, bool include_equity = true);
+    static std::string summary_json(const BacktestSummary& s, bool include_equity = true);
+    
+    static bool write_summary_json(const std::string& path, const BacktestSummary& s);
+    static bool write_trade_log(const std::string& path, const TradeLog& trades);
+    
+    // Columnar binary layout ("FXR4"): run label and summary scalars, then
+    // one column per trade field and the equity curve as parallel arrays.
+    // The label identifies the run's parameter set (see ConfigGrid::label).
+    static bool write_binary(const std::string& path, const BacktestSummary& s,
+                             const TradeLog& trades, const std::string& label = "");
+    
+    // With summary_only, stops after the scalars and per-regime stats
+    static bool read_binary(const std::string& path, BacktestSummary& s, TradeLog* trades = nullptr,
+                            std::string* label = nullptr, bool summary_only = false);
+};
+
+// Runs export jobs on a background thread so writing one run's results
+// overlaps with computing the next. Sweep workers submit through a
+// lock-free queue; when it is full, submit() waits for room. The worker
+// sleeps while there is nothing to export.
+class AsyncExporter {
+public:
+    AsyncExporter();
+    ~AsyncExporter();
+    
+    // From any thread
+    void submit(std::function<void()> job);
+    
+    // Block until every submitted job has finished
+    void wait();
+
+private:
+    MpscRing<std::function<void()>> jobs;
+    std::atomic<size_t> submitted{0};
+    std::atomic<size_t> finished{0};
+    std::atomic<bool> stopping{false};
+    std::mutex mutex;
+    std::condition_variable work_ready; // a job was queued, or stopping
+    std::condition_variable progress;   // a job finished
+    std::thread worker;
+    
+    void loop();
+};
+
+} // namespace fluxback
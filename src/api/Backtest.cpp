@@ -0,0 +1,140 @@
+#include "fluxback/Backtest.h"
+#include "engine/BacktestRunner.h"
+#include "utils/Timestamp.h"
+
+namespace fluxback {
+namespace api {
+
+struct Backtest::Impl {
+    StrategyConfig config;
+    double initial_cash = 100000.0;
+    std::unique_ptr<BacktestRunner> runner;
+    OHLCV scratch; // reused so streaming bars don't allocate
+    size_t bars = 0;
+    size_t skipped = 0;
+    
+    explicit Impl(StrategyConfig cfg)
+        : config(std::move(cfg)), runner(std::make_unique<BacktestRunner>(config, initial_cash)) {}
+};
+
+namespace {
+
+int64_t epoch_of(std::string_view timestamp) {
+    int64_t epoch = 0;
+    parse_timestamp(timestamp, epoch);
+    return epoch;
+}
+
+} // namespace
+
+std::unique_ptr<Backtest> Backtest::from_yaml(const std::string& yaml_text, std::string* error) {
+    StrategyConfig config = ConfigParser::parse_yaml_string(yaml_text);
+    if (config.name.empty()) {
+        if (error) *error = "failed to parse strategy configuration";
+        return nullptr;
+    }
+    return std::unique_ptr<Backtest>(new Backtest(std::make_unique<Impl>(std::move(config))));
+}
+
+std::unique_ptr<Backtest> Backtest::from_file(const std::string& yaml_path, std::string* error) {
+    StrategyConfig config = ConfigParser::parse_yaml(yaml_path);
+    if (config.name.empty()) {
+        if (error) *error = "failed to parse strategy configuration";
+        return nullptr;
+    }
+    return std::unique_ptr<Backtest>(new Backtest(std::make_unique<Impl>(std::move(config))));
+}
+
+Backtest::Backtest(std::unique_ptr<Impl> impl) : impl(std::move(impl)) {}
+
+Backtest::~Backtest() = default;
+
+const std::string& Backtest::name() const {
+    return impl->config.name;
+}
+
+void Backtest::set_initial_cash(double cash) {
+    impl->initial_cash = cash;
+    impl->runner = std::make_unique<BacktestRunner>(impl->config, cash);
+    impl->bars = 0;
+    impl->skipped = 0;
+}
+
+Result Backtest::run(BarSpan bars) {
+    reset();
+    for (const Bar& bar : bars) {
+        add_bar(bar);
+    }
+    return result();
+}
+
+bool Backtest::add_bar(const Bar& bar) {
+    OHLCV& tick = impl->scratch;
+    format_timestamp(bar.time, tick.timestamp, 'T');
+    tick.open = bar.open;
+    tick.high = bar.high;
+    tick.low = bar.low;
+    tick.close = bar.close;
+    tick.volume = static_cast<long>(bar.volume);
+    
+    ++impl->bars;
+    if (impl->runner->on_bar(tick)) return true;
+    ++impl->skipped;
+    return false;
+}
+
+Result Backtest::result() const {
+    BacktestSummary summary = impl->runner->summary();
+    
+    Result result;
+    Summary& out = result.summary;
+    out.total_return_pct = summary.total_return_pct;
+    out.annualized_return_pct = summary.annualized_return_pct;
+    out.sharpe_ratio = summary.sharpe_ratio;
+    out.max_drawdown_pct = summary.max_drawdown_pct;
+    out.total_trades = summary.total_trades;
+    out.winning_trades = summary.winning_trades;
+    out.losing_trades = summary.losing_trades;
+    out.win_rate_pct = summary.win_rate_pct;
+    out.profit_factor = summary.profit_factor;
+    out.initial_cash = summary.initial_cash;
+    out.final_cash = summary.final_cash;
+    out.commission = summary.commission;
+    out.exchange_fees = summary.exchange_fees;
+    out.borrow_cost = summary.borrow_cost;
+    out.financing_cost = summary.financing_cost;
+    out.vwap_shortfall_bps = summary.vwap_shortfall_bps;
+    
+    const TradeLog& trades = impl->runner->get_analytics().get_trades();
+    result.trades.reserve(trades.size());
+    for (const auto& trade : trades) {
+        Trade t;
+        t.entry_time = epoch_of(trade.entry_timestamp);
+        t.exit_time = epoch_of(trade.exit_timestamp);
+        t.entry_price = trade.entry_price;
+        t.exit_price = trade.exit_price;
+        t.quantity = trade.size;
+        t.pnl = trade.pnl;
+        t.pnl_pct = trade.pnl_pct;
+        t.entry_regime = static_cast<Regime>(trade.entry_regime);
+        t.exit_regime = static_cast<Regime>(trade.exit_regime);
+        result.trades.push_back(t);
+    }
+    
+    result.equity_curve.reserve(summary.equity_curve.size());
+    for (const auto& point : summary.equity_curve) {
+        result.equity_curve.push_back(EquityPoint{epoch_of(point.first), point.second});
+    }
+    result.bars = impl->bars;
+    result.skipped_bars = impl->skipped;
+    return result;
+}
+
+void Backtest::reset() {
+    impl->runner->reset();
+    impl->bars = 0;
+    impl->skipped = 0;
+}
+
+} // namespace api
+} // namespace fluxback
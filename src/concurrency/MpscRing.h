@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace fluxback {
+
+// Bounded lock-free ring for any number of producer threads and exactly one
+// consumer thread. Capacity is rounded up to a power of two. Every slot
+// carries a sequence number: producers claim a position with one CAS on the
+// tail, write the value, then publish it by bumping the slot's sequence,
+// so producers never wait on each other's writes. Values from one producer
+// come out in the order it pushed them.
+template <typename T>
+class MpscRing {
+public:
+    explicit MpscRing(size_t capacity) : slots(round_up(capacity)), mask(slots.size() - 1) {
+        for (size_t i = 0; i < slots.size(); ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+    
+    size_t capacity() const { return mask + 1; }
+    
+    // Any producer: false if the ring is full
+    bool try_push(const T& value) { return push(value); }
+    bool try_push(T&& value) { return push(std::move(value)); }
+    
+    // Consumer: false if the ring is empty (or the next value is still
+    // being written)
+    bool try_pop(T& value) {
+        Slot& slot = slots[head & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != head + 1) return false;
+        value = std::move(slot.value);
+        slot.sequence.store(head + mask + 1, std::memory_order_release);
+        ++head;
+        return true;
+    }
+
+private:
+    static constexpr size_t LINE = 64;
+    
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+    
+    std::vector<Slot> slots;
+    size_t mask;
+    
+    // Shared by producers, then consumer-owned, each on its own cache line
+    alignas(LINE) std::atomic<size_t> tail{0};
+    alignas(LINE) size_t head = 0;
+    
+    static size_t round_up(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        return size;
+    }
+    
+    template <typename U>
+    bool push(U&& value) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots[position & mask];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            intptr_t lag = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (lag == 0) {
+                // The slot is free for this position; claim it
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot.value = std::forward<U>(value);
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                return false; // the consumer hasn't freed it yet: full
+            } else {
+                position = tail.load(std::memory_order_relaxed); // another producer took it
+            }
+        }
+    }
+};
+
+} // namespace fluxback
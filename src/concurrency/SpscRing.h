@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace fluxback {
+
+// Bounded lock-free ring for exactly one producer thread and one consumer
+// thread. Capacity is rounded up to a power of two. Each side keeps a
+// cached copy of the other's index, so the shared cache line is only
+// read when the ring looks full (producer) or empty (consumer).
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        slots.resize(size);
+        mask = size - 1;
+    }
+    
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+    
+    size_t capacity() const { return mask + 1; }
+    
+    // Producer: false if the ring is full
+    bool try_push(const T& value) {
+        const size_t tail = write_index.load(std::memory_order_relaxed);
+        if (tail - cached_read > mask) {
+            cached_read = read_index.load(std::memory_order_acquire);
+            if (tail - cached_read > mask) return false;
+        }
+        slots[tail & mask] = value;
+        write_index.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Consumer: false if the ring is empty
+    bool try_pop(T& value) {
+        const size_t head = read_index.load(std::memory_order_relaxed);
+        if (head == cached_write) {
+            cached_write = write_index.load(std::memory_order_acquire);
+            if (head == cached_write) return false;
+        }
+        value = slots[head & mask];
+        read_index.store(head + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Consumer: move up to `max` values into `out`; returns how many
+    size_t pop_bulk(T* out, size_t max) {
+        const size_t head = read_index.load(std::memory_order_relaxed);
+        if (head == cached_write) {
+            cached_write = write_index.load(std::memory_order_acquire);
+        }
+        size_t count = cached_write - head;
+        if (count > max) count = max;
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = slots[(head + i) & mask];
+        }
+        if (count > 0) read_index.store(head + count, std::memory_order_release);
+        return count;
+    }
+    
+    // Either side; exact only while the other side is idle
+    bool empty() const {
+        return read_index.load(std::memory_order_acquire) == write_index.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr size_t LINE = 64;
+    
+    std::vector<T> slots;
+    size_t mask;
+    
+    // Producer-owned, then consumer-owned, each on its own cache line
+    alignas(LINE) std::atomic<size_t> write_index{0};
+    size_t cached_read = 0;
+    alignas(LINE) std::atomic<size_t> read_index{0};
+    size_t cached_write = 0;
+};
+
+} // namespace fluxback
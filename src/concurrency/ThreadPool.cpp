@@ -0,0 +1,156 @@
+#include "concurrency/ThreadPool.h"
+
+namespace fluxback {
+
+namespace {
+
+// Which pool (if any) the current thread works for
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local size_t current_index = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(&ThreadPool::worker_loop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool(std::max(2u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+size_t ThreadPool::worker_index() const {
+    return current_pool == this ? current_index : workers.size();
+}
+
+void ThreadPool::submit(Task task) {
+    // A worker keeps its own tasks (they are likely to share its cache);
+    // others spread theirs
+    size_t target = worker_index();
+    if (target == workers.size()) {
+        target = next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    queued.fetch_add(1);
+    
+    // Taking the lock orders this against a worker or helper checking
+    // `queued` before it sleeps, so the wakeup can't be lost
+    bool wake_helpers;
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        wake_helpers = helpers_waiting > 0;
+    }
+    wake.notify_one();
+    if (wake_helpers) helpers.notify_all();
+}
+
+bool ThreadPool::take(size_t self, Task& task) {
+    if (queued.load() == 0) return false;
+    
+    // Newest of our own tasks first, then the oldest of someone else's
+    if (self < queues.size()) {
+        Queue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued.fetch_sub(1);
+            return true;
+        }
+    }
+    size_t start = self < queues.size() ? self + 1 : next_queue.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < queues.size(); ++i) {
+        Queue& victim = *queues[(start + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::run_pending() {
+    Task task;
+    if (!take(worker_index(), task)) return false;
+    task();
+    return true;
+}
+
+void ThreadPool::worker_loop(size_t index) {
+    current_pool = this;
+    current_index = index;
+    while (true) {
+        Task task;
+        if (take(index, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        wake.wait(lock, [this] { return stopping || queued.load() > 0; });
+        if (stopping && queued.load() == 0) return;
+    }
+}
+
+void ThreadPool::run_workers(int count, const std::function<void(int slot)>& body) {
+    TaskGroup group(*this);
+    for (int slot = 1; slot < count; ++slot) {
+        group.run([&body, slot]() { body(slot); });
+    }
+    body(0);
+    group.wait();
+}
+
+void TaskGroup::run(ThreadPool::Task task) {
+    pending.fetch_add(1);
+    pool.submit([this, &pool = pool, task = std::move(task)]() {
+        task();
+        // Count down under the lock wait() sleeps with; once pending
+        // reaches zero the group may be gone, so only the pool is touched
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(pool.sleep_mutex);
+            last = pending.fetch_sub(1) == 1;
+        }
+        if (last) pool.helpers.notify_all();
+    });
+}
+
+void TaskGroup::wait() {
+    while (pending.load() > 0) {
+        if (pool.run_pending()) continue;
+        
+        // Nothing queued: our tasks are running elsewhere. Sleep until one
+        // of them finishes the group or queues more work we can help with.
+        std::unique_lock<std::mutex> lock(pool.sleep_mutex);
+        ++pool.helpers_waiting;
+        pool.helpers.wait(lock, [this] { return pending.load() == 0 || pool.queued.load() > 0; });
+        --pool.helpers_waiting;
+    }
+}
+
+} // namespace fluxback
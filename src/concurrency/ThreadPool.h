@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fluxback {
+
+// Work-stealing thread pool shared by every parallel part of the engine
+// (sweeps, regime labelling, model fits, parallel loads, Monte Carlo,
+// result stats, the server). Each worker has its own task deque: it pops
+// its newest task, and idle workers steal the oldest task of another.
+// Tasks submitted from outside the pool are spread round-robin. Threads
+// that wait for tasks (TaskGroup::wait, run_workers) run queued tasks
+// meanwhile, so parallel code may nest without deadlocking. Tasks must not
+// throw, and must not block waiting on a task that hasn't started.
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+    
+    // `threads` workers (0 = one per hardware thread)
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    // The process-wide pool: one worker per hardware thread but one, since
+    // callers of run_workers() work too
+    static ThreadPool& shared();
+    
+    size_t size() const { return workers.size(); }
+    
+    void submit(Task task);
+    
+    // Run one queued task on the calling thread; false if none was queued
+    bool run_pending();
+    
+    // Index of the calling thread among this pool's workers, or size() for
+    // any thread outside the pool
+    size_t worker_index() const;
+    
+    // Run body(slot) for every slot in [0, count): slot 0 on the calling
+    // thread, the rest as tasks. Returns once every slot has finished.
+    // Replaces "spawn count - 1 threads, work, join" loops; slots beyond
+    // the pool's size run as workers free up.
+    void run_workers(int count, const std::function<void(int slot)>& body);
+    
+    // Call fn(i) for every i in [0, count) on up to `parallel` slots, each
+    // taking the next index as it finishes one
+    template <typename Fn>
+    void parallel_for(size_t count, int parallel, Fn fn) {
+        if (count == 0) return;
+        size_t slots = std::min(count, static_cast<size_t>(std::max(1, parallel)));
+        std::atomic<size_t> next{0};
+        run_workers(static_cast<int>(slots), [&](int) {
+            size_t i;
+            while ((i = next.fetch_add(1)) < count) {
+                fn(i);
+            }
+        });
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+    
+    std::vector<std::unique_ptr<Queue>> queues; // one per worker
+    std::vector<std::thread> workers;
+    std::atomic<size_t> queued{0};
+    std::atomic<size_t> next_queue{0};
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    std::condition_variable helpers; // TaskGroup::wait callers with nothing to run
+    size_t helpers_waiting = 0;
+    bool stopping = false;
+    
+    bool take(size_t self, Task& task);
+    void worker_loop(size_t index);
+    
+    friend class TaskGroup;
+};
+
+// Tasks that can be waited for together
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool = ThreadPool::shared()) : pool(pool) {}
+    ~TaskGroup() { wait(); }
+    
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+    
+    void run(ThreadPool::Task task);
+    
+    // Block until every task run() so far has finished, running queued
+    // tasks (of any group) in the meantime
+    void wait();
+
+private:
+    ThreadPool& pool;
+    std::atomic<size_t> pending{0};
+};
+
+// One T per worker of a pool, plus one shared by threads outside it, so
+// tasks can keep scratch state (arenas, buffers) without locking and
+// without allocating per task. Slots are cache-line aligned. Only one
+// outside thread may use its slot at a time.
+template <typename T>
+class WorkerLocal {
+public:
+    explicit WorkerLocal(ThreadPool& pool = ThreadPool::shared()) : pool(pool), slots(pool.size() + 1) {}
+    
+    // The calling thread's instance
+    T& local() { return slots[pool.worker_index()].value; }
+    
+    // Visit every instance; only while no task is using them
+    template <typename Fn>
+    void for_each(Fn fn) {
+        for (auto& slot : slots) fn(slot.value);
+    }
+
+private:
+    struct alignas(64) Slot {
+        T value;
+    };
+    
+    ThreadPool& pool;
+    std::vector<Slot> slots;
+};
+
+} // namespace fluxback
@@ -0,0 +1,61 @@
+#include "data/BarAggregator.h"
+#include "utils/Timestamp.h"
+#include <algorithm>
+
+namespace fluxback {
+
+namespace {
+
+// Empty bar that keeps its timestamp buffer
+void clear_bar(OHLCV& bar) {
+    bar.timestamp.clear();
+    bar.open = bar.high = bar.low = bar.close = 0.0;
+    bar.volume = 0;
+}
+
+} // namespace
+
+BarAggregator::BarAggregator(int period_minutes)
+    : period_minutes(std::max(1, period_minutes)), current_bucket(0), has_current(false),
+      completed_count(0) {
+    // Room for the usual timestamp formats, so runs copy them without allocating
+    building.timestamp.reserve(32);
+    completed.timestamp.reserve(32);
+}
+
+void BarAggregator::reset() {
+    has_current = false;
+    completed_count = 0;
+    clear_bar(building);
+    clear_bar(completed);
+}
+
+bool BarAggregator::update(const OHLCV& bar) {
+    int64_t epoch = 0;
+    if (!parse_timestamp(bar.timestamp, epoch)) return false;
+    int64_t period_seconds = static_cast<int64_t>(period_minutes) * 60;
+    int64_t bucket = epoch >= 0 ? epoch / period_seconds : (epoch - period_seconds + 1) / period_seconds;
+    
+    bool rolled = false;
+    if (has_current && bucket != current_bucket) {
+        completed = building;
+        completed_count++;
+        has_current = false;
+        rolled = true;
+    }
+    
+    if (!has_current) {
+        building = bar;
+        current_bucket = bucket;
+        has_current = true;
+    } else {
+        building.high = std::max(building.high, bar.high);
+        building.low = std::min(building.low, bar.low);
+        building.close = bar.close;
+        building.volume += bar.volume;
+    }
+    
+    return rolled;
+}
+
+} // namespace fluxback
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "data/DataLoader.h"
+#include <cstdint>
+
+namespace fluxback {
+
+// Builds higher-timeframe OHLCV bars incrementally from a base bar stream.
+// A bar is complete when the first base bar of the next period arrives,
+// so completed bars never contain future data.
+class BarAggregator {
+public:
+    explicit BarAggregator(int period_minutes);
+    
+    // Add a base bar; returns true if it closed the previous period
+    bool update(const OHLCV& bar);
+    
+    int get_period_minutes() const { return period_minutes; }
+    bool has_completed() const { return completed_count > 0; }
+    size_t get_completed_count() const { return completed_count; }
+    
+    const OHLCV& last_completed() const { return completed; }
+    const OHLCV& current() const { return building; }
+    
+    void reset();
+
+private:
+    int period_minutes;
+    int64_t current_bucket;
+    bool has_current;
+    size_t completed_count;
+    OHLCV building;
+    OHLCV completed;
+};
+
+} // namespace fluxback
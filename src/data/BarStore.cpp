@@ -0,0 +1,482 @@
+#include "data/BarStore.h"
+#include "utils/Timestamp.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace fluxback {
+
+namespace {
+
+const char STORE_MAGIC[4] = {'F', 'X', 'B', '1'};
+const uint32_t STORE_VERSION = 1;
+
+const uint64_t HEADER_BYTES = 24;
+const uint64_t INDEX_ENTRY_BYTES = 32;
+
+// Smallest encoding of a bar: one byte per column, plus a mode byte per
+// price column per block
+const uint64_t MIN_BAR_BYTES = 6;
+const uint64_t PRICE_COLUMNS = 4;
+
+// Fixed-width fields are written in native (little-endian) byte order, the
+// same as the other binary formats
+template <typename T>
+void put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool get(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+inline uint64_t zigzag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+inline int64_t unzigzag(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+inline void put_varint(std::string& out, uint64_t v) {
+    char bytes[10];
+    size_t n = 0;
+    while (v >= 0x80) {
+        bytes[n++] = static_cast<char>(v | 0x80);
+        v >>= 7;
+    }
+    bytes[n++] = static_cast<char>(v);
+    out.append(bytes, n);
+}
+
+inline bool get_varint(const unsigned char*& p, const unsigned char* end, uint64_t& v) {
+    // One-byte values are the common case for timestamp deltas
+    if (p < end && *p < 0x80) {
+        v = *p++;
+        return true;
+    }
+    v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        uint64_t byte = *p++;
+        v |= (byte & 0x7f) << shift;
+        if (byte < 0x80) return true;
+    }
+    return false;
+}
+
+inline int leading_zero_bytes(uint64_t x) {
+    int n = 0;
+    while ((x & 0xff00000000000000ULL) == 0) {
+        x <<= 8;
+        n++;
+    }
+    return n;
+}
+
+inline int trailing_zero_bytes(uint64_t x) {
+    int n = 0;
+    while ((x & 0xff) == 0) {
+        x >>= 8;
+        n++;
+    }
+    return n;
+}
+
+const double DECIMAL_SCALES[] = {1.0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8};
+const unsigned char XOR_COLUMN = 0xff;
+
+// Fewest decimals that represent every value in [begin, end) exactly, or -1.
+// Quoted prices usually have two to four, and small integer deltas compress
+// far better than the XOR of binary fractions.
+int decimal_places(const std::vector<double>& values, size_t begin, size_t end) {
+    int places = 0;
+    for (size_t i = begin; i < end; ++i) {
+        double v = values[i];
+        while (true) {
+            double scaled = v * DECIMAL_SCALES[places];
+            if (std::fabs(scaled) < 9e15 && static_cast<double>(std::llround(scaled)) / DECIMAL_SCALES[places] == v) {
+                break;
+            }
+            if (++places > 8) return -1;
+        }
+    }
+    return places;
+}
+
+// A column starts with a mode byte: the number of decimal places, with each
+// value stored as the zigzag varint delta of its scaled integer; or
+// XOR_COLUMN, where each value is XORed with the previous one and a control
+// byte holds the number of trailing zero bytes (high nibble) and meaningful
+// bytes (low nibble) of the XOR, 0 meaning the value repeated.
+void encode_doubles(const std::vector<double>& values, size_t begin, size_t end, std::string& out) {
+    int places = decimal_places(values, begin, end);
+    if (places >= 0) {
+        out.push_back(static_cast<char>(places));
+        int64_t prev = 0;
+        for (size_t i = begin; i < end; ++i) {
+            int64_t scaled = std::llround(values[i] * DECIMAL_SCALES[places]);
+            put_varint(out, zigzag(scaled - prev));
+            prev = scaled;
+        }
+        return;
+    }
+    
+    out.push_back(static_cast<char>(XOR_COLUMN));
+    uint64_t prev = 0;
+    for (size_t i = begin; i < end; ++i) {
+        uint64_t bits;
+        std::memcpy(&bits, &values[i], sizeof(bits));
+        uint64_t x = bits ^ prev;
+        prev = bits;
+        if (x == 0) {
+            out.push_back('\0');
+            continue;
+        }
+        int tz = trailing_zero_bytes(x);
+        int n = 8 - tz - leading_zero_bytes(x);
+        out.push_back(static_cast<char>((tz << 4) | n));
+        uint64_t shifted = x >> (tz * 8);
+        out.append(reinterpret_cast<const char*>(&shifted), static_cast<size_t>(n));
+    }
+}
+
+bool decode_doubles(const unsigned char*& p, const unsigned char* end, size_t count, std::vector<double>& out) {
+    if (p >= end) return false;
+    unsigned mode = *p++;
+    size_t base = out.size();
+    out.resize(base + count);
+    double* dst = out.data() + base;
+    
+    if (mode != XOR_COLUMN) {
+        if (mode > 8) return false;
+        const double scale = DECIMAL_SCALES[mode];
+        int64_t prev = 0;
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t v;
+            if (!get_varint(p, end, v)) return false;
+            prev += unzigzag(v);
+            dst[i] = static_cast<double>(prev) / scale;
+        }
+        return true;
+    }
+    
+    uint64_t prev = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (p >= end) return false;
+        unsigned control = *p++;
+        if (control != 0) {
+            unsigned n = control & 0x0f;
+            unsigned tz = control >> 4;
+            if (n == 0 || n + tz > 8 || static_cast<size_t>(end - p) < n) return false;
+            uint64_t x = 0;
+            if (end - p >= 8) {
+                // Whole-word load, then mask off the bytes of the next value
+                std::memcpy(&x, p, 8);
+                if (n < 8) x &= (uint64_t(1) << (n * 8)) - 1;
+            } else {
+                std::memcpy(&x, p, n);
+            }
+            p += n;
+            prev ^= x << (tz * 8);
+        }
+        std::memcpy(&dst[i], &prev, sizeof(prev));
+    }
+    return true;
+}
+
+} // namespace
+
+void BarColumns::clear() {
+    epoch.clear();
+    open.clear();
+    high.clear();
+    low.clear();
+    close.clear();
+    volume.clear();
+}
+
+void BarColumns::reserve(size_t count) {
+    epoch.reserve(count);
+    open.reserve(count);
+    high.reserve(count);
+    low.reserve(count);
+    close.reserve(count);
+    volume.reserve(count);
+}
+
+void BarStore::encode_block(const BarColumns& columns, size_t begin, size_t end, std::string& out) {
+    // Timestamps: first value, then delta-of-delta (regular bars give zeros)
+    int64_t prev = 0;
+    int64_t prev_delta = 0;
+    for (size_t i = begin; i < end; ++i) {
+        int64_t delta = columns.epoch[i] - prev;
+        put_varint(out, zigzag(i == begin ? columns.epoch[i] : delta - prev_delta));
+        if (i != begin) prev_delta = delta;
+        prev = columns.epoch[i];
+    }
+    
+    encode_doubles(columns.open, begin, end, out);
+    encode_doubles(columns.high, begin, end, out);
+    encode_doubles(columns.low, begin, end, out);
+    encode_doubles(columns.close, begin, end, out);
+    
+    for (size_t i = begin; i < end; ++i) {
+        put_varint(out, zigzag(columns.volume[i]));
+    }
+}
+
+bool BarStore::decode_block(const char* data, size_t size, size_t count, BarColumns& out) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* end = p + size;
+    
+    size_t base = out.epoch.size();
+    out.epoch.resize(base + count);
+    int64_t prev = 0;
+    int64_t delta = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t v;
+        if (!get_varint(p, end, v)) return false;
+        if (i == 0) {
+            prev = unzigzag(v);
+        } else {
+            delta += unzigzag(v);
+            prev += delta;
+        }
+        out.epoch[base + i] = prev;
+    }
+    
+    if (!decode_doubles(p, end, count, out.open) || !decode_doubles(p, end, count, out.high) ||
+        !decode_doubles(p, end, count, out.low) || !decode_doubles(p, end, count, out.close)) {
+        return false;
+    }
+    
+    out.volume.resize(base + count);
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t v;
+        if (!get_varint(p, end, v)) return false;
+        out.volume[base + i] = unzigzag(v);
+    }
+    return p == end;
+}
+
+bool BarStore::is_bar_store(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[4];
+    return in.read(magic, sizeof(magic)) && std::memcmp(magic, STORE_MAGIC, sizeof(magic)) == 0;
+}
+
+bool BarStore::write(const std::string& path, const std::vector<OHLCV>& bars, size_t block_bars) {
+    if (block_bars == 0) block_bars = DEFAULT_BLOCK_BARS;
+    
+    // Timestamps are stored as epoch seconds, so every one must format back
+    // to the exact text it was read from
+    char separator = '\0';
+    if (!bars.empty() && bars[0].timestamp.size() > 10 && bars[0].timestamp[4] == '-') {
+        separator = bars[0].timestamp[10];
+    }
+    BarColumns columns;
+    columns.reserve(bars.size());
+    for (size_t i = 0; i < bars.size(); ++i) {
+        const OHLCV& bar = bars[i];
+        int64_t epoch = 0;
+        if (!parse_timestamp(bar.timestamp, epoch) || format_timestamp(epoch, separator) != bar.timestamp) {
+            std::cerr << "Error: Timestamp '" << bar.timestamp << "' on bar " << i
+                      << " cannot be stored exactly (expected YYYY-MM-DD HH:MM:SS or epoch seconds)\n";
+            return false;
+        }
+        columns.epoch.push_back(epoch);
+        columns.open.push_back(bar.open);
+        columns.high.push_back(bar.high);
+        columns.low.push_back(bar.low);
+        columns.close.push_back(bar.close);
+        columns.volume.push_back(bar.volume);
+    }
+    
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "Error: Could not write bar store: " << path << "\n";
+        return false;
+    }
+    
+    // Header: magic, version, timestamp format, block size, bar count
+    std::string header(STORE_MAGIC, sizeof(STORE_MAGIC));
+    put(header, STORE_VERSION);
+    put(header, static_cast<uint32_t>(static_cast<unsigned char>(separator)));
+    put(header, static_cast<uint32_t>(block_bars));
+    put(header, static_cast<uint64_t>(bars.size()));
+    out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    
+    std::vector<BarBlockInfo> index;
+    std::string block;
+    uint64_t offset = header.size();
+    for (size_t begin = 0; begin < bars.size(); begin += block_bars) {
+        size_t end = std::min(bars.size(), begin + block_bars);
+        block.clear();
+        encode_block(columns, begin, end, block);
+        out.write(block.data(), static_cast<std::streamsize>(block.size()));
+    
+        BarBlockInfo info;
+        auto span = std::minmax_element(columns.epoch.begin() + begin, columns.epoch.begin() + end);
+        info.first_epoch = *span.first;
+        info.last_epoch = *span.second;
+        info.bar_count = static_cast<uint32_t>(end - begin);
+        info.byte_size = static_cast<uint32_t>(block.size());
+        info.offset = offset;
+        offset += block.size();
+        index.push_back(info);
+    }
+    
+    // Block index, then its offset as the last 8 bytes of the file
+    std::string footer;
+    put(footer, static_cast<uint64_t>(index.size()));
+    for (const auto& info : index) {
+        put(footer, info.first_epoch);
+        put(footer, info.last_epoch);
+        put(footer, info.bar_count);
+        put(footer, info.byte_size);
+        put(footer, info.offset);
+    }
+    put(footer, offset);
+    out.write(footer.data(), static_cast<std::streamsize>(footer.size()));
+    return static_cast<bool>(out);
+}
+
+bool BarStore::open(const std::string& path) {
+    file.close();
+    index.clear();
+    bar_count = 0;
+    
+    file.open(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    
+    char magic[4];
+    uint32_t version = 0, format = 0, block_bars = 0;
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, STORE_MAGIC, sizeof(magic)) != 0 ||
+        !get(file, version) || version != STORE_VERSION || !get(file, format) || !get(file, block_bars) ||
+        !get(file, bar_count)) {
+        std::cerr << "Error: Not a bar store file: " << path << "\n";
+        file.close();
+        return false;
+    }
+    separator = static_cast<char>(format);
+    
+    // Every count and offset is checked against the file before it is used
+    // to size anything, so a corrupt file can't ask for huge allocations
+    file.seekg(0, std::ios::end);
+    uint64_t file_size = static_cast<uint64_t>(file.tellg());
+    uint64_t index_offset = 0;
+    uint64_t block_count = 0;
+    bool ok = file_size >= HEADER_BYTES + 2 * sizeof(uint64_t);
+    if (ok) {
+        file.seekg(-static_cast<std::streamoff>(sizeof(index_offset)), std::ios::end);
+        ok = get(file, index_offset) && index_offset >= HEADER_BYTES &&
+             index_offset <= file_size - 2 * sizeof(uint64_t);
+    }
+    if (ok) {
+        file.seekg(static_cast<std::streamoff>(index_offset));
+        ok = get(file, block_count) &&
+             block_count <= (file_size - index_offset - 2 * sizeof(uint64_t)) / INDEX_ENTRY_BYTES;
+    }
+    uint64_t indexed_bars = 0;
+    for (uint64_t i = 0; ok && i < block_count; ++i) {
+        BarBlockInfo info;
+        ok = get(file, info.first_epoch) && get(file, info.last_epoch) && get(file, info.bar_count) &&
+             get(file, info.byte_size) && get(file, info.offset) &&
+             info.offset >= HEADER_BYTES && info.offset <= index_offset &&
+             info.byte_size <= index_offset - info.offset &&
+             static_cast<uint64_t>(info.bar_count) * MIN_BAR_BYTES + PRICE_COLUMNS <= info.byte_size;
+        indexed_bars += info.bar_count;
+        index.push_back(info);
+    }
+    if (ok && indexed_bars != bar_count) {
+        std::cerr << "Error: Corrupt bar store: header counts " << bar_count << " bars, index "
+                  << indexed_bars << ": " << path << "\n";
+        file.close();
+        index.clear();
+        bar_count = 0;
+        return false;
+    }
+    if (!ok) {
+        std::cerr << "Error: Corrupt bar store index: " << path << "\n";
+        file.close();
+        index.clear();
+        bar_count = 0;
+        return false;
+    }
+    return true;
+}
+
+bool BarStore::read_block(size_t block, BarColumns& out) {
+    if (!file.is_open() || block >= index.size()) return false;
+    const BarBlockInfo& info = index[block];
+    
+    buffer.resize(info.byte_size);
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(info.offset));
+    if (!file.read(buffer.data(), static_cast<std::streamsize>(info.byte_size)) ||
+        !decode_block(buffer.data(), buffer.size(), info.bar_count, out)) {
+        std::cerr << "Error: Corrupt bar store block " << block << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool BarStore::read_block(size_t block, std::vector<OHLCV>& out) {
+    scratch.clear();
+    if (!read_block(block, scratch)) return false;
+    
+    out.reserve(out.size() + scratch.size());
+    for (size_t i = 0; i < scratch.size(); ++i) {
+        OHLCV bar;
+        bar.timestamp = format_timestamp(scratch.epoch[i], separator);
+        bar.open = scratch.open[i];
+        bar.high = scratch.high[i];
+        bar.low = scratch.low[i];
+        bar.close = scratch.close[i];
+        bar.volume = static_cast<long>(scratch.volume[i]);
+        out.push_back(std::move(bar));
+    }
+    return true;
+}
+
+bool BarStore::read_block(size_t block, std::vector<OHLCV>& out, int64_t first_epoch, int64_t last_epoch) {
+    if (block >= index.size()) return false;
+    const BarBlockInfo& info = index[block];
+    if (info.last_epoch < first_epoch || info.first_epoch > last_epoch) return true;
+    
+    size_t base = out.size();
+    if (!read_block(block, out)) return false;
+    if (info.first_epoch >= first_epoch && info.last_epoch <= last_epoch) return true;
+    
+    // Partially covered block: keep the bars inside the range
+    size_t kept = base;
+    for (size_t i = 0; i < scratch.size(); ++i) {
+        if (scratch.epoch[i] >= first_epoch && scratch.epoch[i] <= last_epoch) {
+            if (kept != base + i) out[kept] = std::move(out[base + i]);
+            kept++;
+        }
+    }
+    out.resize(kept);
+    return true;
+}
+
+std::vector<OHLCV> BarStore::read_range(int64_t first_epoch, int64_t last_epoch) {
+    std::vector<OHLCV> bars;
+    for (size_t b = 0; b < index.size(); ++b) {
+        if (!read_block(b, bars, first_epoch, last_epoch)) return {};
+    }
+    return bars;
+}
+
+std::vector<OHLCV> BarStore::read_all() {
+    std::vector<OHLCV> bars;
+    bars.reserve(size());
+    for (size_t b = 0; b < index.size(); ++b) {
+        if (!read_block(b, bars)) return {};
+    }
+    return bars;
+}
+
+} // namespace fluxback
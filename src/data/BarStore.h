@@ -0,0 +1,80 @@
+#pragma once
+
+#include "data/DataLoader.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fluxback {
+
+// Location and time span of one compressed block
+struct BarBlockInfo {
+    int64_t first_epoch = 0;   // earliest timestamp in the block
+    int64_t last_epoch = 0;    // latest timestamp in the block
+    uint32_t bar_count = 0;
+    uint32_t byte_size = 0;
+    uint64_t offset = 0;
+};
+
+// Bars held column-wise, timestamps as epoch seconds
+struct BarColumns {
+    std::vector<int64_t> epoch;
+    std::vector<double> open;
+    std::vector<double> high;
+    std::vector<double> low;
+    std::vector<double> close;
+    std::vector<int64_t> volume;
+    
+    size_t size() const { return epoch.size(); }
+    void clear();
+    void reserve(size_t count);
+};
+
+// Block-compressed binary bar file (".fxb"). Each block stores its bars one
+// column at a time: timestamps as delta-of-delta varints, prices as varint
+// deltas of scaled decimals when exact (else a byte-aligned Gorilla-style
+// XOR against the previous value), volume as zigzag varints. The block
+// index at the end of the file records each block's time span, so a date
+// range only decodes the blocks it overlaps.
+class BarStore {
+public:
+    static const size_t DEFAULT_BLOCK_BARS = 4096;
+    
+    // True if the file starts with the bar store magic
+    static bool is_bar_store(const std::string& path);
+    
+    // Encode bars into a new file. Fails if a timestamp would not read back
+    // as the same text (formats other than parse_timestamp's canonical ones).
+    static bool write(const std::string& path, const std::vector<OHLCV>& bars,
+                      size_t block_bars = DEFAULT_BLOCK_BARS);
+    
+    bool open(const std::string& path);
+    bool is_open() const { return file.is_open(); }
+    size_t size() const { return static_cast<size_t>(bar_count); }
+    const std::vector<BarBlockInfo>& blocks() const { return index; }
+    
+    // Decode one block, appending to out
+    bool read_block(size_t block, BarColumns& out);
+    bool read_block(size_t block, std::vector<OHLCV>& out);
+    // Only the block's bars with first_epoch <= timestamp <= last_epoch
+    bool read_block(size_t block, std::vector<OHLCV>& out, int64_t first_epoch, int64_t last_epoch);
+    
+    // Bars with first_epoch <= timestamp <= last_epoch
+    std::vector<OHLCV> read_range(int64_t first_epoch, int64_t last_epoch);
+    std::vector<OHLCV> read_all();
+    
+    // Column codecs for rows [begin, end) of columns
+    static void encode_block(const BarColumns& columns, size_t begin, size_t end, std::string& out);
+    static bool decode_block(const char* data, size_t size, size_t count, BarColumns& out);
+
+private:
+    std::ifstream file;
+    std::vector<BarBlockInfo> index;
+    std::vector<char> buffer;
+    BarColumns scratch;
+    uint64_t bar_count = 0;
+    char separator = ' ';   // timestamp text format, see format_timestamp
+};
+
+} // namespace fluxback
@@ -0,0 +1,222 @@
+#include "data/DataIndex.h"
+#include "utils/Timestamp.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace fluxback {
+
+namespace {
+
+const char INDEX_MAGIC[4] = {'F', 'X', 'I', 'X'};
+const uint32_t INDEX_VERSION = 2; // 2: sortedness checked on every row
+const size_t READ_BLOCK_BYTES = 4 << 20;
+
+template <typename T>
+void write_pod(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool read_pod(std::ifstream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+bool fingerprint(const std::string& data_path, uint64_t& size, int64_t& mtime) {
+    std::error_code ec;
+    auto file_size = std::filesystem::file_size(data_path, ec);
+    if (ec) return false;
+    auto write_time = std::filesystem::last_write_time(data_path, ec);
+    if (ec) return false;
+    size = static_cast<uint64_t>(file_size);
+    mtime = static_cast<int64_t>(write_time.time_since_epoch().count());
+    return true;
+}
+
+} // namespace
+
+bool DataIndex::row_epoch(std::string_view line, int64_t& epoch) {
+    std::string_view field = line.substr(0, line.find(','));
+    while (!field.empty() && (field.front() == ' ' || field.front() == '\t' || field.front() == '"')) {
+        field.remove_prefix(1);
+    }
+    while (!field.empty() && (field.back() == ' ' || field.back() == '\r' || field.back() == '"')) {
+        field.remove_suffix(1);
+    }
+    return parse_timestamp(field, epoch);
+}
+
+std::string DataIndex::sidecar_path(const std::string& data_path) {
+    return data_path + ".fxidx";
+}
+
+bool DataIndex::open(const std::string& data_path) {
+    std::string index_path = sidecar_path(data_path);
+    if (load(index_path, data_path)) return true;
+    if (!build(data_path)) return false;
+    save(index_path, data_path); // read-only directories just skip the cache
+    return true;
+}
+
+bool DataIndex::build(const std::string& data_path) {
+    samples.clear();
+    rows = 0;
+    first_row_offset = 0;
+    size = 0;
+    sorted = true;
+    valid = false;
+    
+    std::ifstream in(data_path, std::ios::binary);
+    if (!in.is_open()) return false;
+    
+    // Walk whole lines block by block; a partial last line carries over
+    std::vector<char> buffer;
+    size_t carry = 0;
+    uint64_t buffer_offset = 0;   // file offset of buffer[0]
+    int64_t last_epoch = 0;
+    bool header = true;
+    while (true) {
+        buffer.resize(carry + READ_BLOCK_BYTES);
+        in.read(buffer.data() + carry, static_cast<std::streamsize>(READ_BLOCK_BYTES));
+        size_t got = static_cast<size_t>(in.gcount());
+        size_t filled = carry + got;
+        bool at_end = got == 0 || !in;
+    
+        size_t pos = 0;
+        while (pos < filled) {
+            const char* line = buffer.data() + pos;
+            const char* newline = static_cast<const char*>(std::memchr(line, '\n', filled - pos));
+            if (newline == nullptr && !at_end) break;
+            size_t length = newline != nullptr ? static_cast<size_t>(newline - line) : filled - pos;
+            uint64_t line_offset = buffer_offset + pos;
+            pos += length + 1;
+    
+            if (header) {
+                header = false;
+                first_row_offset = std::min<uint64_t>(buffer_offset + pos, buffer_offset + filled);
+                continue;
+            }
+            // Only non-empty rows with a comma count as bars
+            if (length == 0 || std::memchr(line, ',', length) == nullptr) continue;
+    
+            // Every row counts for sortedness: one out of order between two
+            // samples would otherwise end a range read early
+            bool sample = rows % STRIDE == 0;
+            if (sorted || sample) {
+                int64_t epoch = 0;
+                if (!row_epoch(std::string_view(line, length), epoch)) {
+                    sorted = false;
+                } else {
+                    if (rows > 0 && epoch < last_epoch) sorted = false;
+                    last_epoch = epoch;
+                }
+                if (sample) samples.push_back(IndexEntry{epoch, line_offset});
+            }
+            rows++;
+        }
+    
+        if (at_end) break;
+        carry = filled - std::min(pos, filled);
+        std::memmove(buffer.data(), buffer.data() + filled - carry, carry);
+        buffer_offset += filled - carry;
+    }
+    
+    std::error_code ec;
+    size = static_cast<uint64_t>(std::filesystem::file_size(data_path, ec));
+    valid = !ec;
+    return valid;
+}
+
+bool DataIndex::save(const std::string& index_path, const std::string& data_path) const {
+    uint64_t data_size = 0;
+    int64_t data_mtime = 0;
+    if (!valid || !fingerprint(data_path, data_size, data_mtime)) return false;
+    
+    // Written beside the sidecar and renamed over it, so a failed write
+    // never leaves a torn index; in a read-only directory nothing is written
+    std::string temp_path = index_path + ".tmp";
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+    
+    out.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    write_pod(out, INDEX_VERSION);
+    write_pod(out, data_size);
+    write_pod(out, data_mtime);
+    write_pod(out, rows);
+    write_pod(out, first_row_offset);
+    write_pod(out, static_cast<uint8_t>(sorted ? 1 : 0));
+    write_pod(out, static_cast<uint64_t>(samples.size()));
+    for (const auto& entry : samples) {
+        write_pod(out, entry.epoch);
+        write_pod(out, entry.offset);
+    }
+    out.close();
+    
+    std::error_code ec;
+    if (out) std::filesystem::rename(temp_path, index_path, ec);
+    if (!out || ec) {
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+bool DataIndex::load(const std::string& index_path, const std::string& data_path) {
+    std::ifstream in(index_path, std::ios::binary);
+    if (!in.is_open()) return false;
+    
+    uint64_t data_size = 0;
+    int64_t data_mtime = 0;
+    if (!fingerprint(data_path, data_size, data_mtime)) return false;
+    std::error_code ec;
+    const uint64_t file_size = std::filesystem::file_size(index_path, ec);
+    if (ec) return false;
+    
+    char magic[4];
+    uint32_t version = 0;
+    uint64_t stored_size = 0, sample_count = 0;
+    int64_t stored_mtime = 0;
+    uint8_t stored_sorted = 0;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, INDEX_MAGIC, sizeof(magic)) != 0) return false;
+    if (!read_pod(in, version) || version != INDEX_VERSION) return false;
+    if (!read_pod(in, stored_size) || !read_pod(in, stored_mtime)) return false;
+    if (stored_size != data_size || stored_mtime != data_mtime) return false; // stale
+    if (!read_pod(in, rows) || !read_pod(in, first_row_offset) || !read_pod(in, stored_sorted) ||
+        !read_pod(in, sample_count)) {
+        return false;
+    }
+    
+    // The samples must fill the rest of the file exactly; anything else is
+    // a corrupt sidecar, rebuilt like a stale one
+    const uint64_t entry_bytes = sizeof(int64_t) + sizeof(uint64_t);
+    uint64_t remaining = file_size - static_cast<uint64_t>(in.tellg());
+    if (sample_count != remaining / entry_bytes || remaining % entry_bytes != 0) return false;
+    
+    std::vector<IndexEntry> loaded(static_cast<size_t>(sample_count));
+    for (auto& entry : loaded) {
+        if (!read_pod(in, entry.epoch) || !read_pod(in, entry.offset)) return false;
+    }
+    samples = std::move(loaded);
+    sorted = stored_sorted != 0;
+    size = data_size;
+    valid = true;
+    return true;
+}
+
+uint64_t DataIndex::seek_offset(int64_t epoch) const {
+    // Last sample strictly before epoch: every earlier row is before it too
+    auto it = std::lower_bound(samples.begin(), samples.end(), epoch,
+                               [](const IndexEntry& entry, int64_t value) { return entry.epoch < value; });
+    if (it == samples.begin()) return first_row_offset;
+    return std::prev(it)->offset;
+}
+
+uint64_t DataIndex::end_offset(int64_t epoch) const {
+    auto it = std::upper_bound(samples.begin(), samples.end(), epoch,
+                               [](int64_t value, const IndexEntry& entry) { return value < entry.epoch; });
+    return it == samples.end() ? size : it->offset;
+}
+
+} // namespace fluxback
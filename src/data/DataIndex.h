@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fluxback {
+
+// Sampled row of a CSV file: its timestamp and where the line starts
+struct IndexEntry {
+    int64_t epoch = 0;
+    uint64_t offset = 0;
+};
+
+// Sparse timestamp -> byte offset index of a CSV bar file, with the row
+// count. Built by one scan of the file and cached in a sidecar next to it
+// (rebuilt when the data file's size or mtime changes; skipped where the
+// directory is read-only), so range reads can seek instead of parsing
+// from the first line.
+class DataIndex {
+public:
+    // One entry every STRIDE rows
+    static const size_t STRIDE = 1024;
+    
+    static std::string sidecar_path(const std::string& data_path);
+    
+    // Load the sidecar if it matches the data file, else build the index
+    // and try to save it
+    bool open(const std::string& data_path);
+    bool build(const std::string& data_path);
+    bool save(const std::string& index_path, const std::string& data_path) const;
+    bool load(const std::string& index_path, const std::string& data_path);
+    
+    bool is_valid() const { return valid; }
+    // False if any row's timestamp goes backwards or fails to parse (or
+    // there is no index); range reads then scan the whole file
+    bool is_sorted() const { return valid && sorted; }
+    size_t row_count() const { return static_cast<size_t>(rows); }
+    uint64_t data_offset() const { return first_row_offset; }
+    uint64_t file_size() const { return size; }
+    const std::vector<IndexEntry>& entries() const { return samples; }
+    
+    // Offset of a row at or before the first row with timestamp >= epoch
+    uint64_t seek_offset(int64_t epoch) const;
+    // Offset from which every row is after epoch (file size if none)
+    uint64_t end_offset(int64_t epoch) const;
+    
+    // Timestamp in the first field of a CSV row
+    static bool row_epoch(std::string_view line, int64_t& epoch);
+
+private:
+    std::vector<IndexEntry> samples;
+    uint64_t rows = 0;
+    uint64_t first_row_offset = 0;
+    uint64_t size = 0;
+    bool sorted = true;
+    bool valid = false;
+};
+
+} // namespace fluxback
@@ -1,50 +1,91 @@
 #include "data/DataLoader.h"
-#include <sstream>
+#include "data/BarStore.h"
+#include "utils/Timestamp.h"
+#include "concurrency/ThreadPool.h"
 #include <algorithm>
-#include <iostream>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <thread>
 
 namespace fluxback {
 
 DataLoader::DataLoader(const std::string& csv_path)
-    : csv_path(csv_path), current_line(0), total_lines(0), header_read(false) {
+    : csv_path(csv_path), current_line(0), total_lines(0), bad_rows(0), header_read(false),
+      has_range(false), range_from(0), range_to(0), block_pos(0), next_block(0) {
+    if (BarStore::is_bar_store(csv_path)) {
+        store = std::make_unique<BarStore>();
+        if (!store->open(csv_path)) {
+            store.reset();
+            return;
+        }
+        total_lines = store->size();
+        return;
+    }
+    
     file_stream.open(csv_path);
     if (file_stream.is_open()) {
-        // Skip header
-        std::string header;
-        if (std::getline(file_stream, header)) {
-            header_read = true;
-        }
-        count_total_lines();
         reset();
     }
 }
 
+bool DataLoader::open_index() {
+    // Row count and seek points come from the cached sidecar index, built
+    // once something needs them; whole-file reads never do
+    if (!index.is_valid() && !store && file_stream.is_open() && index.open(csv_path)) {
+        total_lines = index.row_count();
+    }
+    return index.is_valid();
+}
+
+size_t DataLoader::get_total_lines() {
+    open_index();
+    return total_lines;
+}
+
 DataLoader::~DataLoader() {
     if (file_stream.is_open()) {
         file_stream.close();
     }
 }
 
-void DataLoader::count_total_lines() {
-    std::ifstream temp_stream(csv_path);
-    if (!temp_stream.is_open()) return;
-    
-    std::string line;
-    total_lines = 0;
-    bool skip_header = true;
-    while (std::getline(temp_stream, line)) {
-        if (skip_header) {
-            skip_header = false;
-            continue;
-        }
-        if (!line.empty() && line.find(',') != std::string::npos) {
-            total_lines++;
-        }
+bool DataLoader::is_valid() const {
+    return file_stream.is_open() || store != nullptr;
+}
+
+void DataLoader::set_range(int64_t from_epoch, int64_t to_epoch) {
+    has_range = true;
+    range_from = from_epoch;
+    range_to = to_epoch;
+    open_index();
+    reset();
+}
+
+int DataLoader::range_position(const std::string& timestamp) const {
+    if (!has_range) return 0;
+    int64_t epoch = 0;
+    if (!parse_timestamp(timestamp, epoch)) return 0; // left for the parser to reject
+    if (epoch < range_from) return -1;
+    return epoch > range_to ? 1 : 0;
+}
+
+std::streamoff DataLoader::range_end_offset() const {
+    if (has_range && index.is_sorted()) {
+        return static_cast<std::streamoff>(index.end_offset(range_to));
     }
-    temp_stream.close();
+    return -1;
 }
 
 void DataLoader::reset() {
+    if (store) {
+        block_bars.clear();
+        block_pos = 0;
+        next_block = 0;
+        current_line = 0;
+        return;
+    }
+    
     if (file_stream.is_open()) {
         file_stream.close();
     }
@@ -54,16 +95,44 @@ void DataLoader::reset() {
         std::getline(file_stream, header); // Skip header
         current_line = 0;
         header_read = true;
+        if (has_range && index.is_sorted()) {
+            file_stream.seekg(static_cast<std::streamoff>(index.seek_offset(range_from)));
+        }
     }
 }
 
 bool DataLoader::has_next() {
+    if (store) {
+        while (block_pos >= block_bars.size()) {
+            if (next_block >= store->blocks().size()) return false;
+            block_bars.clear();
+            block_pos = 0;
+            bool ok = has_range ? store->read_block(next_block++, block_bars, range_from, range_to)
+                                : store->read_block(next_block++, block_bars);
+            if (!ok) return false;
+        }
+        return true;
+    }
+    
     if (!file_stream.is_open()) return false;
     
     // Check if there's a next line
     std::streampos current_pos = file_stream.tellg();
     std::string line;
     bool has_line = static_cast<bool>(std::getline(file_stream, line));
+    
+    // Rows before the range are consumed here; in a sorted file the first
+    // row after it ends the stream
+    while (has_range && has_line && !line.empty()) {
+        int64_t epoch = 0;
+        if (!DataIndex::row_epoch(line, epoch) || (epoch >= range_from && epoch <= range_to)) break;
+        if (epoch > range_to && index.is_sorted()) {
+            file_stream.seekg(current_pos);
+            return false;
+        }
+        current_pos = file_stream.tellg();
+        has_line = static_cast<bool>(std::getline(file_stream, line));
+    }
     file_stream.seekg(current_pos);
     
     return has_line && !line.empty();
@@ -72,6 +141,14 @@ bool DataLoader::has_next() {
 OHLCV DataLoader::next() {
     OHLCV ohlcv;
     
+    if (store) {
+        if (has_next()) {
+            ohlcv = std::move(block_bars[block_pos++]);
+            current_line++;
+        }
+        return ohlcv;
+    }
+    
     if (!file_stream.is_open() || !has_next()) {
         return ohlcv;
     }
@@ -80,53 +157,281 @@ OHLCV DataLoader::next() {
     if (std::getline(file_stream, line)) {
         if (parse_line(line, ohlcv)) {
             current_line++;
+        } else {
+            bad_rows++;
         }
     }
     
     return ohlcv;
 }
 
-std::vector<std::string> DataLoader::split_csv_line(const std::string& line) {
-    std::vector<std::string> tokens;
-    std::stringstream ss(line);
-    std::string token;
+namespace {
+
+// Files below this size are parsed on the calling thread
+const std::streamoff PARALLEL_MIN_BYTES = 8 << 20;
+const size_t READ_BLOCK_BYTES = 4 << 20;
+
+std::string_view trim_field(std::string_view field) {
+    while (!field.empty() && (field.front() == ' ' || field.front() == '\t')) field.remove_prefix(1);
+    while (!field.empty() && (field.back() == ' ' || field.back() == '\t' || field.back() == '\r')) {
+        field.remove_suffix(1);
+    }
+    if (field.size() >= 2 && field.front() == '"' && field.back() == '"') {
+        field = field.substr(1, field.size() - 2);
+    }
+    return field;
+}
+
+bool parse_double(std::string_view field, double& value) {
+    field = trim_field(field);
+    if (!field.empty() && field.front() == '+') field.remove_prefix(1);
+    auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+    return result.ec == std::errc() && result.ptr == field.data() + field.size();
+}
+
+bool parse_volume(std::string_view field, long& value) {
+    field = trim_field(field);
+    auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+    if (result.ec == std::errc() && result.ptr == field.data() + field.size()) return true;
     
-    bool in_quotes = false;
-    std::string current_token;
+    // Fractional volumes ("1500.0") are truncated
+    double d = 0.0;
+    if (!parse_double(field, d)) return false;
+    value = static_cast<long>(d);
+    return true;
+}
+
+// Parse every complete line in [data, data + size) into bars
+void parse_block(const char* data, size_t size, std::vector<OHLCV>& bars, size_t& bad_rows) {
+    const char* end = data + size;
+    const char* line = data;
+    while (line < end) {
+        const char* newline = static_cast<const char*>(std::memchr(line, '\n', static_cast<size_t>(end - line)));
+        const char* line_end = newline != nullptr ? newline : end;
+        std::string_view row(line, static_cast<size_t>(line_end - line));
+        if (!row.empty() && row.back() == '\r') row.remove_suffix(1);
+        if (!row.empty()) {
+            OHLCV ohlcv;
+            if (!DataLoader::parse_line(row, ohlcv)) {
+                bad_rows++;
+            } else if (ohlcv.close > 0.0) {
+                bars.push_back(std::move(ohlcv));
+            }
+        }
+        line = line_end + 1;
+    }
+}
+
+// Parse the whole lines in byte range [begin, end) of a file
+void parse_range(const std::string& path, std::streamoff begin, std::streamoff end,
+                 std::vector<OHLCV>& bars, size_t& bad_rows) {
+    std::ifstream in(path, std::ios::binary);
+    in.seekg(begin);
     
-    for (char c : line) {
-        if (c == '"') {
-            in_quotes = !in_quotes;
-        } else if (c == ',' && !in_quotes) {
-            tokens.push_back(current_token);
-            current_token.clear();
+    std::vector<char> buffer;
+    std::string carry;
+    std::streamoff pos = begin;
+    while (pos < end && in) {
+        size_t want = static_cast<size_t>(std::min<std::streamoff>(READ_BLOCK_BYTES, end - pos));
+        buffer.resize(carry.size() + want);
+        std::copy(carry.begin(), carry.end(), buffer.begin());
+        in.read(buffer.data() + carry.size(), static_cast<std::streamsize>(want));
+        size_t got = static_cast<size_t>(in.gcount());
+        if (got == 0) break;
+        pos += static_cast<std::streamoff>(got);
+        size_t filled = carry.size() + got;
+        
+        // Hold back the partial last line unless this is the end of the range
+        size_t usable = filled;
+        if (pos < end) {
+            while (usable > 0 && buffer[usable - 1] != '\n') usable--;
+        }
+        parse_block(buffer.data(), usable, bars, bad_rows);
+        carry.assign(buffer.data() + usable, filled - usable);
+    }
+    if (!carry.empty()) {
+        parse_block(carry.data(), carry.size(), bars, bad_rows);
+    }
+}
+
+} // namespace
+
+std::vector<OHLCV> DataLoader::load_all(int threads) {
+    if (threads <= 0) {
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    if (file_stream.is_open() && current_line == 0 && threads > 1) {
+        std::error_code ec;
+        std::streamoff end = range_end_offset();
+        if (end < 0) end = static_cast<std::streamoff>(std::filesystem::file_size(csv_path, ec));
+        if (!ec && end - static_cast<std::streamoff>(file_stream.tellg()) >= PARALLEL_MIN_BYTES) {
+            return load_parallel(threads);
+        }
+    }
+    
+    std::vector<OHLCV> bars;
+    if (!has_range) bars.reserve(total_lines);
+    if (store) {
+        if (current_line == 0) {
+            bars = has_range ? store->read_range(range_from, range_to) : store->read_all();
+            bars.erase(std::remove_if(bars.begin(), bars.end(), [](const OHLCV& bar) { return bar.close <= 0.0; }),
+                       bars.end());
+            current_line = store->size();
+            next_block = store->blocks().size();
+            return bars;
+        }
+        while (has_next()) {
+            OHLCV ohlcv = next();
+            if (ohlcv.close > 0.0) bars.push_back(std::move(ohlcv));
+        }
+        return bars;
+    }
+    
+    std::string line;
+    while (file_stream.is_open() && std::getline(file_stream, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        OHLCV ohlcv;
+        if (!parse_line(line, ohlcv)) {
+            bad_rows++;
+            continue;
+        }
+        int position = range_position(ohlcv.timestamp);
+        if (position > 0 && index.is_sorted()) break;
+        if (position == 0 && ohlcv.close > 0.0) {
+            bars.push_back(std::move(ohlcv));
+            current_line++;
+        }
+    }
+    
+    return bars;
+}
+
+std::vector<OHLCV> DataLoader::load_parallel(int threads) {
+    std::streamoff data_start = file_stream.tellg();
+    file_stream.seekg(0, std::ios::end);
+    std::streamoff file_end = file_stream.tellg();
+    if (range_end_offset() >= 0) file_end = std::min(file_end, range_end_offset());
+    
+    // Byte ranges aligned so each one starts right after a newline
+    size_t chunk_count = static_cast<size_t>(threads) * 4;
+    std::streamoff nominal = std::max<std::streamoff>(1, (file_end - data_start) / static_cast<std::streamoff>(chunk_count));
+    std::vector<std::streamoff> bounds = {data_start};
+    {
+        std::ifstream probe(csv_path, std::ios::binary);
+        std::string skipped;
+        for (size_t i = 1; i < chunk_count; ++i) {
+            std::streamoff target = std::max(bounds.back(), data_start + nominal * static_cast<std::streamoff>(i));
+            if (target >= file_end) break;
+            probe.clear();
+            probe.seekg(target);
+            std::getline(probe, skipped);
+            std::streamoff aligned = probe ? static_cast<std::streamoff>(probe.tellg()) : file_end;
+            if (aligned > bounds.back() && aligned < file_end) bounds.push_back(aligned);
+        }
+    }
+    bounds.push_back(file_end);
+    
+    size_t ranges = bounds.size() - 1;
+    std::vector<std::vector<OHLCV>> parts(ranges);
+    std::vector<size_t> part_bad(ranges, 0);
+    ThreadPool::shared().parallel_for(ranges, threads, [&](size_t i) {
+        parse_range(csv_path, bounds[i], bounds[i + 1], parts[i], part_bad[i]);
+    });
+    
+    // Preallocate the output once and move the parts into place in order
+    size_t total = 0;
+    for (size_t i = 0; i < ranges; ++i) {
+        total += parts[i].size();
+        bad_rows += part_bad[i];
+    }
+    std::vector<OHLCV> bars;
+    bars.reserve(total);
+    for (auto& part : parts) {
+        if (has_range) {
+            // Chunks are whole indexed strides; trim rows outside the range
+            for (auto& bar : part) {
+                if (range_position(bar.timestamp) == 0) bars.push_back(std::move(bar));
+            }
         } else {
-            current_token += c;
+            std::move(part.begin(), part.end(), std::back_inserter(bars));
         }
+        std::vector<OHLCV>().swap(part);
+    }
+    
+    current_line += bars.size();
+    file_stream.clear();
+    file_stream.seekg(0, std::ios::end);
+    return bars;
+}
+
+bool DataLoader::read_rows(std::string& text, size_t bytes) {
+    text.clear();
+    if (!can_read_rows() || bytes == 0) return false;
+    
+    text.resize(bytes);
+    file_stream.read(&text[0], static_cast<std::streamsize>(bytes));
+    size_t got = static_cast<size_t>(file_stream.gcount());
+    text.resize(got);
+    if (got < bytes) {
+        // End of file: whatever is left is whole rows
+        return got > 0;
     }
-    tokens.push_back(current_token);
     
-    return tokens;
+    // Hand the partial last row back to the stream
+    size_t last = text.rfind('\n');
+    if (last != std::string::npos) {
+        file_stream.seekg(-static_cast<std::streamoff>(got - last - 1), std::ios::cur);
+        text.resize(last + 1);
+    } else {
+        // A row longer than the block
+        std::string rest;
+        std::getline(file_stream, rest);
+        text += rest;
+    }
+    return true;
+}
+
+void DataLoader::parse_rows(std::string_view text, std::vector<OHLCV>& bars, size_t& bad_rows) {
+    parse_block(text.data(), text.size(), bars, bad_rows);
+}
+
+std::vector<OHLCV> DataLoader::parse_csv_text(const std::string& csv_text, size_t* bad_rows) {
+    std::vector<OHLCV> bars;
+    size_t bad = 0;
+    size_t header_end = csv_text.find('\n');
+    if (header_end != std::string::npos) {
+        parse_block(csv_text.data() + header_end + 1, csv_text.size() - header_end - 1, bars, bad);
+    }
+    if (bad_rows != nullptr) *bad_rows = bad;
+    return bars;
 }
 
-bool DataLoader::parse_line(const std::string& line, OHLCV& ohlcv) {
+bool DataLoader::parse_line(std::string_view line, OHLCV& ohlcv) {
     if (line.empty()) return false;
     
-    auto tokens = split_csv_line(line);
-    if (tokens.size() < 6) return false;
+    // Split the first six comma-separated fields (quotes may wrap a field)
+    std::string_view fields[6];
+    size_t count = 0;
+    size_t start = 0;
+    bool in_quotes = false;
+    for (size_t i = 0; i <= line.size() && count < 6; ++i) {
+        if (i < line.size() && line[i] == '"') {
+            in_quotes = !in_quotes;
+        } else if (i == line.size() || (line[i] == ',' && !in_quotes)) {
+            fields[count++] = line.substr(start, i - start);
+            start = i + 1;
+        }
+    }
+    if (count < 6) return false;
     
-    try {
-        ohlcv.timestamp = tokens[0];
-        ohlcv.open = std::stod(tokens[1]);
-        ohlcv.high = std::stod(tokens[2]);
-        ohlcv.low = std::stod(tokens[3]);
-        ohlcv.close = std::stod(tokens[4]);
-        ohlcv.volume = std::stol(tokens[5]);
-        return true;
-    } catch (const std::exception& e) {
-        std::cerr << "Error parsing line: " << line << " - " << e.what() << std::endl;
+    if (!parse_double(fields[1], ohlcv.open) || !parse_double(fields[2], ohlcv.high) ||
+        !parse_double(fields[3], ohlcv.low) || !parse_double(fields[4], ohlcv.close) ||
+        !parse_volume(fields[5], ohlcv.volume)) {
         return false;
     }
+    ohlcv.timestamp.assign(trim_field(fields[0]));
+    return true;
 }
 
 } // namespace fluxback
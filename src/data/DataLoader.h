@@ -1,7 +1,11 @@
 #pragma once
 
+#include "data/DataIndex.h"
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <fstream>
+#include <memory>
 #include <vector>
 
 namespace fluxback {
@@ -15,6 +19,10 @@ struct OHLCV {
     long volume = 0;
 };
 
+class BarStore;
+
+// Reads bars from a CSV file, or from a compressed bar store (see BarStore)
+// when the file starts with the bar store magic
 class DataLoader {
 public:
     explicit DataLoader(const std::string& csv_path);
@@ -24,21 +32,68 @@ public:
     OHLCV next();
     void reset();
     
-    bool is_valid() const { return file_stream.is_open(); }
+    // Only yield bars with from_epoch <= timestamp <= to_epoch (see
+    // parse_timestamp). With a sorted index this seeks straight to the
+    // range instead of parsing from the first row.
+    void set_range(int64_t from_epoch, int64_t to_epoch);
+    
+    // Read every remaining valid bar (close > 0) into memory. From the start
+    // of a large file this splits it into newline-aligned byte ranges parsed
+    // on `threads` threads (0 = hardware concurrency); row order is kept.
+    std::vector<OHLCV> load_all(int threads = 0);
+    
+    // Parse CSV text already held in memory (header line included)
+    static std::vector<OHLCV> parse_csv_text(const std::string& csv_text, size_t* bad_rows = nullptr);
+    
+    // Parse a single CSV row without throwing; false for headers and
+    // malformed rows
+    static bool parse_line(std::string_view line, OHLCV& ohlcv);
+    
+    // Raw text of the next whole rows (about `bytes` of them) for parsing
+    // on another thread with parse_rows(); false at the end of the file.
+    // Only for CSV input without a date range (see can_read_rows()).
+    bool read_rows(std::string& text, size_t bytes);
+    bool can_read_rows() const { return !store && !has_range && file_stream.is_open(); }
+    
+    // Append the valid bars (close > 0) in CSV rows without a header
+    static void parse_rows(std::string_view text, std::vector<OHLCV>& bars, size_t& bad_rows);
+    
+    bool is_valid() const;
     size_t get_current_line() const { return current_line; }
-    size_t get_total_lines() const { return total_lines; }
+    // Rows in the whole file, from the sidecar index (or the store header);
+    // for CSV input the first call loads or builds the index
+    size_t get_total_lines();
+    
+    // Malformed rows skipped so far (reported instead of logged per row)
+    size_t get_bad_rows() const { return bad_rows; }
 
 private:
     std::string csv_path;
     std::ifstream file_stream;
     size_t current_line;
     size_t total_lines;
+    size_t bad_rows;
     bool header_read;
     
-    void count_total_lines();
-    bool parse_line(const std::string& line, OHLCV& ohlcv);
-    std::vector<std::string> split_csv_line(const std::string& line);
+    // Sidecar row index of a CSV file and the requested date range
+    DataIndex index;
+    bool has_range;
+    int64_t range_from;
+    int64_t range_to;
+    
+    // Binary bar store input, decoded one block at a time
+    std::unique_ptr<BarStore> store;
+    std::vector<OHLCV> block_bars;
+    size_t block_pos;
+    size_t next_block;
+    
+    // Load or build the sidecar index on first use; false without one
+    bool open_index();
+    
+    // -1 before the range, 0 inside it (or no range), 1 after it
+    int range_position(const std::string& timestamp) const;
+    std::streamoff range_end_offset() const;
+    std::vector<OHLCV> load_parallel(int threads);
 };
 
 } // namespace fluxback
-
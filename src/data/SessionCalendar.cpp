@@ -0,0 +1,118 @@
+#include "data/SessionCalendar.h"
+#include "utils/Timestamp.h"
+#include <algorithm>
+
+namespace fluxback {
+
+namespace {
+
+// Session hours (exchange time) and trading days per year
+struct MarketPreset {
+    const char* name;
+    int open_minute;
+    int close_minute;
+    double days_per_year;
+};
+
+const MarketPreset MARKETS[] = {
+    {"us_equity", 9 * 60 + 30, 16 * 60, 252.0},
+    {"nse", 9 * 60 + 15, 15 * 60 + 30, 250.0},
+    {"lse", 8 * 60, 16 * 60 + 30, 252.0},
+    {"forex", 0, 24 * 60, 260.0},
+    {"crypto", 0, 24 * 60, 365.0},
+};
+
+bool read_clock(const std::string& text, int& minutes) {
+    size_t colon = text.find(':');
+    if (colon == std::string::npos || colon == 0 || colon + 3 != text.size()) return false;
+    int hours = 0;
+    for (size_t i = 0; i < colon; ++i) {
+        if (text[i] < '0' || text[i] > '9') return false;
+        hours = hours * 10 + (text[i] - '0');
+    }
+    if (text[colon + 1] < '0' || text[colon + 1] > '5' || text[colon + 2] < '0' || text[colon + 2] > '9') return false;
+    minutes = hours * 60 + (text[colon + 1] - '0') * 10 + (text[colon + 2] - '0');
+    return minutes <= 24 * 60;
+}
+
+int64_t day_of_epoch(int64_t epoch) {
+    return epoch >= 0 ? epoch / 86400 : (epoch - 86399) / 86400;
+}
+
+} // namespace
+
+SessionCalendar::SessionCalendar(const StrategyConfig::CalendarConfig& config, int bar_minutes)
+    : days_year(config.days_per_year > 0.0 ? config.days_per_year : 252.0),
+      bar_seconds(std::max(bar_minutes, 1) * 60) {
+    int session_minutes = config.close_minute - config.open_minute;
+    bars_day = session_minutes > 0 ? static_cast<double>(session_minutes) / std::max(bar_minutes, 1) : 1.0;
+    reset();
+}
+
+void SessionCalendar::reset() {
+    last_date.clear();
+    last_day = -1;
+    sessions = 0;
+}
+
+bool SessionCalendar::apply_market(const std::string& name, StrategyConfig::CalendarConfig& config) {
+    for (const MarketPreset& market : MARKETS) {
+        if (name != market.name) continue;
+        config.market = name;
+        config.open_minute = market.open_minute;
+        config.close_minute = market.close_minute;
+        config.days_per_year = market.days_per_year;
+        return true;
+    }
+    return false;
+}
+
+bool SessionCalendar::parse_session(const std::string& text, StrategyConfig::CalendarConfig& config) {
+    size_t dash = text.find('-');
+    if (dash == std::string::npos) return false;
+    int open = 0;
+    int close = 0;
+    if (!read_clock(text.substr(0, dash), open) || !read_clock(text.substr(dash + 1), close) || close <= open) {
+        return false;
+    }
+    config.open_minute = open;
+    config.close_minute = close;
+    return true;
+}
+
+bool SessionCalendar::advance(const std::string& timestamp) {
+    if (timestamp.compare(0, 10, last_date) == 0) return false;
+    
+    // First bar of a new date prefix: parse it once
+    int64_t epoch = 0;
+    if (!parse_timestamp(timestamp, epoch)) return false;
+    last_date.assign(timestamp, 0, 10);
+    int64_t day = day_of_epoch(epoch);
+    if (day <= last_day) return false;
+    last_day = day;
+    ++sessions;
+    return true;
+}
+
+void SessionCalendar::index(const std::vector<OHLCV>& bars) {
+    reset();
+    day_of.assign(bars.size(), 0);
+    flags.assign(bars.size(), 0);
+    for (size_t i = 0; i < bars.size(); ++i) {
+        if (advance(bars[i].timestamp)) {
+            flags[i] = SESSION_START;
+    
+            // Trading broke off if more than one bar period passed since the
+            // previous session's last bar
+            int64_t previous = 0;
+            int64_t current = 0;
+            if (i > 0 && parse_timestamp(bars[i - 1].timestamp, previous) &&
+                parse_timestamp(bars[i].timestamp, current) && current - previous > bar_seconds) {
+                flags[i] |= GAP;
+            }
+        }
+        day_of[i] = sessions > 0 ? static_cast<uint32_t>(sessions - 1) : 0;
+    }
+}
+
+} // namespace fluxback
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "data/DataLoader.h"
+#include "utils/ConfigParser.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fluxback {
+
+// Trading sessions of a market and the day structure of a bar series.
+// Bars are assigned to sessions by their calendar date, so feeding bars
+// in order costs a date-prefix compare per bar; whole series can be
+// indexed once into per-bar trading-day and session-boundary tables.
+class SessionCalendar {
+public:
+    // `bar_minutes` is the bar period (strategy.timeframe; 0 = 1 minute)
+    explicit SessionCalendar(const StrategyConfig::CalendarConfig& config, int bar_minutes = 1);
+    
+    // Replace the session hours and year length of `config` with a named
+    // preset (see the table in SessionCalendar.cpp); false if there is none
+    static bool apply_market(const std::string& name, StrategyConfig::CalendarConfig& config);
+    
+    // Session hours as "HH:MM-HH:MM"
+    static bool parse_session(const std::string& text, StrategyConfig::CalendarConfig& config);
+    
+    double days_per_year() const { return days_year; }
+    double bars_per_day() const { return bars_day; }
+    
+    // Next bar's timestamp, in order; true when it opens a new session
+    bool advance(const std::string& timestamp);
+    
+    // Sessions seen by advance, and the span they cover in years (0
+    // before the first bar)
+    size_t trading_days() const { return sessions; }
+    double years() const { return sessions / days_year; }
+    
+    // Back to before the first bar
+    void reset();
+    
+    // Per-bar tables for a whole series (restarts advance): trading day
+    // ordinal from 0, whether the bar opens a session, and whether a
+    // session opens after a break in trading (overnight, weekend or
+    // holiday gap)
+    void index(const std::vector<OHLCV>& bars);
+    uint32_t trading_day(size_t bar) const { return day_of[bar]; }
+    bool session_start(size_t bar) const { return (flags[bar] & SESSION_START) != 0; }
+    bool overnight_gap(size_t bar) const { return (flags[bar] & GAP) != 0; }
+
+private:
+    enum : uint8_t { SESSION_START = 1, GAP = 2 };
+    
+    double days_year;
+    double bars_day;
+    int bar_seconds;
+    std::string last_date; // date prefix of the last timestamp seen by advance
+    int64_t last_day;      // days since epoch, for plain epoch timestamps
+    size_t sessions;
+    std::vector<uint32_t> day_of;
+    std::vector<uint8_t> flags;
+};
+
+} // namespace fluxback
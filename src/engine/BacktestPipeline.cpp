@@ -0,0 +1,117 @@
+#include "engine/BacktestPipeline.h"
+#include <chrono>
+#include <thread>
+
+namespace fluxback {
+
+namespace {
+
+const size_t BATCHES = 8;
+const size_t BATCH_BYTES = 1 << 20;
+const size_t BATCH_BARS = 16384;
+
+template <typename T>
+void push_wait(SpscRing<T>& ring, const T& value) {
+    while (!ring.try_push(value)) {
+        std::this_thread::yield();
+    }
+}
+
+// Spin briefly, then back off so an idle stage doesn't hold a core
+template <typename T>
+T pop_wait(SpscRing<T>& ring) {
+    T value;
+    for (unsigned spins = 0; !ring.try_pop(value); ++spins) {
+        if (spins < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+    return value;
+}
+
+} // namespace
+
+BacktestPipeline::BacktestPipeline(BacktestRunner& runner)
+    : runner(runner), pool(BATCHES), parse_bad_rows(0), free_batches(BATCHES), read_batches(BATCHES + 1),
+      parsed(BATCHES + 1), labelled(BATCHES + 1) {
+}
+
+void BacktestPipeline::run(DataLoader& loader) {
+    parse_bad_rows = 0;
+    for (auto& batch : pool) {
+        free_batches.try_push(&batch);
+    }
+    
+    std::thread reader(&BacktestPipeline::read_stage, this, std::ref(loader));
+    std::thread parser(&BacktestPipeline::parse_stage, this);
+    std::thread labeller(&BacktestPipeline::regime_stage, this);
+    
+    while (Batch* batch = pop_wait(labelled)) {
+        for (size_t i = 0; i < batch->bars.size(); ++i) {
+            runner.on_bar(batch->bars[i], static_cast<Regime>(batch->regimes[i]));
+        }
+        parse_bad_rows += batch->bad_rows;
+        push_wait(free_batches, batch);
+    }
+    
+    reader.join();
+    parser.join();
+    labeller.join();
+    
+    // Leave the pool empty for the next run
+    Batch* batch = nullptr;
+    while (free_batches.try_pop(batch)) {}
+}
+
+void BacktestPipeline::read_stage(DataLoader& loader) {
+    const bool raw = loader.can_read_rows();
+    while (true) {
+        Batch* batch = pop_wait(free_batches);
+        batch->bars.clear();
+        batch->bad_rows = 0;
+        bool more;
+        if (raw) {
+            more = loader.read_rows(batch->text, BATCH_BYTES);
+        } else {
+            batch->text.clear();
+            while (batch->bars.size() < BATCH_BARS && loader.has_next()) {
+                batch->bars.push_back(loader.next());
+            }
+            more = !batch->bars.empty();
+        }
+        if (!more) {
+            push_wait(read_batches, static_cast<Batch*>(nullptr));
+            return;
+        }
+        push_wait(read_batches, batch);
+    }
+}
+
+void BacktestPipeline::parse_stage() {
+    while (Batch* batch = pop_wait(read_batches)) {
+        if (!batch->text.empty()) {
+            DataLoader::parse_rows(batch->text, batch->bars, batch->bad_rows);
+            batch->text.clear();
+        }
+        push_wait(parsed, batch);
+    }
+    push_wait(parsed, static_cast<Batch*>(nullptr));
+}
+
+void BacktestPipeline::regime_stage() {
+    // Fed exactly the bars the runner accepts, in order
+    RegimeDetector detector = runner.make_regime_detector();
+    while (Batch* batch = pop_wait(parsed)) {
+        batch->regimes.resize(batch->bars.size());
+        for (size_t i = 0; i < batch->bars.size(); ++i) {
+            const OHLCV& bar = batch->bars[i];
+            batch->regimes[i] = bar.close > 0.0 ? static_cast<uint8_t>(detector.update_and_get(bar)) : 0;
+        }
+        push_wait(labelled, batch);
+    }
+    push_wait(labelled, static_cast<Batch*>(nullptr));
+}
+
+} // namespace fluxback
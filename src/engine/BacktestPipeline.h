@@ -0,0 +1,58 @@
+#pragma once
+
+#include "engine/BacktestRunner.h"
+#include "concurrency/SpscRing.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fluxback {
+
+// Runs one backtest as a pipeline of stages on their own threads, joined
+// by bounded single-producer/single-consumer rings:
+//
+//   read rows -> parse bars -> label regimes -> strategy/execution/analytics
+//
+// The last stage is the runner on the calling thread. Bars travel in
+// batches drawn from a fixed pool, so reading can only run a few batches
+// ahead of the strategy. Every stage sees the bars in file order, so
+// results are identical to feeding the runner one bar at a time.
+class BacktestPipeline {
+public:
+    explicit BacktestPipeline(BacktestRunner& runner);
+    
+    BacktestPipeline(const BacktestPipeline&) = delete;
+    BacktestPipeline& operator=(const BacktestPipeline&) = delete;
+    
+    // Feed every remaining bar of `loader` through the runner. Input the
+    // loader can't hand over as raw rows (bar stores, date ranges) is read
+    // and parsed in the first stage.
+    void run(DataLoader& loader);
+    
+    // Malformed rows skipped by the parse stage (on top of the loader's own)
+    size_t bad_rows() const { return parse_bad_rows; }
+
+private:
+    struct Batch {
+        std::string text;             // raw rows, empty once parsed
+        std::vector<OHLCV> bars;
+        std::vector<uint8_t> regimes; // one Regime per bar
+        size_t bad_rows = 0;
+    };
+    
+    BacktestRunner& runner;
+    std::vector<Batch> pool;
+    size_t parse_bad_rows;
+    
+    // A null batch ends the stream
+    SpscRing<Batch*> free_batches; // runner -> reader
+    SpscRing<Batch*> read_batches; // reader -> parser
+    SpscRing<Batch*> parsed;       // parser -> regimes
+    SpscRing<Batch*> labelled;     // regimes -> runner
+    
+    void read_stage(DataLoader& loader);
+    void parse_stage();
+    void regime_stage();
+};
+
+} // namespace fluxback
@@ -0,0 +1,196 @@
+#include "engine/BacktestRunner.h"
+#include "regime/RegimeModel.h"
+#include "utils/Timestamp.h"
+#include <cstdlib>
+
+namespace fluxback {
+
+BacktestRunner::BacktestRunner(const StrategyConfig& cfg, double initial_cash,
+                               std::pmr::memory_resource* resource)
+    : config(cfg), initial_cash(initial_cash), indicators(resource),
+      calendar(cfg.calendar, parse_timeframe_minutes(cfg.timeframe)), strategy(cfg), executor(cfg, resource),
+      regime_detector(20, resource, regime_backend(cfg), cfg.regime.fitted.get()), analytics(resource),
+      own_risk(cfg.risk, initial_cash), risk(&own_risk), risk_symbol(own_risk.add_symbol()),
+      risk_enabled(cfg.risk.enabled()), carry_costs(cfg.costs.overnight()), cache(nullptr), tick_count(0),
+      journal(nullptr), journal_regime(-1) {
+    if (config.trend_timeframe_minutes > 0) {
+        timeframes.add_timeframe(config.trend_timeframe_minutes);
+    }
+    analytics.set_lot_method(config.lots);
+    indicators.set_annualization(calendar.bars_per_day(), calendar.days_per_year());
+    if (config.vwap.enabled()) {
+        indicators.track_session(config.vwap.bucket_pct);
+    }
+    reset();
+}
+
+void BacktestRunner::attach_cache(const IndicatorCache* c) {
+    cache = c;
+    reset();
+}
+
+void BacktestRunner::attach_risk(RiskManager* shared, size_t symbol) {
+    risk = shared != nullptr ? shared : &own_risk;
+    risk_symbol = shared != nullptr ? symbol : 0;
+    risk_enabled = shared != nullptr || config.risk.enabled();
+}
+
+void BacktestRunner::reset() {
+    indicators.attach_cache(cache);
+    if (cache == nullptr) {
+        // Track strategy windows from the first bar so results match the cache
+        indicators.register_sma(config.fast_sma);
+        indicators.register_sma(config.slow_sma);
+    }
+    timeframes.reset();
+    calendar.reset();
+    if (config.trend_timeframe_minutes > 0) {
+        size_t slot = timeframes.add_timeframe(config.trend_timeframe_minutes);
+        timeframes.indicators(slot).register_sma(config.trend_sma);
+    }
+    strategy.reset();
+    executor.reset(initial_cash);
+    regime_detector.reset();
+    analytics.reset(initial_cash);
+    own_risk.reset(initial_cash); // a shared manager is reset by its owner
+    tick_count = 0;
+    journal_regime = -1;
+}
+
+RegimeDetector BacktestRunner::make_regime_detector() const {
+    return RegimeDetector(20, std::pmr::get_default_resource(), regime_backend(config), config.regime.fitted.get());
+}
+
+bool BacktestRunner::advance(const OHLCV& tick, const Regime* labelled) {
+    if (tick.close <= 0.0) return false; // Skip invalid ticks
+    
+    size_t index = tick_count;
+    tick_count++;
+    if (calendar.advance(tick.timestamp)) {
+        analytics.set_years(calendar.years());
+        indicators.start_session();
+    }
+    
+    // Overnight borrow / financing on the position carried into this bar
+    if (carry_costs) {
+        CarryCosts carry = executor.accrue_carry(tick);
+        double charged = carry.borrow + carry.financing;
+        if (charged > 0.0) {
+            analytics.record_carry(carry);
+            if (risk_enabled) risk->charge(charged);
+        }
+    }
+    
+    // Update indicators
+    indicators.add_price(tick.close, tick.volume);
+    
+    // Higher-timeframe bars are built from the same stream, no second pass
+    if (!timeframes.empty()) {
+        timeframes.on_bar(tick);
+    }
+    
+    // Update regime detector
+    Regime current_regime = labelled != nullptr ? *labelled
+        : (cache != nullptr && cache->has_regimes()) ? cache->regime(index)
+        : regime_detector.update_and_get(tick);
+    if (journal != nullptr && static_cast<int>(current_regime) != journal_regime) {
+        JournalEvent event = journal_event(JournalEvent::REGIME, tick);
+        event.side = static_cast<uint8_t>(current_regime);
+        journal->record(event);
+        journal_regime = static_cast<int>(current_regime);
+    }
+    
+    if (risk_enabled) {
+        risk->mark(risk_symbol, tick.close);
+        
+        // Kill switch: flatten, then every later entry is rejected
+        if (risk->halted() && !strategy.is_flat()) {
+            int position = strategy.get_position();
+            strategy.set_position(0);
+            Order exit_order(position > 0 ? Order::SELL : Order::BUY, std::abs(position), tick.close);
+            execute(exit_order, tick, current_regime, indicators.get_realized_vol(20));
+        }
+    }
+    
+    // Skip trading in volatile regime if configured
+    if (config.exclude_volatile_regime && current_regime == Regime::VOLATILE) {
+        return true;
+    }
+    
+    // Get strategy signals; the strategy only enters from flat
+    bool was_flat = strategy.is_flat();
+    const std::vector<Order>& orders = strategy.on_tick(tick, indicators, timeframes.empty() ? nullptr : &timeframes);
+    
+    // Execute orders
+    for (Order order : orders) {
+        double realized_vol = indicators.get_realized_vol(20);
+        
+        // Size entries against the risk limits; exits always go through
+        if (risk_enabled && was_flat) {
+            int side = order.type == Order::BUY ? 1 : -1;
+            int approved = risk->size_entry(risk_symbol, side, order.size, tick.close, realized_vol);
+            if (approved != order.size) {
+                risk->record_adjustment(order.size, approved);
+                strategy.set_position(side * approved);
+                if (approved == 0) continue;
+                order.size = approved;
+            }
+        }
+        execute(order, tick, current_regime, realized_vol);
+    }
+    
+    return true;
+}
+
+void BacktestRunner::execute(const Order& order, const OHLCV& tick, Regime regime, double realized_vol) {
+    if (journal != nullptr) {
+        JournalEvent event = journal_event(JournalEvent::ORDER, tick);
+        event.side = order.type == Order::BUY ? 0 : 1;
+        event.quantity = order.size;
+        event.price = order.price;
+        journal->record(event);
+    }
+    
+    double benchmark = config.vwap.benchmark ? indicators.get_session().vwap() : 0.0;
+    Fill fill = executor.execute(order, tick, realized_vol, benchmark);
+    if (risk_enabled) {
+        int quantity = order.type == Order::BUY ? fill.filled_size : -fill.filled_size;
+        risk->on_fill(risk_symbol, quantity, fill.fill_price, fill.commission + fill.fees);
+    }
+    
+    // Record fill in analytics
+    double position_value = executor.get_position().size * tick.close;
+    const Fill& recorded = analytics.record_fill(fill, regime, executor.get_cash(), position_value);
+    
+    if (on_fill) {
+        on_fill(recorded, regime);
+    }
+    
+    if (journal != nullptr) {
+        JournalEvent event = journal_event(JournalEvent::FILL, tick);
+        event.side = order.type == Order::BUY ? 0 : 1;
+        event.quantity = fill.filled_size;
+        event.price = fill.fill_price;
+        event.amount = fill.commission + fill.fees;
+        event.detail = fill.slippage;
+        journal->record(event);
+        
+        Position position = executor.get_position();
+        event = journal_event(JournalEvent::POSITION, tick);
+        event.quantity = position.size;
+        event.price = position.avg_price;
+        event.amount = executor.get_cash();
+        event.detail = position.realized_pnl;
+        journal->record(event);
+    }
+}
+
+JournalEvent BacktestRunner::journal_event(uint8_t type, const OHLCV& tick) const {
+    JournalEvent event;
+    event.type = type;
+    event.bar = tick_count - 1;
+    parse_timestamp(tick.timestamp, event.time);
+    return event;
+}
+
+} // namespace fluxback
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "data/DataLoader.h"
+#include "data/SessionCalendar.h"
+#include "indicators/IndicatorEngine.h"
+#include "indicators/IndicatorCache.h"
+#include "indicators/MultiTimeframe.h"
+#include "strategy/StrategyEngine.h"
+#include "execution/ExecutionSimulator.h"
+#include "analytics/Analytics.h"
+#include "regime/RegimeDetector.h"
+#include "risk/RiskManager.h"
+#include "journal/RunJournal.h"
+#include "utils/ConfigParser.h"
+#include <functional>
+
+namespace fluxback {
+
+// One backtest: the indicators -> regime -> strategy -> execution ->
+// analytics chain, advanced one bar at a time.
+class BacktestRunner {
+public:
+    // Per-run state (indicator windows, regime history, fills, trades) is
+    // allocated from `resource`; sweeps pass a per-worker RunArena
+    explicit BacktestRunner(const StrategyConfig& cfg, double initial_cash = 100000.0,
+                            std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    
+    // Read indicators and regimes from a shared precomputed cache.
+    // Bars must then be fed in the same order the cache was built from.
+    void attach_cache(const IndicatorCache* cache);
+    
+    // Check entries against a RiskManager shared with other runners (one
+    // per symbol of a portfolio, advanced on one thread) instead of this
+    // runner's own; nullptr goes back to the own one. Runners whose config
+    // sets no risk limits skip the checks unless a shared manager is attached.
+    void attach_risk(RiskManager* shared, size_t symbol);
+    
+    // Record orders, fills, position and regime changes to a journal
+    // (nullptr stops); the journal must outlive the run
+    void attach_journal(JournalWriter* journal) { this->journal = journal; }
+    
+    // Process one bar; returns false if the bar was skipped as invalid
+    bool on_bar(const OHLCV& bar) { return advance(bar, nullptr); }
+    
+    // Same, with the bar's regime labelled elsewhere by a RegimeDetector
+    // built by make_regime_detector() and fed the same valid bars
+    bool on_bar(const OHLCV& bar, Regime regime) { return advance(bar, &regime); }
+    RegimeDetector make_regime_detector() const;
+    
+    // Called for every fill as soon as it is executed (live mode, journals)
+    using FillCallback = std::function<void(const Fill& fill, Regime regime)>;
+    void set_fill_callback(FillCallback callback) { on_fill = std::move(callback); }
+    
+    size_t get_tick_count() const { return tick_count; }
+    const Analytics& get_analytics() const { return analytics; }
+    const SessionCalendar& get_calendar() const { return calendar; }
+    const IndicatorEngine& get_indicators() const { return indicators; }
+    const ExecutionSimulator& get_executor() const { return executor; }
+    const RiskManager& get_risk() const { return *risk; }
+    BacktestSummary summary() const { return analytics.summary(); }
+    
+    // Reset all per-run state (the attached cache is kept)
+    void reset();
+
+private:
+    StrategyConfig config;
+    double initial_cash;
+    IndicatorEngine indicators;
+    MultiTimeframe timeframes;
+    SessionCalendar calendar;
+    StrategyEngine strategy;
+    ExecutionSimulator executor;
+    RegimeDetector regime_detector;
+    Analytics analytics;
+    RiskManager own_risk;
+    RiskManager* risk;
+    size_t risk_symbol;
+    bool risk_enabled;
+    bool carry_costs;
+    const IndicatorCache* cache;
+    size_t tick_count;
+    FillCallback on_fill;
+    JournalWriter* journal;
+    int journal_regime; // last regime journaled, -1 before the first
+    
+    bool advance(const OHLCV& tick, const Regime* labelled);
+    void execute(const Order& order, const OHLCV& tick, Regime regime, double realized_vol);
+    JournalEvent journal_event(uint8_t type, const OHLCV& tick) const;
+};
+
+} // namespace fluxback
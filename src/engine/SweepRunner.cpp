@@ -0,0 +1,240 @@
+#include "engine/SweepRunner.h"
+#include "engine/WideKernel.h"
+#include "utils/NumaTopology.h"
+#include "concurrency/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+namespace fluxback {
+
+SweepRunner::SweepRunner(const std::vector<OHLCV>& bars, const IndicatorCache* cache)
+    : bars(bars), cache(cache) {
+}
+
+SweepResult SweepRunner::run_one(size_t index, const StrategyConfig& config, RunArena& arena) const {
+    SweepResult result;
+    {
+        BacktestRunner runner(config, 100000.0, &arena);
+        if (cache != nullptr) {
+            runner.attach_cache(cache);
+        }
+        for (const auto& bar : bars) {
+            runner.on_bar(bar);
+        }
+        result = SweepResult{config, runner.summary()};
+        if (on_result) {
+            on_result(index, result, runner.get_analytics());
+        }
+    }
+    // The runner is gone, so its state can be dropped in one step
+    arena.reset();
+    return result;
+}
+
+std::vector<SweepResult> SweepRunner::run(const std::vector<StrategyConfig>& grid, int parallel) {
+    if (wide && cache != nullptr &&
+        std::all_of(grid.begin(), grid.end(),
+                    [this](const StrategyConfig& c) { return WideKernel::supports(c, *cache); })) {
+        return run_wide(grid, parallel);
+    }
+    if (tiled) {
+        return run_tiled(grid, parallel);
+    }
+    
+    std::vector<SweepResult> results(grid.size());
+    std::atomic<size_t> next_index{0};
+    int thread_count = std::max(1, std::min(parallel, static_cast<int>(grid.size())));
+    std::vector<ArenaStats> worker_stats(static_cast<size_t>(thread_count));
+    
+    auto worker = [&](int slot) {
+        RunArena arena;
+        size_t i;
+        while ((i = next_index.fetch_add(1)) < grid.size()) {
+            results[i] = run_one(i, grid[i], arena);
+        }
+        worker_stats[static_cast<size_t>(slot)] = arena.stats();
+    };
+    
+    ThreadPool::shared().run_workers(thread_count, worker);
+    
+    stats = ArenaStats();
+    for (const auto& worker_stat : worker_stats) {
+        stats += worker_stat;
+    }
+    return results;
+}
+
+std::vector<SweepResult> SweepRunner::run_wide(const std::vector<StrategyConfig>& grid, int parallel) {
+    std::vector<SweepResult> results(grid.size());
+    WideKernel kernel(bars, *cache);
+    
+    // Enough batches that every thread gets one, unless that would leave
+    // too few lanes per batch to pay for the lockstep pass
+    size_t threads = static_cast<size_t>(std::max(1, parallel));
+    size_t lanes = std::min(WideKernel::MAX_LANES,
+                            std::max(WIDE_MIN_LANES, (grid.size() + threads - 1) / threads));
+    size_t batches = (grid.size() + lanes - 1) / lanes;
+    std::atomic<size_t> next_batch{0};
+    int thread_count = std::max(1, std::min(parallel, static_cast<int>(batches)));
+    std::vector<ArenaStats> worker_stats(static_cast<size_t>(thread_count));
+    
+    auto worker = [&](int slot) {
+        RunArena arena;
+        size_t batch;
+        while ((batch = next_batch.fetch_add(1)) < batches) {
+            size_t begin = batch * lanes;
+            size_t count = std::min(lanes, grid.size() - begin);
+            {
+                // emplace, not fill-construct: copies would drop the arena
+                std::vector<Analytics> analytics;
+                analytics.reserve(count);
+                for (size_t l = 0; l < count; ++l) {
+                    analytics.emplace_back(&arena);
+                }
+                kernel.run(&grid[begin], count, analytics.data());
+                for (size_t l = 0; l < count; ++l) {
+                    results[begin + l] = SweepResult{grid[begin + l], analytics[l].summary()};
+                    if (on_result) {
+                        on_result(begin + l, results[begin + l], analytics[l]);
+                    }
+                }
+            }
+            arena.reset(count);
+        }
+        worker_stats[static_cast<size_t>(slot)] = arena.stats();
+    };
+    
+    ThreadPool::shared().run_workers(thread_count, worker);
+    
+    stats = ArenaStats();
+    for (const auto& worker_stat : worker_stats) {
+        stats += worker_stat;
+    }
+    return results;
+}
+
+std::vector<SweepResult> SweepRunner::run_tiled(const std::vector<StrategyConfig>& grid, int parallel) {
+    std::vector<SweepResult> results(grid.size());
+    size_t batches = (grid.size() + TILE_RUNS - 1) / TILE_RUNS;
+    size_t tile_bars = std::max<size_t>(1, tile_bytes / bytes_per_bar(bars, cache));
+    std::atomic<size_t> next_batch{0};
+    int thread_count = std::max(1, std::min(parallel, static_cast<int>(batches)));
+    std::vector<ArenaStats> worker_stats(static_cast<size_t>(thread_count));
+    
+    // The first worker on each node copies the bars there (first touch
+    // places the pages on that node); single-node hosts share `bars`
+    NumaTopology topology = NumaTopology::detect();
+    std::vector<std::vector<OHLCV>> replicas(topology.node_count());
+    std::vector<std::once_flag> replicated(topology.node_count());
+    
+    auto worker = [&](int slot) {
+        size_t node = topology.node_for(slot, thread_count);
+        const std::vector<OHLCV>* local = &bars;
+        std::vector<int> affinity;
+        bool bound = topology.node_count() > 1 && topology.bind_current_thread(node, affinity);
+        if (bound) {
+            std::call_once(replicated[node], [&]() { replicas[node] = bars; });
+            local = &replicas[node];
+        }
+    
+        RunArena arena;
+        size_t batch;
+        while ((batch = next_batch.fetch_add(1)) < batches) {
+            size_t begin = batch * TILE_RUNS;
+            size_t count = std::min(TILE_RUNS, grid.size() - begin);
+            {
+                std::vector<std::unique_ptr<BacktestRunner>> runners;
+                for (size_t r = 0; r < count; ++r) {
+                    runners.push_back(std::make_unique<BacktestRunner>(grid[begin + r], 100000.0, &arena));
+                    if (cache != nullptr) {
+                        runners.back()->attach_cache(cache);
+                    }
+                }
+    
+                // Every runner finishes a tile while it is still in cache
+                for (size_t tile = 0; tile < local->size(); tile += tile_bars) {
+                    size_t tile_end = std::min(local->size(), tile + tile_bars);
+                    for (auto& runner : runners) {
+                        for (size_t b = tile; b < tile_end; ++b) {
+                            runner->on_bar((*local)[b]);
+                        }
+                    }
+                }
+    
+                for (size_t r = 0; r < count; ++r) {
+                    results[begin + r] = SweepResult{grid[begin + r], runners[r]->summary()};
+                    if (on_result) {
+                        on_result(begin + r, results[begin + r], runners[r]->get_analytics());
+                    }
+                }
+            }
+            arena.reset(count);
+        }
+        worker_stats[static_cast<size_t>(slot)] = arena.stats();
+    
+        // Pool threads (and the caller, which runs slot 0) outlive the
+        // sweep; give them back exactly the CPUs they had
+        if (bound) NumaTopology::restore_current_thread(affinity);
+    };
+    
+    ThreadPool::shared().run_workers(thread_count, worker);
+    
+    stats = ArenaStats();
+    for (const auto& worker_stat : worker_stats) {
+        stats += worker_stat;
+    }
+    return results;
+}
+
+size_t SweepRunner::bytes_per_bar(const std::vector<OHLCV>& bars, const IndicatorCache* cache) {
+    size_t bytes = sizeof(OHLCV);
+    
+    // Average over the bars, as timestamp lengths can vary within a file
+    const size_t inline_capacity = std::string().capacity();
+    size_t heap_bytes = 0;
+    for (const auto& bar : bars) {
+        if (bar.timestamp.capacity() > inline_capacity) {
+            heap_bytes += bar.timestamp.capacity() + 1;
+        }
+    }
+    if (!bars.empty()) {
+        bytes += heap_bytes / bars.size();
+    }
+    if (cache != nullptr) {
+        bytes += cache->bytes_per_bar();
+    }
+    return bytes;
+}
+
+std::string SweepRunner::label(const StrategyConfig& config) {
+    char buffer[256];
+    std::snprintf(buffer, sizeof(buffer),
+                  "fast=%d,slow=%d,stop_loss_pct=%.4g,take_profit_pct=%.4g,base_ticks=%d",
+                  config.fast_sma, config.slow_sma, config.stop_loss_pct,
+                  config.take_profit_pct, config.slippage.base_ticks);
+    return buffer;
+}
+
+std::vector<StrategyConfig> SweepRunner::exit_grid(const StrategyConfig& base) {
+    const double multipliers[] = {0.5, 1.0, 1.5, 2.0};
+    const int base_ticks[] = {0, 1, 2};
+    
+    std::vector<StrategyConfig> grid;
+    for (double sl : multipliers) {
+        for (double tp : multipliers) {
+            for (int ticks : base_ticks) {
+                StrategyConfig cfg = base;
+                cfg.stop_loss_pct = base.stop_loss_pct * sl;
+                cfg.take_profit_pct = base.take_profit_pct * tp;
+                cfg.slippage.base_ticks = ticks;
+                grid.push_back(cfg);
+            }
+        }
+    }
+    return grid;
+}
+
+} // namespace fluxback
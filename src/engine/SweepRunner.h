@@ -0,0 +1,80 @@
+#pragma once
+
+#include "engine/BacktestRunner.h"
+#include "indicators/IndicatorCache.h"
+#include "utils/RunArena.h"
+#include <functional>
+#include <vector>
+
+namespace fluxback {
+
+struct SweepResult {
+    StrategyConfig config;
+    BacktestSummary summary;
+};
+
+// Runs many strategy configurations over the same in-memory bars.
+// All workers read from one shared IndicatorCache; each worker allocates
+// its runs' state from its own RunArena, reset between runs.
+class SweepRunner {
+public:
+    SweepRunner(const std::vector<OHLCV>& bars, const IndicatorCache* cache);
+    
+    // Run every config in the grid on `parallel` worker threads;
+    // results are returned in grid order
+    std::vector<SweepResult> run(const std::vector<StrategyConfig>& grid, int parallel);
+    
+    // Called on the worker thread as each run finishes, e.g. to hand its
+    // results to an AsyncExporter while the worker starts the next run
+    using ResultCallback = std::function<void(size_t index, const SweepResult& result,
+                                              const Analytics& analytics)>;
+    void set_result_callback(ResultCallback callback) { on_result = std::move(callback); }
+    
+    // Evaluate configs the WideKernel supports in lockstep batches instead
+    // of one BacktestRunner each (needs a cache; results are identical).
+    // The grid is split so every worker thread gets a batch, down to
+    // WIDE_MIN_LANES configs per batch.
+    static constexpr size_t WIDE_MIN_LANES = 8;
+    void set_wide(bool enabled) { wide = enabled; }
+    
+    // Advance batches of TILE_RUNS runners together through L2-sized tiles
+    // of bars, so each tile is read from memory once per batch instead of
+    // once per run. Workers are spread over NUMA nodes, and on multi-node
+    // hosts each node reads its own copy of the bars.
+    static constexpr size_t TILE_RUNS = 16;
+    static constexpr size_t TILE_BYTES = 256 * 1024;
+    void set_tiled(bool enabled, size_t bytes = TILE_BYTES) {
+        tiled = enabled;
+        tile_bytes = bytes;
+    }
+    
+    // Memory a runner reads per bar, which sizes the tiles: the bar, its
+    // timestamp's heap buffer (if it outgrew the inline one) and a value
+    // of every cached series
+    static size_t bytes_per_bar(const std::vector<OHLCV>& bars, const IndicatorCache* cache);
+    
+    // Allocator statistics of all workers' arenas from the last run()
+    const ArenaStats& arena_stats() const { return stats; }
+    
+    // Short "key=value,..." description of a run of the exit grid (grids
+    // from a config's lists and ranges have ConfigGrid::label)
+    static std::string label(const StrategyConfig& config);
+    
+    // Stop-loss / take-profit / slippage grid around a base config
+    static std::vector<StrategyConfig> exit_grid(const StrategyConfig& base);
+
+private:
+    const std::vector<OHLCV>& bars;
+    const IndicatorCache* cache;
+    ResultCallback on_result;
+    ArenaStats stats;
+    bool wide = false;
+    bool tiled = false;
+    size_t tile_bytes = TILE_BYTES;
+    
+    std::vector<SweepResult> run_wide(const std::vector<StrategyConfig>& grid, int parallel);
+    std::vector<SweepResult> run_tiled(const std::vector<StrategyConfig>& grid, int parallel);
+    SweepResult run_one(size_t index, const StrategyConfig& config, RunArena& arena) const;
+};
+
+} // namespace fluxback
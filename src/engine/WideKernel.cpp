@@ -0,0 +1,254 @@
+#include "engine/WideKernel.h"
+#include "data/SessionCalendar.h"
+#include "utils/Timestamp.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace fluxback {
+
+namespace {
+
+// A fill produced by one lane, replayed into that lane's Analytics
+struct LaneFill {
+    uint32_t bar;
+    uint32_t index;   // cache index of the bar
+    double side;      // +1 buy, -1 sell
+    double price;
+    double slippage;
+    double cash;      // after the fill
+    double position;  // after the fill
+    int size;
+};
+
+// Per-lane parameters and state; every field is one value per lane
+struct Lanes {
+    const double* fast_src[WideKernel::MAX_LANES];
+    const double* slow_src[WideKernel::MAX_LANES];
+    
+    alignas(64) double fast[WideKernel::MAX_LANES];
+    alignas(64) double slow[WideKernel::MAX_LANES];
+    
+    // Parameters
+    alignas(64) double size[WideKernel::MAX_LANES];
+    alignas(64) double stop_long[WideKernel::MAX_LANES];     // 1 - stop_loss_pct / 100
+    alignas(64) double stop_short[WideKernel::MAX_LANES];    // 1 + stop_loss_pct / 100
+    alignas(64) double take_long[WideKernel::MAX_LANES];     // 1 + take_profit_pct / 100
+    alignas(64) double take_short[WideKernel::MAX_LANES];    // 1 - take_profit_pct / 100
+    alignas(64) double rsi_max[WideKernel::MAX_LANES];       // long entries need rsi <= this
+    alignas(64) double rsi_min[WideKernel::MAX_LANES];       // short entries need rsi >= this
+    alignas(64) double vol_max[WideKernel::MAX_LANES];       // vol filter threshold (+inf = off)
+    alignas(64) double vol_scale[WideKernel::MAX_LANES];     // calendar annualization vs the cache's
+    alignas(64) double skip_volatile[WideKernel::MAX_LANES]; // 1 = exclude_volatile_regime
+    alignas(64) double adaptive[WideKernel::MAX_LANES];      // 1 = adaptive slippage
+    alignas(64) double base_slip[WideKernel::MAX_LANES];
+    alignas(64) double vol_mult[WideKernel::MAX_LANES];
+    alignas(64) double vol_low[WideKernel::MAX_LANES];
+    alignas(64) double vol_high[WideKernel::MAX_LANES];
+    alignas(64) double low_factor[WideKernel::MAX_LANES];
+    alignas(64) double high_factor[WideKernel::MAX_LANES];
+    
+    // State
+    alignas(64) double position[WideKernel::MAX_LANES];
+    alignas(64) double entry[WideKernel::MAX_LANES];
+    alignas(64) double prev_fast[WideKernel::MAX_LANES];
+    alignas(64) double prev_slow[WideKernel::MAX_LANES];
+    alignas(64) double initialized[WideKernel::MAX_LANES];
+    alignas(64) double cash[WideKernel::MAX_LANES];
+    
+    // Per-bar output
+    alignas(64) double side[WideKernel::MAX_LANES];
+    alignas(64) double qty[WideKernel::MAX_LANES];
+    alignas(64) double fill_price[WideKernel::MAX_LANES];
+    alignas(64) double slippage[WideKernel::MAX_LANES];
+};
+
+bool same_calendar(const StrategyConfig::CalendarConfig& a, const StrategyConfig::CalendarConfig& b) {
+    return a.market == b.market && a.open_minute == b.open_minute && a.close_minute == b.close_minute &&
+           a.days_per_year == b.days_per_year;
+}
+
+// 0/1 as a double; a select, since bool-to-double conversion won't vectorize
+inline double mask(bool b) {
+    return b ? 1.0 : 0.0;
+}
+
+// m ? a : b for a 0/1 mask m
+inline double blend(double m, double a, double b) {
+    return m * a + (1.0 - m) * b;
+}
+
+} // namespace
+
+WideKernel::WideKernel(const std::vector<OHLCV>& bars, const IndicatorCache& cache)
+    : bars(bars), cache(cache) {
+}
+
+bool WideKernel::supports(const StrategyConfig& config, const IndicatorCache& cache) {
+    return config.trend_timeframe_minutes <= 0 && !config.risk.enabled() &&
+           !config.costs.enabled() && !config.vwap.enabled() && cache.covers(config);
+}
+
+void WideKernel::run(const StrategyConfig* configs, size_t count, Analytics* analytics,
+                     double initial_cash) const {
+    const size_t n = std::min(count, MAX_LANES);
+    if (n == 0) return;
+    
+    Lanes lanes;
+    const double inf = std::numeric_limits<double>::infinity();
+    
+    // One session count per distinct calendar in the batch; each lane's
+    // run spans the years of its own calendar
+    std::vector<SessionCalendar> calendars;
+    std::vector<const StrategyConfig::CalendarConfig*> calendar_configs;
+    size_t calendar_of[MAX_LANES];
+    
+    for (size_t l = 0; l < n; ++l) {
+        const StrategyConfig& c = configs[l];
+        size_t k = 0;
+        while (k < calendar_configs.size() && !same_calendar(*calendar_configs[k], c.calendar)) ++k;
+        if (k == calendar_configs.size()) {
+            calendars.emplace_back(c.calendar);
+            calendar_configs.push_back(&c.calendar);
+        }
+        calendar_of[l] = k;
+        
+        lanes.fast_src[l] = cache.data(IndicatorCache::SMA, c.fast_sma);
+        lanes.slow_src[l] = cache.data(IndicatorCache::SMA, c.slow_sma);
+        lanes.size[l] = c.position_size;
+        lanes.stop_long[l] = 1.0 - c.stop_loss_pct / 100.0;
+        lanes.stop_short[l] = 1.0 + c.stop_loss_pct / 100.0;
+        lanes.take_long[l] = 1.0 + c.take_profit_pct / 100.0;
+        lanes.take_short[l] = 1.0 - c.take_profit_pct / 100.0;
+        lanes.rsi_max[l] = c.use_rsi_filter ? c.rsi_overbought : inf;
+        lanes.rsi_min[l] = c.use_rsi_filter ? c.rsi_oversold : -inf;
+        lanes.vol_max[l] = c.use_vol_filter ? c.vol_threshold : inf;
+        SessionCalendar calendar(c.calendar, parse_timeframe_minutes(c.timeframe));
+        lanes.vol_scale[l] = IndicatorEngine::vol_rescale(calendar.bars_per_day(), calendar.days_per_year());
+        lanes.skip_volatile[l] = c.exclude_volatile_regime ? 1.0 : 0.0;
+        lanes.adaptive[l] = c.slippage.type == "adaptive" ? 1.0 : 0.0;
+        lanes.base_slip[l] = c.slippage.base_ticks * 0.01;
+        lanes.vol_mult[l] = c.slippage.vol_multiplier;
+        lanes.vol_low[l] = c.slippage.vol_low;
+        lanes.vol_high[l] = c.slippage.vol_high;
+        lanes.low_factor[l] = c.slippage.low_factor;
+        lanes.high_factor[l] = c.slippage.high_factor;
+    
+        lanes.position[l] = 0.0;
+        lanes.entry[l] = 0.0;
+        lanes.prev_fast[l] = 0.0;
+        lanes.prev_slow[l] = 0.0;
+        lanes.initialized[l] = 0.0;
+        lanes.cash[l] = initial_cash;
+    }
+    
+    const double* vol_series = cache.data(IndicatorCache::REALIZED_VOL, 20);
+    const double* rsi_series = cache.data(IndicatorCache::RSI, 14);
+    std::vector<std::vector<LaneFill>> fills(n);
+    
+    uint32_t index = 0;
+    for (size_t b = 0; b < bars.size(); ++b) {
+        const OHLCV& bar = bars[b];
+        if (bar.close <= 0.0) continue; // BacktestRunner skips these too
+        const uint32_t i = index++;
+        for (SessionCalendar& calendar : calendars) calendar.advance(bar.timestamp);
+    
+        const double close = bar.close;
+        const double high = bar.high;
+        const double low = bar.low;
+        const double vol = vol_series[i];
+        const double rsi = rsi_series[i];
+        const double volatile_bar = cache.regime(i) == Regime::VOLATILE ? 1.0 : 0.0;
+    
+        for (size_t l = 0; l < n; ++l) {
+            lanes.fast[l] = lanes.fast_src[l][i];
+            lanes.slow[l] = lanes.slow_src[l][i];
+        }
+    
+        // Mirrors StrategyEngine::on_tick and ExecutionSimulator::execute
+        // with every branch turned into a select
+        for (size_t l = 0; l < n; ++l) {
+            const double fast = lanes.fast[l];
+            const double slow = lanes.slow[l];
+            const double pf = lanes.prev_fast[l];
+            const double ps = lanes.prev_slow[l];
+            const double pos = lanes.position[l];
+            const double entry = lanes.entry[l];
+    
+            // Masks combine with & and | (not && and ||) so there are no branches
+            const bool skipped = lanes.skip_volatile[l] * volatile_bar != 0.0;
+            const double lane_vol = vol * lanes.vol_scale[l];
+            const bool filtered = lane_vol > lanes.vol_max[l];
+            const bool active = !skipped & !filtered;
+            const bool sma_ok = (fast > 0.0) & (slow > 0.0);
+            const bool prev_ok = (pf > 0.0) & (ps > 0.0);
+            const bool is_long = pos > 0.0;
+            const bool is_short = pos < 0.0;
+            const bool cross_up = sma_ok & prev_ok & (pf <= ps) & (fast > slow);
+            const bool cross_down = sma_ok & prev_ok & (pf >= ps) & (fast < slow);
+    
+            const bool stop = (entry > 0.0) & ((is_long & (low <= entry * lanes.stop_long[l])) |
+                                               (is_short & (high >= entry * lanes.stop_short[l])));
+            const bool take = (entry > 0.0) & ((is_long & (high >= entry * lanes.take_long[l])) |
+                                               (is_short & (low <= entry * lanes.take_short[l])));
+            const bool reverse = (is_long & cross_down) | (is_short & cross_up);
+            const bool exit = active & (is_long | is_short) & (stop | take | reverse);
+    
+            const bool can_enter = active & !is_long & !is_short & (lanes.initialized[l] != 0.0);
+            const bool enter_long = can_enter & cross_up & (rsi <= lanes.rsi_max[l]);
+            const bool enter_short = can_enter & !enter_long & cross_down & (rsi >= lanes.rsi_min[l]);
+    
+            // 0/1 masks as doubles; blends of a 0/1 mask with finite values are
+            // exact, and unlike ?: the compiler never splits them into branches
+            const double ex = mask(exit);
+            const double el = mask(enter_long);
+            const double es = mask(enter_short);
+            const double side = ex * (mask(is_short) - mask(is_long)) + el - es;
+            const double qty = blend(ex, std::fabs(pos), lanes.size[l]);
+    
+            // Slippage and fill price (clamped to the bar's range)
+            const double factor = lane_vol < lanes.vol_low[l] ? lanes.low_factor[l]
+                                : (lane_vol > lanes.vol_high[l] ? lanes.high_factor[l] : 1.0);
+            const double adaptive_slip = (lanes.base_slip[l] + lanes.vol_mult[l] * lane_vol * close) * factor;
+            const double slip = blend(lanes.adaptive[l], adaptive_slip, lanes.base_slip[l]);
+            const double price = std::max(low, std::min(high, close + side * slip));
+    
+            // Entries only happen when flat, where pos and entry are 0
+            lanes.cash[l] -= side * price * qty; // side is 0 when nothing fills
+            lanes.position[l] = pos * (1.0 - ex) + lanes.size[l] * (el - es);
+            lanes.entry[l] = entry * (1.0 - ex) + close * (el + es);
+    
+            // Previous SMAs advance unless the bar was skipped or closed a trade
+            const double advance = mask(!skipped & !exit & sma_ok);
+            lanes.prev_fast[l] = blend(advance, fast, pf);
+            lanes.prev_slow[l] = blend(advance, slow, ps);
+            lanes.initialized[l] = std::max(lanes.initialized[l], advance);
+    
+            lanes.side[l] = side;
+            lanes.qty[l] = qty;
+            lanes.fill_price[l] = price;
+            lanes.slippage[l] = slip;
+        }
+    
+        // Rare scalar path: queue this bar's fills
+        for (size_t l = 0; l < n; ++l) {
+            if (lanes.side[l] == 0.0) continue;
+            fills[l].push_back({static_cast<uint32_t>(b), i, lanes.side[l], lanes.fill_price[l],
+                                lanes.slippage[l], lanes.cash[l], lanes.position[l],
+                                static_cast<int>(lanes.qty[l])});
+        }
+    }
+    
+    for (size_t l = 0; l < n; ++l) {
+        analytics[l].set_years(calendars[calendar_of[l]].years());
+        for (const LaneFill& f : fills[l]) {
+            const OHLCV& bar = bars[f.bar];
+            Order order(f.side > 0.0 ? Order::BUY : Order::SELL, f.size, bar.close);
+            Fill fill(order, f.price, f.size, bar.timestamp, f.slippage);
+            analytics[l].record_fill(fill, cache.regime(f.index), f.cash, f.position * bar.close);
+        }
+    }
+}
+
+} // namespace fluxback
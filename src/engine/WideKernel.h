@@ -0,0 +1,40 @@
+#pragma once
+
+#include "analytics/Analytics.h"
+#include "indicators/IndicatorCache.h"
+#include "utils/ConfigParser.h"
+#include <vector>
+
+namespace fluxback {
+
+// Evaluates many SMA-crossover configs over the same bars in lockstep, one
+// lane per config with all per-config state held as structure-of-arrays.
+// Crossovers, filters, stop/take-profit checks, fills and position/cash
+// updates are branch-free selects over the lanes, so the compiler turns the
+// per-bar loop into SIMD. Fills are rare; they are queued per lane and
+// replayed into Analytics afterwards, so summaries match BacktestRunner
+// exactly.
+class WideKernel {
+public:
+    // Lanes per run() call; one batch's state stays in L1
+    static constexpr size_t MAX_LANES = 64;
+    
+    // Series come from the cache, which must be built from `bars`
+    WideKernel(const std::vector<OHLCV>& bars, const IndicatorCache& cache);
+    
+    // True if the config can run in a lane: the cache holds every series it
+    // reads and it needs no higher-timeframe confirmation, risk limits,
+    // trading costs or session VWAP
+    static bool supports(const StrategyConfig& config, const IndicatorCache& cache);
+    
+    // Run configs[0, count) (count <= MAX_LANES); analytics[i] receives the
+    // fills of configs[i] and must be freshly reset
+    void run(const StrategyConfig* configs, size_t count, Analytics* analytics,
+             double initial_cash = 100000.0) const;
+
+private:
+    const std::vector<OHLCV>& bars;
+    const IndicatorCache& cache;
+};
+
+} // namespace fluxback
@@ -0,0 +1,126 @@
+#include "execution/CostModel.h"
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+namespace fluxback {
+
+namespace {
+
+// Preset commission / fee schedules. Figures are typical of each fee
+// structure, not any one broker's current price list.
+struct VenuePreset {
+    const char* name;
+    double per_share;
+    double bps;
+    double min;
+    double max_pct;
+    const char* tiers;
+    double exchange_per_share;
+    double exchange_bps;
+    double sell_bps;
+};
+
+const VenuePreset VENUES[] = {
+    {"none", 0.0, 0.0, 0.0, 0.0, "", 0.0, 0.0, 0.0},
+    {"per_share", 0.005, 0.0, 1.0, 1.0, "", 0.0, 0.0, 0.0},
+    {"tiered", 0.0, 0.0, 0.35, 1.0, "0:0.0035, 300000:0.002, 3000000:0.0015, 20000000:0.001", 0.003, 0.0, 0.0},
+    {"bps", 0.0, 2.0, 0.0, 0.0, "", 0.0, 0.5, 0.0},
+    {"zero_commission", 0.0, 0.0, 0.0, 0.0, "", 0.0, 0.0, 0.278},
+};
+
+const double DAYS_PER_YEAR = 360.0; // ACT/360
+
+} // namespace
+
+CostModel::CostModel(const StrategyConfig::CostConfig& config)
+    : schedule(config),
+      bps_rate(config.commission_bps / 10000.0),
+      min_commission(config.commission_min),
+      max_rate(config.commission_max_pct / 100.0),
+      fee_rate(config.exchange_fee_bps / 10000.0),
+      sell_rate(config.sell_fee_bps / 10000.0),
+      borrow_daily(config.borrow_rate_pct / 100.0 / DAYS_PER_YEAR),
+      finance_daily(config.financing_rate_pct / 100.0 / DAYS_PER_YEAR),
+      traded(0.0), tier(0) {
+}
+
+void CostModel::reset() {
+    traded = 0.0;
+    tier = 0;
+}
+
+FillCosts CostModel::on_fill(bool sell, int quantity, double price) {
+    const double units = quantity;
+    const double notional = units * price;
+    
+    double per_share = schedule.commission_per_share;
+    if (schedule.tier_count > 0) {
+        while (tier + 1 < schedule.tier_count && traded >= schedule.tiers[tier + 1].volume) ++tier;
+        per_share = schedule.tiers[tier].per_share;
+    }
+    traded += units;
+    
+    FillCosts costs;
+    costs.commission = std::max(per_share * units + bps_rate * notional, min_commission);
+    if (max_rate > 0.0) {
+        costs.commission = std::min(costs.commission, max_rate * notional);
+    }
+    costs.fees = schedule.exchange_fee_per_share * units + fee_rate * notional +
+                 (sell ? sell_rate * notional : 0.0);
+    return costs;
+}
+
+CarryCosts CostModel::carry(int position, double price, int64_t days) const {
+    CarryCosts costs;
+    double notional = std::abs(position) * price * static_cast<double>(days);
+    if (position < 0) {
+        costs.borrow = borrow_daily * notional;
+    } else {
+        costs.financing = finance_daily * notional;
+    }
+    return costs;
+}
+
+bool CostModel::apply_venue(const std::string& name, StrategyConfig::CostConfig& config) {
+    for (const VenuePreset& venue : VENUES) {
+        if (name != venue.name) continue;
+        config.venue = name;
+        config.commission_per_share = venue.per_share;
+        config.commission_bps = venue.bps;
+        config.commission_min = venue.min;
+        config.commission_max_pct = venue.max_pct;
+        config.tier_count = 0;
+        config.exchange_fee_per_share = venue.exchange_per_share;
+        config.exchange_fee_bps = venue.exchange_bps;
+        config.sell_fee_bps = venue.sell_bps;
+        return venue.tiers[0] == '\0' || parse_tiers(venue.tiers, config);
+    }
+    return false;
+}
+
+bool CostModel::parse_tiers(const std::string& text, StrategyConfig::CostConfig& config) {
+    StrategyConfig::CostConfig::Tier parsed[StrategyConfig::CostConfig::MAX_TIERS];
+    size_t count = 0;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        size_t colon = item.find(':');
+        if (colon == std::string::npos || count == StrategyConfig::CostConfig::MAX_TIERS) return false;
+        char* end = nullptr;
+        std::string volume = item.substr(0, colon);
+        std::string rate = item.substr(colon + 1);
+        parsed[count].volume = std::strtod(volume.c_str(), &end);
+        if (end == volume.c_str()) return false;
+        parsed[count].per_share = std::strtod(rate.c_str(), &end);
+        if (end == rate.c_str()) return false;
+        if (count > 0 && parsed[count].volume <= parsed[count - 1].volume) return false;
+        ++count;
+    }
+    if (count == 0) return false;
+    std::copy(parsed, parsed + count, config.tiers.begin());
+    config.tier_count = count;
+    return true;
+}
+
+} // namespace fluxback
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "utils/ConfigParser.h"
+#include <cstdint>
+#include <string>
+
+namespace fluxback {
+
+struct FillCosts {
+    double commission = 0.0;
+    double fees = 0.0; // exchange and regulatory
+};
+
+struct CarryCosts {
+    double borrow = 0.0;    // shorts
+    double financing = 0.0; // longs
+};
+
+// Trading costs compiled from a CostConfig. Rates are pre-scaled at
+// construction, so a fill costs a few multiply-adds plus a tier cursor
+// that only moves forward as traded volume grows.
+class CostModel {
+public:
+    explicit CostModel(const StrategyConfig::CostConfig& config);
+    
+    // Commission and fees for `quantity` units at `price`; counts the
+    // units towards the commission tiers
+    FillCosts on_fill(bool sell, int quantity, double price);
+    
+    // Holding `position` units at `price` across `days` calendar days
+    // (ACT/360)
+    CarryCosts carry(int position, double price, int64_t days) const;
+    
+    // Traded volume back to zero
+    void reset();
+    
+    // Replace the commission / fee schedule of `config` with a named
+    // preset (see the table in CostModel.cpp); false if there is none
+    static bool apply_venue(const std::string& name, StrategyConfig::CostConfig& config);
+    
+    // Commission tiers as "volume:per_share, ...", e.g.
+    // "0:0.0035, 300000:0.002"; volumes must increase
+    static bool parse_tiers(const std::string& text, StrategyConfig::CostConfig& config);
+
+private:
+    StrategyConfig::CostConfig schedule;
+    double bps_rate;      // commission_bps / 10000
+    double min_commission;
+    double max_rate;      // commission_max_pct / 100, 0 = no cap
+    double fee_rate;      // exchange_fee_bps / 10000
+    double sell_rate;     // sell_fee_bps / 10000
+    double borrow_daily;  // borrow_rate_pct / 100 / 360
+    double finance_daily; // financing_rate_pct / 100 / 360
+    double traded;
+    size_t tier;
+};
+
+} // namespace fluxback
@@ -1,11 +1,13 @@
 #include "execution/ExecutionSimulator.h"
+#include "utils/Timestamp.h"
 #include <cmath>
 #include <algorithm>
 
 namespace fluxback {
 
-ExecutionSimulator::ExecutionSimulator(const StrategyConfig& cfg)
-    : config(cfg), cash(100000.0), initial_cash(100000.0) {
+ExecutionSimulator::ExecutionSimulator(const StrategyConfig& cfg, std::pmr::memory_resource* resource)
+    : config(cfg), resource(resource), cash(100000.0), initial_cash(100000.0), costs(cfg.costs),
+      fill_costs(cfg.costs.per_fill()), carry_costs(cfg.costs.overnight()), last_day(-1) {
     position = Position();
 }
 
@@ -13,9 +15,29 @@ void ExecutionSimulator::reset(double initial_cash) {
     this->initial_cash = initial_cash;
     this->cash = initial_cash;
     position = Position();
+    costs.reset();
+    last_date.clear();
+    last_day = -1;
 }
 
-Fill ExecutionSimulator::execute(const Order& order, const OHLCV& tick, double realized_volatility) {
+CarryCosts ExecutionSimulator::accrue_carry(const OHLCV& tick) {
+    CarryCosts charged;
+    if (!carry_costs || tick.timestamp.compare(0, 10, last_date) == 0) return charged;
+    
+    // First bar of a new date: parse it once
+    int64_t epoch = 0;
+    if (!parse_timestamp(tick.timestamp, epoch)) return charged;
+    int64_t day = epoch >= 0 ? epoch / 86400 : (epoch - 86399) / 86400;
+    if (last_day >= 0 && day > last_day && position.size != 0) {
+        charged = costs.carry(position.size, tick.close, day - last_day);
+        cash -= charged.borrow + charged.financing;
+    }
+    last_day = std::max(last_day, day);
+    last_date.assign(tick.timestamp, 0, 10);
+    return charged;
+}
+
+Fill ExecutionSimulator::execute(const Order& order, const OHLCV& tick, double realized_volatility, double benchmark) {
     double current_price = tick.close;
     
     // Calculate slippage
@@ -43,7 +65,16 @@ Fill ExecutionSimulator::execute(const Order& order, const OHLCV& tick, double r
     }
     
     // Create fill
-    Fill fill(order, fill_price, order.size, tick.timestamp, slippage);
+    Fill fill(order, fill_price, order.size, tick.timestamp, slippage, resource);
+    fill.vwap = benchmark;
+    
+    // Commission and fees
+    if (fill_costs) {
+        FillCosts charged = costs.on_fill(order.type == Order::SELL, order.size, fill_price);
+        fill.commission = charged.commission;
+        fill.fees = charged.fees;
+        cash -= charged.commission + charged.fees;
+    }
     
     // Update position
     update_position(fill);
@@ -60,7 +91,7 @@ double ExecutionSimulator::calculate_slippage(const Order& order, double realize
         double tick_size = 0.01;
         double base_slippage = config.slippage.base_ticks * tick_size;
         double vol_component = config.slippage.vol_multiplier * realized_volatility * current_price;
-
+    
         // Dynamic scaling based on realized volatility bands
         double factor = 1.0;
         if (realized_volatility < config.slippage.vol_low) {
@@ -68,7 +99,7 @@ double ExecutionSimulator::calculate_slippage(const Order& order, double realize
         } else if (realized_volatility > config.slippage.vol_high) {
             factor = config.slippage.high_factor;
         }
-
+    
         slippage = (base_slippage + vol_component) * factor;
     } else {
         // Fixed slippage
@@ -84,7 +115,7 @@ void ExecutionSimulator::update_position(const Fill& fill) {
         if (position.size < 0) {
             // Closing short position
             int close_size = std::min(std::abs(position.size), fill.filled_size);
-            double pnl = (position.avg_price - fill.fill_price) * close_size;
+            position.realized_pnl += (position.avg_price - fill.fill_price) * close_size;
             position.size += close_size;
             
             // If we're opening a new long position
@@ -112,7 +143,7 @@ void ExecutionSimulator::update_position(const Fill& fill) {
         if (position.size > 0) {
             // Closing long position
             int close_size = std::min(position.size, fill.filled_size);
-            double pnl = (fill.fill_price - position.avg_price) * close_size;
+            position.realized_pnl += (fill.fill_price - position.avg_price) * close_size;
             position.size -= close_size;
             
             // If we're opening a new short position
@@ -137,6 +168,7 @@ void ExecutionSimulator::update_position(const Fill& fill) {
             }
         }
     }
+    position.unrealized_pnl = (fill.fill_price - position.avg_price) * position.size;
 }
 
 } // namespace fluxback
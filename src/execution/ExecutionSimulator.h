@@ -1,39 +1,67 @@
 #pragma once
 
 #include "strategy/StrategyEngine.h"
+#include "execution/CostModel.h"
 #include "data/DataLoader.h"
 #include "utils/ConfigParser.h"
+#include <memory_resource>
 #include <string>
+#include <string_view>
 
 namespace fluxback {
 
 struct Fill {
+    // The timestamp is allocated from the memory resource of the container
+    // holding the fill (a run's arena for Analytics::get_fills)
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+    
     Order order;
     double fill_price;
     int filled_size;
-    std::string timestamp;
+    std::pmr::string timestamp;
     double slippage;
+    double commission = 0.0;
+    double fees = 0.0;
+    double vwap = 0.0; // session VWAP benchmark when the order filled (0 = none)
+    
+    // Filled in by Analytics::record_fill: PnL this fill closed out (net
+    // of costs) and the open lots' PnL marked at the bar close after it
+    double realized_pnl = 0.0;
+    double unrealized_pnl = 0.0;
     
-    Fill() : order(Order(Order::BUY, 0, 0.0, "")), fill_price(0.0), filled_size(0), timestamp(""), slippage(0.0) {}
+    Fill() : Fill(allocator_type()) {}
+    explicit Fill(const allocator_type& alloc)
+        : order(Order::BUY, 0, 0.0), fill_price(0.0), filled_size(0), timestamp(alloc), slippage(0.0) {}
     
-    Fill(const Order& o, double fp, int fs, const std::string& ts, double sl)
-        : order(o), fill_price(fp), filled_size(fs), timestamp(ts), slippage(sl) {}
+    Fill(const Order& o, double fp, int fs, std::string_view ts, double sl, const allocator_type& alloc = {})
+        : order(o), fill_price(fp), filled_size(fs), timestamp(ts, alloc), slippage(sl) {}
+    
+    Fill(const Fill&) = default;
+    Fill(Fill&&) = default;
+    Fill& operator=(const Fill&) = default;
+    Fill& operator=(Fill&&) = default;
+    Fill(const Fill& other, const allocator_type& alloc) : order(other.order), timestamp(alloc) { *this = other; }
+    Fill(Fill&& other, const allocator_type& alloc) : order(other.order), timestamp(alloc) { *this = std::move(other); }
 };
 
 struct Position {
     int size;  // positive = long, negative = short, zero = flat
     double avg_price;
-    double unrealized_pnl;
+    double realized_pnl;   // gross of costs, closed against avg_price
+    double unrealized_pnl; // at the last fill price
     
-    Position() : size(0), avg_price(0.0), unrealized_pnl(0.0) {}
+    Position() : size(0), avg_price(0.0), realized_pnl(0.0), unrealized_pnl(0.0) {}
 };
 
 class ExecutionSimulator {
 public:
-    explicit ExecutionSimulator(const StrategyConfig& cfg);
+    // Fills are allocated from `resource`
+    explicit ExecutionSimulator(const StrategyConfig& cfg,
+                                std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     
-    // Execute an order and return fill
-    Fill execute(const Order& order, const OHLCV& tick, double realized_volatility);
+    // Execute an order and return fill; a session VWAP `benchmark` is
+    // stamped on the fill for VWAP-relative evaluation
+    Fill execute(const Order& order, const OHLCV& tick, double realized_volatility, double benchmark = 0.0);
     
     // Get current position
     Position get_position() const { return position; }
@@ -41,14 +69,24 @@ public:
     // Get current cash balance
     double get_cash() const { return cash; }
     
+    // Charge borrow / financing when `tick` starts a new calendar day with
+    // a position open; returns what was charged
+    CarryCosts accrue_carry(const OHLCV& tick);
+    
     // Reset simulator
     void reset(double initial_cash = 100000.0);
 
 private:
     StrategyConfig config;
+    std::pmr::memory_resource* resource;
     Position position;
     double cash;
     double initial_cash;
+    CostModel costs;
+    bool fill_costs;
+    bool carry_costs;
+    std::string last_date;  // date prefix of the last timestamp seen by accrue_carry
+    int64_t last_day;       // days since epoch, -1 before the first bar
     
     // Calculate slippage based on volatility and regime
     double calculate_slippage(const Order& order, double realized_volatility, double current_price);
@@ -0,0 +1,204 @@
+#include "indicators/IndicatorCache.h"
+#include "indicators/IndicatorEngine.h"
+#include "regime/RegimeModel.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fluxback {
+
+namespace {
+
+const char CACHE_MAGIC[4] = {'F', 'X', 'I', 'C'};
+const uint32_t CACHE_VERSION = 2;
+
+template <typename T>
+void write_pod(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool read_pod(std::ifstream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+} // namespace
+
+void IndicatorCache::prepare(const std::vector<OHLCV>& bars, const StrategyConfig& config, int parallel) {
+    compute(bars, SMA, config.fast_sma);
+    compute(bars, SMA, config.slow_sma);
+    compute(bars, REALIZED_VOL, 20);
+    compute(bars, RSI, 14);
+    if (!has_regimes() || regimes_from != regime_source(config)) {
+        compute_regimes(bars, config, parallel);
+    }
+}
+
+void IndicatorCache::compute(const std::vector<OHLCV>& bars, Kind kind, int window) {
+    if (window <= 0 || has(kind, window)) return;
+    if (bar_count != 0 && bar_count != bars.size()) {
+        std::cerr << "Warning: indicator cache built for " << bar_count
+                  << " bars, got " << bars.size() << std::endl;
+        return;
+    }
+    bar_count = bars.size();
+    
+    IndicatorEngine engine;
+    if (kind == SMA) engine.register_sma(window);
+    if (kind == EMA) engine.register_ema(window);
+    if (kind == RSI) engine.get_rsi(window); // selects the RSI window
+    
+    std::vector<double>& out = series[make_key(kind, window)];
+    out.reserve(bars.size());
+    for (const auto& bar : bars) {
+        engine.add_price(bar.close, bar.volume);
+        switch (kind) {
+            case SMA: out.push_back(engine.get_sma(window)); break;
+            case EMA: out.push_back(engine.get_ema(window)); break;
+            case RSI: out.push_back(engine.get_rsi(window)); break;
+            case REALIZED_VOL: out.push_back(engine.get_realized_vol(window)); break;
+            case VWAP: out.push_back(engine.get_vwap(window)); break;
+        }
+    }
+}
+
+void IndicatorCache::compute_regimes(const std::vector<OHLCV>& bars, const StrategyConfig& config, int parallel) {
+    regimes = RegimeDetector::label_series(bars, parallel, 20, regime_backend(config),
+                                           config.regime.fitted.get());
+    regimes_from = regime_source(config);
+    if (bar_count == 0) bar_count = bars.size();
+}
+
+bool IndicatorCache::has(Kind kind, int window) const {
+    return series.find(make_key(kind, window)) != series.end();
+}
+
+bool IndicatorCache::covers(const StrategyConfig& config) const {
+    return has(SMA, config.fast_sma) && has(SMA, config.slow_sma) &&
+           has(REALIZED_VOL, 20) && has(RSI, 14) && has_regimes() &&
+           regimes_from == regime_source(config);
+}
+
+double IndicatorCache::value(Kind kind, int window, size_t index) const {
+    auto it = series.find(make_key(kind, window));
+    if (it == series.end() || index >= it->second.size()) return 0.0;
+    return it->second[index];
+}
+
+const double* IndicatorCache::data(Kind kind, int window) const {
+    auto it = series.find(make_key(kind, window));
+    return it == series.end() ? nullptr : it->second.data();
+}
+
+std::string IndicatorCache::sidecar_path(const std::string& data_path) {
+    return data_path + ".fxcache";
+}
+
+bool IndicatorCache::fingerprint(const std::string& data_path, uint64_t& size, int64_t& mtime) {
+    std::error_code ec;
+    auto file_size = std::filesystem::file_size(data_path, ec);
+    if (ec) return false;
+    auto write_time = std::filesystem::last_write_time(data_path, ec);
+    if (ec) return false;
+    size = static_cast<uint64_t>(file_size);
+    mtime = static_cast<int64_t>(write_time.time_since_epoch().count());
+    return true;
+}
+
+bool IndicatorCache::save(const std::string& cache_path, const std::string& data_path) const {
+    uint64_t data_size = 0;
+    int64_t data_mtime = 0;
+    if (!fingerprint(data_path, data_size, data_mtime)) return false;
+    
+    std::ofstream out(cache_path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "Error: Could not open file for writing: " << cache_path << std::endl;
+        return false;
+    }
+    
+    out.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    write_pod(out, CACHE_VERSION);
+    write_pod(out, data_size);
+    write_pod(out, data_mtime);
+    write_pod(out, static_cast<uint64_t>(bar_count));
+    write_pod(out, static_cast<uint32_t>(series.size()));
+    for (const auto& [key, values] : series) {
+        write_pod(out, key);
+        out.write(reinterpret_cast<const char*>(values.data()),
+                  static_cast<std::streamsize>(values.size() * sizeof(double)));
+    }
+    write_pod(out, static_cast<uint8_t>(has_regimes() ? 1 : 0));
+    write_pod(out, static_cast<uint32_t>(regimes_from.size()));
+    out.write(regimes_from.data(), static_cast<std::streamsize>(regimes_from.size()));
+    out.write(reinterpret_cast<const char*>(regimes.data()), static_cast<std::streamsize>(regimes.size()));
+    return static_cast<bool>(out);
+}
+
+bool IndicatorCache::load(const std::string& cache_path, const std::string& data_path, size_t expected_bars) {
+    std::ifstream in(cache_path, std::ios::binary);
+    if (!in.is_open()) return false;
+    
+    uint64_t data_size = 0;
+    int64_t data_mtime = 0;
+    if (!fingerprint(data_path, data_size, data_mtime)) return false;
+    std::error_code ec;
+    const uint64_t file_size = std::filesystem::file_size(cache_path, ec);
+    if (ec) return false;
+    
+    char magic[4];
+    uint32_t version = 0;
+    uint64_t stored_size = 0, stored_bars = 0;
+    int64_t stored_mtime = 0;
+    uint32_t series_count = 0;
+    if (!in.read(magic, sizeof(magic)) || std::string(magic, 4) != std::string(CACHE_MAGIC, 4)) return false;
+    if (!read_pod(in, version) || version != CACHE_VERSION) return false;
+    if (!read_pod(in, stored_size) || !read_pod(in, stored_mtime)) return false;
+    if (stored_size != data_size || stored_mtime != data_mtime) return false; // stale
+    if (!read_pod(in, stored_bars) || !read_pod(in, series_count)) return false;
+    
+    // Sizes come from the file: check them against the data and the bytes
+    // actually left before allocating, so a corrupt sidecar is just a miss
+    if (stored_bars != expected_bars) return false;
+    uint64_t remaining = file_size - static_cast<uint64_t>(in.tellg());
+    const uint64_t series_bytes = sizeof(uint64_t) + stored_bars * sizeof(double);
+    if (series_count > remaining / series_bytes) return false;
+    remaining -= series_count * series_bytes;
+    
+    std::unordered_map<uint64_t, std::vector<double>> loaded;
+    for (uint32_t i = 0; i < series_count; ++i) {
+        uint64_t key = 0;
+        if (!read_pod(in, key)) return false;
+        std::vector<double> values(stored_bars);
+        if (!in.read(reinterpret_cast<char*>(values.data()),
+                     static_cast<std::streamsize>(values.size() * sizeof(double)))) {
+            return false;
+        }
+        loaded.emplace(key, std::move(values));
+    }
+    
+    uint8_t has_regime_series = 0;
+    uint32_t source_length = 0;
+    if (!read_pod(in, has_regime_series) || !read_pod(in, source_length)) return false;
+    remaining -= std::min<uint64_t>(remaining, sizeof(has_regime_series) + sizeof(source_length));
+    if (source_length > remaining) return false;
+    if (has_regime_series && stored_bars > remaining - source_length) return false;
+    std::string loaded_source(source_length, '\0');
+    if (!in.read(loaded_source.data(), static_cast<std::streamsize>(source_length))) return false;
+    std::vector<uint8_t> loaded_regimes;
+    if (has_regime_series) {
+        loaded_regimes.resize(stored_bars);
+        if (!in.read(reinterpret_cast<char*>(loaded_regimes.data()),
+                     static_cast<std::streamsize>(loaded_regimes.size()))) {
+            return false;
+        }
+    }
+    
+    bar_count = stored_bars;
+    series = std::move(loaded);
+    regimes = std::move(loaded_regimes);
+    regimes_from = std::move(loaded_source);
+    return true;
+}
+
+} // namespace fluxback
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "data/DataLoader.h"
+#include "regime/RegimeDetector.h"
+#include "utils/ConfigParser.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fluxback {
+
+// Read-only per-bar indicator and regime series for one data file.
+// Built once (or loaded from a sidecar file next to the data) and shared
+// by every sweep worker, so runs that only differ in exit or execution
+// parameters never recompute indicators.
+class IndicatorCache {
+public:
+    enum Kind : uint8_t {
+        SMA,
+        EMA,
+        RSI,
+        REALIZED_VOL,
+        VWAP
+    };
+    
+    IndicatorCache() = default;
+    
+    // Compute every series the given strategy reads, plus regimes
+    // (regimes are labelled in parallel chunks on `parallel` threads)
+    void prepare(const std::vector<OHLCV>& bars, const StrategyConfig& config, int parallel = 1);
+    
+    // Compute a single series (no-op if already present)
+    void compute(const std::vector<OHLCV>& bars, Kind kind, int window);
+    
+    bool has(Kind kind, int window) const;
+    
+    // True if prepare(bars, config) would not compute anything new
+    // (including regimes from the config's regime backend)
+    bool covers(const StrategyConfig& config) const;
+    
+    // Value of a series at a bar index; 0.0 if the series is missing
+    double value(Kind kind, int window, size_t index) const;
+    
+    // Whole series (size() values), or nullptr if it was not computed
+    const double* data(Kind kind, int window) const;
+    
+    Regime regime(size_t index) const { return static_cast<Regime>(regimes[index]); }
+    
+    // One uint8_t(Regime) per bar, shared read-only by every run
+    const std::vector<uint8_t>& regime_labels() const { return regimes; }
+    bool has_regimes() const { return !regimes.empty(); }
+    size_t size() const { return bar_count; }
+    
+    // Bytes held per bar across all series and regime labels
+    size_t bytes_per_bar() const {
+        return series.size() * sizeof(double) + (regimes.empty() ? 0 : sizeof(uint8_t));
+    }
+    
+    // Sidecar persistence; load() rejects files whose fingerprint
+    // (size, mtime) no longer matches the data file, that don't hold
+    // `expected_bars` bars, or that are truncated or corrupt
+    bool save(const std::string& cache_path, const std::string& data_path) const;
+    bool load(const std::string& cache_path, const std::string& data_path, size_t expected_bars);
+    static std::string sidecar_path(const std::string& data_path);
+
+private:
+    size_t bar_count = 0;
+    std::unordered_map<uint64_t, std::vector<double>> series;
+    std::vector<uint8_t> regimes;
+    std::string regimes_from; // regime_source() of the config they were computed for
+    
+    static uint64_t make_key(Kind kind, int window) {
+        return (static_cast<uint64_t>(kind) << 32) | static_cast<uint32_t>(window);
+    }
+    void compute_regimes(const std::vector<OHLCV>& bars, const StrategyConfig& config, int parallel);
+    static bool fingerprint(const std::string& data_path, uint64_t& size, int64_t& mtime);
+};
+
+} // namespace fluxback
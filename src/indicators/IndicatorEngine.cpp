@@ -1,22 +1,84 @@
 #include "indicators/IndicatorEngine.h"
+#include "indicators/IndicatorCache.h"
 #include <algorithm>
 #include <numeric>
 
 namespace fluxback {
 
-IndicatorEngine::IndicatorEngine()
-    : latest_price(0.0), latest_volume(0), rsi_avg_gain(0.0), rsi_avg_loss(0.0),
-      rsi_initialized(false), rsi_window(14) {
+namespace {
+
+const double DEFAULT_BARS_PER_DAY = 390.0;
+const double DEFAULT_DAYS_PER_YEAR = 252.0;
+
+} // namespace
+
+IndicatorEngine::IndicatorEngine(std::pmr::memory_resource* resource)
+    : latest_price(0.0), latest_volume(0), bar_count(0), cache(nullptr), cache_index(0),
+      sma_queues(resource), sma_sums(resource), ema_values(resource), ema_initialized(resource),
+      price_changes(resource), rsi_avg_gain(0.0), rsi_avg_loss(0.0), rsi_initialized(false), rsi_window(14),
+      returns(resource), vol_bars_per_day(DEFAULT_BARS_PER_DAY), vol_days_per_year(DEFAULT_DAYS_PER_YEAR),
+      vol_cache_scale(1.0), session_tracking(false), price_volume_pairs(resource), vwap_sums_price_volume(resource),
+      vwap_sums_volume(resource) {
 }
 
 void IndicatorEngine::add_price(double price, long volume) {
-    latest_price = price;
-    latest_volume = volume;
+    if (session_tracking) {
+        session.add(price, volume);
+    }
     
-    // Update all indicators
+    if (cache != nullptr) {
+        // Cached mode: series are precomputed, just advance the cursor
+        cache_index = bar_count;
+        bar_count++;
+        latest_price = price;
+        latest_volume = volume;
+        return;
+    }
+    
+    // Update all indicators (these read latest_price as the previous price)
     update_realized_vol(price);
     update_rsi(price);
     update_vwap(price, volume, 20);
+    
+    latest_price = price;
+    latest_volume = volume;
+    bar_count++;
+    
+    // Registered moving averages advance exactly once per bar
+    for (auto& entry : sma_queues) {
+        update_sma(price, entry.first);
+    }
+    for (auto& entry : ema_values) {
+        update_ema(price, entry.first);
+    }
+}
+
+void IndicatorEngine::track_session(double bucket_pct) {
+    session = SessionProfile(bucket_pct);
+    session_tracking = true;
+}
+
+void IndicatorEngine::register_sma(int window) {
+    if (window <= 0 || sma_queues.count(window)) return;
+    sma_queues[window];
+    sma_sums[window] = 0.0;
+    if (bar_count > 0) {
+        update_sma(latest_price, window);
+    }
+}
+
+void IndicatorEngine::register_ema(int window) {
+    if (window <= 0 || ema_values.count(window)) return;
+    ema_values[window] = 0.0;
+    ema_initialized[window] = false;
+    if (bar_count > 0) {
+        update_ema(latest_price, window);
+    }
+}
+
+void IndicatorEngine::attach_cache(const IndicatorCache* c) {
+    reset();
+    cache = c;
 }
 
 void IndicatorEngine::reset() {
@@ -29,16 +91,29 @@ void IndicatorEngine::reset() {
     price_volume_pairs.clear();
     vwap_sums_price_volume.clear();
     vwap_sums_volume.clear();
+    session.start_session();
     rsi_initialized = false;
     rsi_avg_gain = 0.0;
     rsi_avg_loss = 0.0;
     latest_price = 0.0;
     latest_volume = 0;
+    bar_count = 0;
+    cache_index = 0;
 }
 
 double IndicatorEngine::get_sma(int window) {
     if (window <= 0) return 0.0;
-    return update_sma(latest_price, window);
+    if (cache != nullptr) {
+        return cache->value(IndicatorCache::SMA, window, cache_index);
+    }
+    
+    auto it = sma_queues.find(window);
+    if (it == sma_queues.end()) {
+        register_sma(window);
+        it = sma_queues.find(window);
+    }
+    if (it->second.empty()) return 0.0;
+    return sma_sums[window] / it->second.size();
 }
 
 double IndicatorEngine::update_sma(double price, int window) {
@@ -59,7 +134,16 @@ double IndicatorEngine::update_sma(double price, int window) {
 
 double IndicatorEngine::get_ema(int window) {
     if (window <= 0) return 0.0;
-    return update_ema(latest_price, window);
+    if (cache != nullptr) {
+        return cache->value(IndicatorCache::EMA, window, cache_index);
+    }
+    
+    auto it = ema_values.find(window);
+    if (it == ema_values.end()) {
+        register_ema(window);
+        it = ema_values.find(window);
+    }
+    return it->second;
 }
 
 double IndicatorEngine::update_ema(double price, int window) {
@@ -118,6 +202,10 @@ void IndicatorEngine::update_rsi(double price) {
 }
 
 double IndicatorEngine::get_rsi(int window) {
+    if (cache != nullptr) {
+        return cache->value(IndicatorCache::RSI, window, cache_index);
+    }
+    
     if (window != rsi_window) {
         // Reset and recalculate with new window
         rsi_window = window;
@@ -128,9 +216,12 @@ double IndicatorEngine::get_rsi(int window) {
         return 0.0;
     }
     
-    if (!rsi_initialized || rsi_avg_loss == 0.0) {
+    if (!rsi_initialized) {
         return 50.0; // Neutral RSI
     }
+    if (rsi_avg_loss == 0.0) {
+        return rsi_avg_gain > 0.0 ? 100.0 : 50.0;
+    }
     
     double rs = rsi_avg_gain / rsi_avg_loss;
     return 100.0 - (100.0 / (1.0 + rs));
@@ -157,6 +248,10 @@ void IndicatorEngine::update_realized_vol(double price) {
 }
 
 double IndicatorEngine::get_realized_vol(int window) {
+    if (cache != nullptr) {
+        return cache->value(IndicatorCache::REALIZED_VOL, window, cache_index) * vol_cache_scale;
+    }
+    
     if (returns.size() < 2) return 0.0;
     
     size_t calc_window = std::min(returns.size(), static_cast<size_t>(window));
@@ -178,9 +273,20 @@ double IndicatorEngine::get_realized_vol(int window) {
     }
     variance /= (calc_window - 1);
     
-    // Annualized volatility (assuming 252 trading days, ~390 minutes per day)
-    double daily_vol = std::sqrt(variance * 390);
-    return daily_vol * std::sqrt(252.0);
+    // Annualized volatility
+    double daily_vol = std::sqrt(variance * vol_bars_per_day);
+    return daily_vol * std::sqrt(vol_days_per_year);
+}
+
+void IndicatorEngine::set_annualization(double bars_per_day, double days_per_year) {
+    vol_bars_per_day = bars_per_day;
+    vol_days_per_year = days_per_year;
+    vol_cache_scale = vol_rescale(bars_per_day, days_per_year);
+}
+
+double IndicatorEngine::vol_rescale(double bars_per_day, double days_per_year) {
+    if (bars_per_day == DEFAULT_BARS_PER_DAY && days_per_year == DEFAULT_DAYS_PER_YEAR) return 1.0;
+    return std::sqrt(bars_per_day * days_per_year / (DEFAULT_BARS_PER_DAY * DEFAULT_DAYS_PER_YEAR));
 }
 
 void IndicatorEngine::update_vwap(double price, long volume, int window) {
@@ -201,6 +307,10 @@ void IndicatorEngine::update_vwap(double price, long volume, int window) {
 }
 
 double IndicatorEngine::get_vwap(int window) {
+    if (cache != nullptr) {
+        return cache->value(IndicatorCache::VWAP, window, cache_index);
+    }
+    
     auto it_pv = vwap_sums_price_volume.find(window);
     auto it_v = vwap_sums_volume.find(window);
     
@@ -1,18 +1,34 @@
 #pragma once
 
+#include "indicators/SessionProfile.h"
 #include <deque>
+#include <memory_resource>
 #include <unordered_map>
 #include <cmath>
+#include <cstddef>
 
 namespace fluxback {
 
+class IndicatorCache;
+
 class IndicatorEngine {
 public:
-    IndicatorEngine();
+    // Window state is allocated from `resource` (e.g. a per-worker RunArena)
+    explicit IndicatorEngine(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     
     // Update with new price/volume
     void add_price(double price, long volume = 0);
     
+    // Track a moving average window from the current bar onwards.
+    // get_sma/get_ema register unknown windows on first use.
+    void register_sma(int window);
+    void register_ema(int window);
+    
+    // Serve indicator values from a precomputed cache instead of
+    // computing them; add_price then only advances the bar cursor.
+    // Pass nullptr to return to live computation.
+    void attach_cache(const IndicatorCache* cache);
+    
     // Simple Moving Average
     double get_sma(int window);
     
@@ -22,12 +38,32 @@ public:
     // Relative Strength Index
     double get_rsi(int window = 14);
     
-    // Realized Volatility (standard deviation of returns)
+    // Realized Volatility (standard deviation of returns), annualized
     double get_realized_vol(int window = 20);
     
+    // Bars per session and sessions per year used to annualize realized
+    // volatility (default 390 x 252: one-minute bars on a US equity
+    // session). Kept across reset(); cached values are rescaled to match.
+    void set_annualization(double bars_per_day, double days_per_year);
+    
+    // Factor taking a default-annualized volatility to the given one
+    // (exactly 1.0 for the default)
+    static double vol_rescale(double bars_per_day, double days_per_year);
+    
     // Volume Weighted Average Price
     double get_vwap(int window = 20);
     
+    // Keep the session VWAP / volume profile from the next bar on, with
+    // buckets of `bucket_pct` of the session's first price. Tracked in
+    // cached mode too, since it only needs the current session.
+    void track_session(double bucket_pct);
+    
+    // The next bar opens a new session
+    void start_session() { session.start_session(); }
+    
+    // Session VWAP, bands and volume profile (empty unless tracked)
+    const SessionProfile& get_session() const { return session; }
+    
     // Get latest price
     double get_latest_price() const { return latest_price; }
     
@@ -37,29 +73,41 @@ public:
 private:
     double latest_price;
     long latest_volume;
+    size_t bar_count;
+    
+    // Precomputed series (not owned)
+    const IndicatorCache* cache;
+    size_t cache_index;
     
     // SMA storage: window -> (queue, sum)
-    std::unordered_map<int, std::deque<double>> sma_queues;
-    std::unordered_map<int, double> sma_sums;
+    std::pmr::unordered_map<int, std::pmr::deque<double>> sma_queues;
+    std::pmr::unordered_map<int, double> sma_sums;
     
     // EMA storage: window -> current EMA value
-    std::unordered_map<int, double> ema_values;
-    std::unordered_map<int, bool> ema_initialized;
+    std::pmr::unordered_map<int, double> ema_values;
+    std::pmr::unordered_map<int, bool> ema_initialized;
     
     // RSI storage
-    std::deque<double> price_changes;
+    std::pmr::deque<double> price_changes;
     double rsi_avg_gain;
     double rsi_avg_loss;
     bool rsi_initialized;
     int rsi_window;
     
     // Realized volatility storage
-    std::deque<double> returns;
+    std::pmr::deque<double> returns;
+    double vol_bars_per_day;
+    double vol_days_per_year;
+    double vol_cache_scale; // cached values are annualized at the default
+    
+    // Session VWAP and volume profile
+    SessionProfile session;
+    bool session_tracking;
     
     // VWAP storage
-    std::deque<std::pair<double, long>> price_volume_pairs; // (price, volume)
-    std::unordered_map<int, double> vwap_sums_price_volume;
-    std::unordered_map<int, long> vwap_sums_volume;
+    std::pmr::deque<std::pair<double, long>> price_volume_pairs; // (price, volume)
+    std::pmr::unordered_map<int, double> vwap_sums_price_volume;
+    std::pmr::unordered_map<int, long> vwap_sums_volume;
     
     // Helper methods
     double update_sma(double price, int window);
@@ -0,0 +1,35 @@
+#include "indicators/MultiTimeframe.h"
+
+namespace fluxback {
+
+size_t MultiTimeframe::add_timeframe(int period_minutes) {
+    int existing = find(period_minutes);
+    if (existing >= 0) return static_cast<size_t>(existing);
+    frames.emplace_back(period_minutes);
+    return frames.size() - 1;
+}
+
+int MultiTimeframe::find(int period_minutes) const {
+    for (size_t i = 0; i < frames.size(); ++i) {
+        if (frames[i].aggregator.get_period_minutes() == period_minutes) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void MultiTimeframe::on_bar(const OHLCV& bar) {
+    for (auto& frame : frames) {
+        if (frame.aggregator.update(bar)) {
+            const OHLCV& done = frame.aggregator.last_completed();
+            frame.indicators.add_price(done.close, done.volume);
+        }
+    }
+}
+
+void MultiTimeframe::reset() {
+    for (auto& frame : frames) {
+        frame.aggregator.reset();
+        frame.indicators.reset();
+    }
+}
+
+} // namespace fluxback
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "data/BarAggregator.h"
+#include "indicators/IndicatorEngine.h"
+#include <vector>
+
+namespace fluxback {
+
+// Higher-timeframe bars and indicators maintained alongside the base
+// stream. Each timeframe has its own BarAggregator and IndicatorEngine;
+// indicators only see completed bars.
+class MultiTimeframe {
+public:
+    // Register a timeframe (idempotent); returns its slot for O(1) lookup
+    size_t add_timeframe(int period_minutes);
+    
+    // Feed one base bar to every timeframe
+    void on_bar(const OHLCV& bar);
+    
+    // Lookup by slot (O(1)) or by period (linear over the few timeframes)
+    IndicatorEngine& indicators(size_t slot) { return frames[slot].indicators; }
+    const BarAggregator& bars(size_t slot) const { return frames[slot].aggregator; }
+    int find(int period_minutes) const;
+    
+    bool empty() const { return frames.empty(); }
+    size_t size() const { return frames.size(); }
+    
+    void reset();
+
+private:
+    struct Timeframe {
+        BarAggregator aggregator;
+        IndicatorEngine indicators;
+        
+        explicit Timeframe(int period_minutes) : aggregator(period_minutes) {}
+    };
+    std::vector<Timeframe> frames;
+};
+
+} // namespace fluxback
@@ -0,0 +1,118 @@
+#include "indicators/SessionProfile.h"
+#include <algorithm>
+#include <cmath>
+
+namespace fluxback {
+
+SessionProfile::SessionProfile(double bucket_pct)
+    : bucket_pct(bucket_pct > 0.0 ? bucket_pct : 0.05) {
+    histogram.fill(0.0);
+    lowest = BUCKETS;
+    highest = 0;
+    start_session();
+}
+
+void SessionProfile::start_session() {
+    // Only the occupied buckets can be nonzero
+    if (lowest <= highest) {
+        std::fill(histogram.begin() + lowest, histogram.begin() + highest + 1, 0.0);
+    }
+    anchor = 0.0;
+    base = 0.0;
+    width = 0.0;
+    lowest = BUCKETS;
+    highest = 0;
+    poc = 0;
+    total_volume = 0.0;
+    sum_dv = 0.0;
+    sum_d2v = 0.0;
+}
+
+void SessionProfile::add(double price, long volume) {
+    if (volume <= 0 || !(price > 0.0)) return;
+    
+    if (total_volume == 0.0) {
+        // First trade of the session centres the histogram on its price
+        anchor = price;
+        width = price * bucket_pct / 100.0;
+        base = price - width * (BUCKETS / 2);
+    }
+    double offset = std::floor((price - base) / width);
+    if (offset < 0.0 || offset >= static_cast<double>(BUCKETS)) {
+        coarsen(price);
+        offset = std::floor((price - base) / width);
+    }
+    size_t bucket = std::min(static_cast<size_t>(std::max(offset, 0.0)), BUCKETS - 1);
+    
+    const double v = static_cast<double>(volume);
+    const double d = price - anchor;
+    histogram[bucket] += v;
+    total_volume += v;
+    sum_dv += v * d;
+    sum_d2v += v * d * d;
+    lowest = std::min(lowest, bucket);
+    highest = std::max(highest, bucket);
+    if (histogram[bucket] > histogram[poc]) poc = bucket;
+}
+
+void SessionProfile::coarsen(double price) {
+    while (price < base || price >= base + width * BUCKETS) {
+        // Below the range: grow downwards, so old bucket i lands in
+        // (i + BUCKETS) / 2; above it: old bucket i lands in i / 2
+        const size_t shift = price < base ? BUCKETS : 0;
+        std::array<double, BUCKETS> merged{};
+        for (size_t i = lowest; i <= highest && i < BUCKETS; ++i) {
+            merged[(i + shift) / 2] += histogram[i];
+        }
+        histogram = merged;
+        if (lowest <= highest) {
+            lowest = (lowest + shift) / 2;
+            highest = (highest + shift) / 2;
+        }
+        base -= shift > 0 ? width * BUCKETS : 0.0;
+        width *= 2.0;
+    }
+    
+    poc = lowest <= highest ? lowest : 0;
+    for (size_t i = lowest; i <= highest && i < BUCKETS; ++i) {
+        if (histogram[i] > histogram[poc]) poc = i;
+    }
+}
+
+double SessionProfile::vwap() const {
+    return total_volume > 0.0 ? anchor + sum_dv / total_volume : 0.0;
+}
+
+double SessionProfile::stddev() const {
+    if (total_volume <= 0.0) return 0.0;
+    double mean = sum_dv / total_volume;
+    double variance = sum_d2v / total_volume - mean * mean;
+    return variance > 0.0 ? std::sqrt(variance) : 0.0;
+}
+
+double SessionProfile::point_of_control() const {
+    return total_volume > 0.0 ? base + (poc + 0.5) * width : 0.0;
+}
+
+bool SessionProfile::value_area(double fraction, double& low, double& high) const {
+    if (total_volume <= 0.0) return false;
+    
+    const double target = std::min(std::max(fraction, 0.0), 1.0) * total_volume;
+    size_t from = poc;
+    size_t to = poc;
+    double inside = histogram[poc];
+    while (inside < target && (from > lowest || to < highest)) {
+        double below = from > lowest ? histogram[from - 1] : -1.0;
+        double above = to < highest ? histogram[to + 1] : -1.0;
+        if (above >= below) {
+            inside += histogram[++to];
+        } else {
+            inside += histogram[--from];
+        }
+    }
+    low = base + from * width;
+    high = base + (to + 1) * width;
+    return true;
+}
+
+} // namespace fluxback
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace fluxback {
+
+// Session-anchored VWAP with standard-deviation bands, and the session's
+// volume-by-price profile. Volume is binned into a fixed histogram whose
+// buckets start at `bucket_pct` of the session's first price; when prices
+// leave its range, neighbouring buckets merge and the width doubles. Each
+// bar is O(1) and nothing is allocated after construction.
+class SessionProfile {
+public:
+    static constexpr size_t BUCKETS = 256;
+    
+    explicit SessionProfile(double bucket_pct = 0.05);
+    
+    // Clear everything for a new session
+    void start_session();
+    
+    // Trade `volume` at `price`
+    void add(double price, long volume);
+    
+    // Volume-weighted mean price of the session; 0 before any volume
+    double vwap() const;
+    
+    // Volume-weighted standard deviation of price around vwap()
+    double stddev() const;
+    double upper_band(double sigma) const { return vwap() + sigma * stddev(); }
+    double lower_band(double sigma) const { return vwap() - sigma * stddev(); }
+    
+    double volume() const { return total_volume; }
+    double bucket_width() const { return width; }
+    
+    // Midpoint of the bucket holding the most volume; 0 before any volume
+    double point_of_control() const;
+    
+    // Smallest price range around the point of control that holds
+    // `fraction` of the session's volume, grown one bucket at a time
+    // towards the heavier side; false before any volume
+    bool value_area(double fraction, double& low, double& high) const;
+
+private:
+    std::array<double, BUCKETS> histogram;
+    double bucket_pct;
+    double anchor; // first price of the session; sums are kept relative to it
+    double base;   // lower edge of bucket 0
+    double width;
+    size_t lowest;  // occupied buckets are [lowest, highest]
+    size_t highest;
+    size_t poc;
+    double total_volume;
+    double sum_dv;  // sum of volume * (price - anchor)
+    double sum_d2v; // sum of volume * (price - anchor)^2
+    
+    // Halve the resolution so `price` fits
+    void coarsen(double price);
+};
+
+} // namespace fluxback
@@ -0,0 +1,191 @@
+#include "journal/RunJournal.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace fluxback {
+
+namespace {
+
+const char JOURNAL_MAGIC[4] = {'F', 'X', 'J', '1'};
+const size_t RING_EVENTS = 1 << 16;
+const size_t WRITE_BATCH = 4096;
+const size_t SCAN_BATCH = 1024;
+
+} // namespace
+
+JournalWriter::JournalWriter()
+    : ring(RING_EVENTS), file(nullptr), stopping(false), failed(false), recorded(0) {
+}
+
+JournalWriter::~JournalWriter() {
+    close();
+}
+
+bool JournalWriter::open(const std::string& path, const std::string& label) {
+    close();
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    
+    // Header: magic, record size, label
+    uint32_t record_size = sizeof(JournalEvent);
+    uint32_t label_size = static_cast<uint32_t>(label.size());
+    bool ok = std::fwrite(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC), 1, file) == 1 &&
+              std::fwrite(&record_size, sizeof(record_size), 1, file) == 1 &&
+              std::fwrite(&label_size, sizeof(label_size), 1, file) == 1 &&
+              (label.empty() || std::fwrite(label.data(), label.size(), 1, file) == 1);
+    if (!ok) {
+        std::fclose(file);
+        file = nullptr;
+        return false;
+    }
+    
+    stopping.store(false);
+    failed.store(false);
+    recorded = 0;
+    writer = std::thread(&JournalWriter::drain, this);
+    return true;
+}
+
+void JournalWriter::record(const JournalEvent& event) {
+    while (!ring.try_push(event)) {
+        std::this_thread::yield();
+    }
+    ++recorded;
+}
+
+void JournalWriter::drain() {
+    std::vector<JournalEvent> batch(WRITE_BATCH);
+    while (true) {
+        // Read the flag first: once it is set every event has been pushed,
+        // so an empty pop after it means the ring is drained
+        bool finishing = stopping.load(std::memory_order_acquire);
+        size_t n = ring.pop_bulk(batch.data(), batch.size());
+        if (n > 0) {
+            if (std::fwrite(batch.data(), sizeof(JournalEvent), n, file) != n) {
+                failed.store(true);
+            }
+        } else if (finishing) {
+            return;
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+}
+
+bool JournalWriter::close() {
+    if (!file) return true;
+    stopping.store(true, std::memory_order_release);
+    writer.join();
+    bool ok = !failed.load() && std::fclose(file) == 0;
+    file = nullptr;
+    return ok;
+}
+
+bool JournalReader::open(const std::string& path) {
+    file.close();
+    file.clear();
+    file.open(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+    const std::streamoff file_size = file.tellg();
+    file.seekg(0);
+    
+    char magic[4];
+    uint32_t record_size = 0;
+    uint32_t label_size = 0;
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, JOURNAL_MAGIC, sizeof(magic)) != 0 ||
+        !file.read(reinterpret_cast<char*>(&record_size), sizeof(record_size)) ||
+        record_size != sizeof(JournalEvent) ||
+        !file.read(reinterpret_cast<char*>(&label_size), sizeof(label_size))) {
+        return false;
+    }
+    // The size comes from the file; a corrupt one must not allocate gigabytes
+    if (static_cast<std::streamoff>(label_size) > file_size - static_cast<std::streamoff>(file.tellg())) {
+        return false;
+    }
+    run_label.resize(label_size);
+    if (label_size > 0 && !file.read(&run_label[0], label_size)) return false;
+    
+    data_offset = file.tellg();
+    std::streamoff bytes = file_size - data_offset;
+    count = bytes > 0 ? static_cast<size_t>(bytes) / sizeof(JournalEvent) : 0;
+    return true;
+}
+
+bool JournalReader::read(size_t index, JournalEvent& event) {
+    if (index >= count) return false;
+    file.clear();
+    file.seekg(data_offset + static_cast<std::streamoff>(index * sizeof(JournalEvent)));
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&event), sizeof(event)));
+}
+
+bool JournalReader::read(size_t first, size_t n, std::vector<JournalEvent>& out) {
+    out.clear();
+    if (first >= count) return true;
+    n = std::min(n, count - first);
+    out.resize(n);
+    file.clear();
+    file.seekg(data_offset + static_cast<std::streamoff>(first * sizeof(JournalEvent)));
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(out.data()),
+                                       static_cast<std::streamsize>(n * sizeof(JournalEvent))));
+}
+
+size_t JournalReader::upper_bound(int64_t time) {
+    size_t low = 0;
+    size_t high = count;
+    JournalEvent event;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (!read(mid, event)) return count;
+        if (event.time <= time) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+JournalReader::State JournalReader::state_at(int64_t time) {
+    State state;
+    
+    // Walk back from `time` until the latest position, regime and fill
+    // events have been seen
+    size_t end = upper_bound(time);
+    std::vector<JournalEvent> batch;
+    while (end > 0 && !(state.has_position && state.has_regime && state.has_fill)) {
+        size_t first = end > SCAN_BATCH ? end - SCAN_BATCH : 0;
+        if (!read(first, end - first, batch)) break;
+        for (size_t i = batch.size(); i-- > 0;) {
+            const JournalEvent& event = batch[i];
+            if (event.type == JournalEvent::POSITION && !state.has_position) {
+                state.position = event.quantity;
+                state.avg_price = event.price;
+                state.cash = event.amount;
+                state.realized_pnl = event.detail;
+                state.has_position = true;
+            } else if (event.type == JournalEvent::REGIME && !state.has_regime) {
+                state.regime = static_cast<Regime>(event.side);
+                state.regime_since = event.time;
+                state.has_regime = true;
+            } else if (event.type == JournalEvent::FILL && !state.has_fill) {
+                state.last_fill = event;
+                state.has_fill = true;
+            }
+        }
+        end = first;
+    }
+    return state;
+}
+
+const char* JournalReader::type_name(uint8_t type) {
+    switch (type) {
+        case JournalEvent::ORDER: return "ORDER";
+        case JournalEvent::FILL: return "FILL";
+        case JournalEvent::POSITION: return "POSITION";
+        case JournalEvent::REGIME: return "REGIME";
+        default: return "UNKNOWN";
+    }
+}
+
+} // namespace fluxback
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "regime/RegimeDetector.h"
+#include "concurrency/SpscRing.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fluxback {
+
+// One journal record. Fixed size, so a journal is a header followed by an
+// array of these and any event can be read by index.
+struct JournalEvent {
+    enum Type : uint8_t { ORDER = 1, FILL = 2, POSITION = 3, REGIME = 4 };
+    
+    uint8_t type = 0;
+    uint8_t side = 0;      // ORDER / FILL: 0 buy, 1 sell; REGIME: the Regime
+    uint16_t reserved = 0;
+    int32_t quantity = 0;  // ORDER / FILL: units; POSITION: signed position
+    uint64_t bar = 0;      // bar index in the run
+    int64_t time = 0;      // bar timestamp, epoch seconds
+    double price = 0.0;    // ORDER: reference price; FILL: fill price; POSITION: average price
+    double amount = 0.0;   // FILL: commission + fees; POSITION: cash
+    double detail = 0.0;   // FILL: slippage; POSITION: realized PnL (gross)
+};
+static_assert(sizeof(JournalEvent) == 48, "journal records are 48 bytes on disk");
+
+// Writes a run's events to a journal file ("FXJ1"). record() only copies
+// the event into a lock-free ring; a background thread drains the ring to
+// the file in batches. When the writer falls behind, record() waits for
+// room rather than dropping events.
+class JournalWriter {
+public:
+    JournalWriter();
+    ~JournalWriter();
+    
+    JournalWriter(const JournalWriter&) = delete;
+    JournalWriter& operator=(const JournalWriter&) = delete;
+    
+    // `label` identifies the run (strategy name, data file)
+    bool open(const std::string& path, const std::string& label);
+    
+    // From the one thread running the backtest
+    void record(const JournalEvent& event);
+    
+    // Flush everything recorded and close; false if any write failed
+    bool close();
+    
+    uint64_t events() const { return recorded; }
+
+private:
+    SpscRing<JournalEvent> ring;
+    std::FILE* file;
+    std::thread writer;
+    std::atomic<bool> stopping;
+    std::atomic<bool> failed;
+    uint64_t recorded;
+    
+    void drain();
+};
+
+// Random access to a journal: binary search by time over the fixed-size
+// records, and the run's state at a timestamp from the last events before
+// it, without re-running the strategy
+class JournalReader {
+public:
+    struct State {
+        int position = 0;
+        double avg_price = 0.0;
+        double cash = 0.0;
+        double realized_pnl = 0.0;
+        bool has_position = false;  // false: no position event yet
+        Regime regime = Regime::SIDEWAYS;
+        int64_t regime_since = 0;
+        bool has_regime = false;
+        JournalEvent last_fill;
+        bool has_fill = false;
+    };
+    
+    bool open(const std::string& path);
+    
+    size_t size() const { return count; }
+    const std::string& label() const { return run_label; }
+    
+    bool read(size_t index, JournalEvent& event);
+    
+    // Events [first, first + count), clipped to the journal
+    bool read(size_t first, size_t count, std::vector<JournalEvent>& out);
+    
+    // Index of the first event later than `time` (size() if none)
+    size_t upper_bound(int64_t time);
+    
+    // State after every event up to and including `time`
+    State state_at(int64_t time);
+    
+    static const char* type_name(uint8_t type);
+
+private:
+    std::ifstream file;
+    std::string run_label;
+    std::streamoff data_offset = 0;
+    size_t count = 0;
+};
+
+} // namespace fluxback
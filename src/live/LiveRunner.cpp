@@ -0,0 +1,201 @@
+#include "live/LiveRunner.h"
+#include "analytics/Analytics.h"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+namespace fluxback {
+
+namespace {
+
+std::atomic<bool> g_live_stop{false};
+
+void on_live_signal(int) {
+    g_live_stop = true;
+}
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // namespace
+
+LiveRunner::LiveRunner(const StrategyConfig& config, const LiveOptions& options, std::FILE* out)
+    : options(options), runner(config), out(out) {
+    runner.set_fill_callback([this](const Fill& fill, Regime regime) { emit_fill(fill, regime); });
+}
+
+void LiveRunner::emit_fill(const Fill& fill, Regime regime) {
+    uint64_t latency = now_ns() - bar_start_ns;
+    const char* side = fill.order.type == Order::BUY ? "BUY" : "SELL";
+    
+    // Timestamps come straight from the input rows, so escape them
+    line.clear();
+    line.append("{\"type\":\"order\",\"timestamp\":").append_json_string(fill.timestamp)
+        .append(",\"side\":\"").append(side).append("\",\"size\":").append_int(fill.order.size)
+        .append(",\"price\":").append_fixed(fill.order.price, 4).append("}\n");
+    
+    line.append("{\"type\":\"fill\",\"timestamp\":").append_json_string(fill.timestamp)
+        .append(",\"side\":\"").append(side).append("\",\"size\":").append_int(fill.filled_size)
+        .append(",\"fill_price\":").append_fixed(fill.fill_price, 4)
+        .append(",\"slippage\":").append_fixed(fill.slippage, 6)
+        .append(",\"regime\":").append_json_string(Analytics::regime_to_string(regime))
+        .append(",\"latency_ns\":").append_int(static_cast<long long>(latency)).append("}\n");
+    std::fwrite(line.str().data(), 1, line.str().size(), out);
+    
+    bar_had_fill = true;
+}
+
+void LiveRunner::process_line(const std::string& line) {
+    if (line.empty() || line.rfind("timestamp", 0) == 0) return; // header
+    
+    bar_start_ns = now_ns();
+    OHLCV bar;
+    if (!DataLoader::parse_line(line, bar)) return;
+    
+    bar_had_fill = false;
+    runner.on_bar(bar);
+    
+    uint64_t latency = now_ns() - bar_start_ns;
+    latency_min_ns = std::min(latency_min_ns, latency);
+    latency_max_ns = std::max(latency_max_ns, latency);
+    latency_total_ns += latency;
+    signal_bars++;
+    
+    // Consumers tail our output, so push signals out as soon as they exist
+    if (bar_had_fill) {
+        std::fflush(out);
+    }
+}
+
+void LiveRunner::print_latency() const {
+    if (signal_bars == 0) return;
+    std::cerr << "Processed " << signal_bars << " bars; bar-to-signal latency (ns): min "
+              << latency_min_ns << ", avg " << latency_total_ns / signal_bars
+              << ", max " << latency_max_ns << "\n";
+}
+
+#ifndef _WIN32
+
+int LiveRunner::read_loop(int fd, bool is_file) {
+    int watch_fd = -1;
+#ifdef __linux__
+    if (is_file && options.follow) {
+        watch_fd = inotify_init1(IN_NONBLOCK);
+        if (watch_fd >= 0 && inotify_add_watch(watch_fd, options.follow_path.c_str(),
+                                               IN_MODIFY | IN_DELETE_SELF | IN_MOVE_SELF) < 0) {
+            ::close(watch_fd);
+            watch_fd = -1;
+        }
+    }
+#endif
+    
+    std::string pending;
+    char buffer[64 * 1024];
+    bool gone = false;
+    bool ended = false; // real end of input, not a stop signal
+    
+    while (!g_live_stop) {
+        ssize_t n = ::read(fd, buffer, sizeof(buffer));
+        if (n > 0) {
+            pending.append(buffer, static_cast<size_t>(n));
+            size_t start = 0;
+            size_t newline;
+            while ((newline = pending.find('\n', start)) != std::string::npos) {
+                size_t end = newline;
+                if (end > start && pending[end - 1] == '\r') end--;
+                process_line(pending.substr(start, end - start));
+                start = newline + 1;
+            }
+            pending.erase(0, start); // keep the partial last row
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        
+        // End of input: a pipe is done, a followed file waits for appends
+        // until it is moved or deleted (after reading what was written)
+        if (!is_file || !options.follow || gone) {
+            ended = true;
+            break;
+        }
+        
+        if (watch_fd >= 0) {
+#ifdef __linux__
+            pollfd p{watch_fd, POLLIN, 0};
+            if (::poll(&p, 1, 200) > 0) {
+                alignas(inotify_event) char events[4096];
+                ssize_t len = ::read(watch_fd, events, sizeof(events));
+                for (ssize_t off = 0; off < len;) {
+                    auto* ev = reinterpret_cast<inotify_event*>(events + off);
+                    if (ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) gone = true;
+                    off += static_cast<ssize_t>(sizeof(inotify_event) + ev->len);
+                }
+            }
+#endif
+        } else {
+            ::usleep(1000);
+        }
+    }
+    
+    // A trailing row without newline is still a complete bar at the end of
+    // input; when a signal stops us mid-append it may be half written
+    if (ended && !pending.empty()) {
+        process_line(pending);
+    }
+    
+    if (watch_fd >= 0) ::close(watch_fd);
+    std::fflush(out);
+    return 0;
+}
+
+int LiveRunner::run() {
+    g_live_stop = false;
+    std::signal(SIGINT, on_live_signal);
+    std::signal(SIGTERM, on_live_signal);
+    
+    int result;
+    if (options.follow_path.empty()) {
+        result = read_loop(STDIN_FILENO, false);
+    } else {
+        int fd = ::open(options.follow_path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Error: Could not open data file: " << options.follow_path << "\n";
+            return 1;
+        }
+        if (!options.from_start) {
+            ::lseek(fd, 0, SEEK_END);
+        }
+        result = read_loop(fd, true);
+        ::close(fd);
+    }
+    
+    print_latency();
+    return result;
+}
+
+#else
+
+int LiveRunner::read_loop(int, bool) {
+    return 1;
+}
+
+int LiveRunner::run() {
+    std::cerr << "Error: live mode is only supported on POSIX systems.\n";
+    return 1;
+}
+
+#endif
+
+} // namespace fluxback
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "analytics/ResultWriter.h"
+#include "engine/BacktestRunner.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace fluxback {
+
+struct LiveOptions {
+    std::string follow_path;    // CSV file to tail; empty reads stdin
+    bool from_start = true;     // replay existing rows before following
+    bool follow = true;         // keep waiting for appended rows at EOF
+};
+
+// Paper-trading mode: feeds bars from a growing CSV file (inotify) or a
+// pipe on stdin through the same BacktestRunner chain as a backtest and
+// writes every order and fill as one JSON object per line.
+class LiveRunner {
+public:
+    LiveRunner(const StrategyConfig& config, const LiveOptions& options, std::FILE* out = stdout);
+    
+    // Run until stdin closes, the followed file disappears or SIGINT
+    int run();
+    
+    size_t get_bar_count() const { return runner.get_tick_count(); }
+
+private:
+    LiveOptions options;
+    BacktestRunner runner;
+    std::FILE* out;
+    OutputBuffer line{4096}; // reused NDJSON scratch, never attached to a file
+    
+    // Latency from bar arrival (line complete) to signals emitted
+    uint64_t bar_start_ns = 0;
+    uint64_t latency_min_ns = UINT64_MAX;
+    uint64_t latency_max_ns = 0;
+    uint64_t latency_total_ns = 0;
+    size_t signal_bars = 0;
+    bool bar_had_fill = false;
+    
+    void process_line(const std::string& line);
+    void emit_fill(const Fill& fill, Regime regime);
+    void print_latency() const;
+    
+    int read_loop(int fd, bool is_file);
+};
+
+} // namespace fluxback
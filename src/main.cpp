@@ -3,25 +3,54 @@
 #include <vector>
 #include <fstream>
 #include <iomanip>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <thread>
 #include "data/DataLoader.h"
+#include "data/BarStore.h"
 #include "indicators/IndicatorEngine.h"
 #include "strategy/StrategyEngine.h"
 #include "execution/ExecutionSimulator.h"
 #include "analytics/Analytics.h"
 #include "regime/RegimeDetector.h"
+#include "regime/RegimeModel.h"
 #include "utils/ConfigParser.h"
+#include "engine/BacktestRunner.h"
+#include "engine/BacktestPipeline.h"
+#include "analytics/ResultWriter.h"
+#include "analytics/ResultStats.h"
+#include "analytics/MonteCarlo.h"
+#include "engine/SweepRunner.h"
+#include "server/BacktestServer.h"
+#include "live/LiveRunner.h"
+#include "utils/Timestamp.h"
+#include "journal/RunJournal.h"
 
 using namespace fluxback;
 
 void print_usage() {
     std::cout << "FluxBack - Regime-Aware C++ Backtesting Engine\n\n";
     std::cout << "Usage:\n";
-    std::cout << "  fluxback run --strategy <yaml> --data <csv> [--out <json>]\n";
-    std::cout << "  fluxback benchmark --strategy <yaml> --data <csv> [--parallel <n>]\n";
-    std::cout << "  fluxback stats --results <json>\n\n";
+    std::cout << "  fluxback run --strategy <yaml> --data <csv> [--out <json|fxr>] [--parallel <n>]\n";
+    std::cout << "               [--from <date>] [--to <date>] [--journal <fxj>] [--pipeline]\n";
+    std::cout << "  fluxback replay --journal <fxj> [--at <timestamp>] [--events <n>]\n";
+    std::cout << "  fluxback benchmark --strategy <yaml> --data <csv> [--parallel <n>] [--no-cache] [--persist-cache] [--export <dir>]\n";
+    std::cout << "                     [--wide] [--tiled]\n";
+    std::cout << "  fluxback stats --results <file|dir> [--top <n>] [--sort sharpe|return|drawdown] [--parallel <n>]\n";
+    std::cout << "  fluxback montecarlo --strategy <yaml> --data <csv> [--paths <n>] [--mode trades|returns]\n";
+    std::cout << "                      [--block <n>] [--parallel <n>] [--seed <n>] [--ruin-pct <pct>]\n";
+    std::cout << "  fluxback serve [--port <n>] [--socket <path>] [--workers <n>] [--data-root <dir>]\n";
+    std::cout << "                 [--allow-origin <origin>]\n";
+    std::cout << "  fluxback live --strategy <yaml> [--follow <csv>] [--from-end] [--no-follow]\n";
+    std::cout << "  fluxback convert --data <csv> --out <fxb> [--block <bars>]\n";
+    std::cout << "  fluxback fit-regimes --data <csv> --out <model> [--parallel <n>] [--iterations <n>]\n\n";
     std::cout << "Examples:\n";
     std::cout << "  fluxback run --strategy config/sma_demo.yaml --data demo/RELIANCE_1m.csv --out results/sma_demo.json\n";
-    std::cout << "  fluxback stats --results results/sma_demo.json\n";
+    std::cout << "  fluxback stats --results results/sweep/\n";
 }
 
 void print_summary(const BacktestSummary& summary) {
@@ -42,6 +71,18 @@ void print_summary(const BacktestSummary& summary) {
     std::cout << "Avg Loss:         $" << summary.avg_loss_pct << "\n";
     std::cout << "Profit Factor:    " << std::setprecision(4) << summary.profit_factor << "\n";
     
+    double costs = summary.commission + summary.exchange_fees + summary.borrow_cost + summary.financing_cost;
+    if (costs > 0.0) {
+        std::cout << "\n=== Trading Costs ===\n" << std::setprecision(2);
+        std::cout << "Commission:       $" << summary.commission << "\n";
+        std::cout << "Exchange Fees:    $" << summary.exchange_fees << "\n";
+        std::cout << "Borrow:           $" << summary.borrow_cost << "\n";
+        std::cout << "Financing:        $" << summary.financing_cost << "\n";
+    }
+    if (summary.vwap_shortfall_bps != 0.0) {
+        std::cout << "VWAP Shortfall:   " << std::setprecision(2) << summary.vwap_shortfall_bps << " bps\n";
+    }
+    
     if (!summary.trades_by_regime.empty()) {
         std::cout << "\n=== Per-Regime Statistics ===\n";
         for (const auto& [regime, count] : summary.trades_by_regime) {
@@ -57,7 +98,46 @@ void print_summary(const BacktestSummary& summary) {
     }
 }
 
-int run_backtest(const std::string& strategy_path, const std::string& data_path, const std::string& output_path) {
+// Parse a --from/--to bound; a bare date as the upper bound covers the whole day
+bool parse_range_bound(const std::string& text, bool upper, int64_t& epoch) {
+    if (!parse_timestamp(text, epoch)) {
+        std::cerr << "Error: Invalid date: " << text << " (expected YYYY-MM-DD[ HH:MM[:SS]])\n";
+        return false;
+    }
+    if (upper && text.size() == 10 && text[4] == '-') epoch += 86399;
+    return true;
+}
+
+// Monte Carlo keeps per-path metrics in memory, so bound the path count
+const uint64_t MAX_MC_PATHS = 10000000;
+const uint64_t MAX_MC_THREADS = 1024;
+
+// Parse a whole-number option within [min, max]
+bool parse_count(const char* option, const char* text, uint64_t min, uint64_t max, uint64_t& value) {
+    const char* end = text + std::strlen(text);
+    auto [ptr, ec] = std::from_chars(text, end, value);
+    if (ec != std::errc() || ptr != end || value < min || value > max) {
+        std::cerr << "Error: " << option << " expects a whole number from " << min << " to " << max
+                  << ", got '" << text << "'\n";
+        return false;
+    }
+    return true;
+}
+
+// Parse a percentage option in (0, 100]
+bool parse_percent(const char* option, const char* text, double& value) {
+    const char* end = text + std::strlen(text);
+    auto [ptr, ec] = std::from_chars(text, end, value);
+    if (ec != std::errc() || ptr != end || !(value > 0.0 && value <= 100.0)) {
+        std::cerr << "Error: " << option << " expects a percentage above 0 and up to 100, got '" << text << "'\n";
+        return false;
+    }
+    return true;
+}
+
+int run_backtest(const std::string& strategy_path, const std::string& data_path, const std::string& output_path,
+                 int load_threads, bool pipeline, const std::string& from, const std::string& to,
+                 const std::string& journal_path) {
     // Load configuration
     StrategyConfig config = ConfigParser::parse_yaml(strategy_path);
     if (config.name.empty()) {
@@ -72,67 +152,87 @@ int run_backtest(const std::string& strategy_path, const std::string& data_path,
         return 1;
     }
     
-    IndicatorEngine indicators;
-    StrategyEngine strategy(config);
-    ExecutionSimulator executor(config);
-    RegimeDetector regime_detector;
-    Analytics analytics;
+    if (!from.empty() || !to.empty()) {
+        int64_t from_epoch = std::numeric_limits<int64_t>::min();
+        int64_t to_epoch = std::numeric_limits<int64_t>::max();
+        if ((!from.empty() && !parse_range_bound(from, false, from_epoch)) ||
+            (!to.empty() && !parse_range_bound(to, true, to_epoch))) {
+            return 1;
+        }
+        loader.set_range(from_epoch, to_epoch);
+    }
     
-    executor.reset(100000.0); // Initial cash
-    analytics.reset();
+    BacktestRunner runner(config);
+    JournalWriter journal;
+    if (!journal_path.empty()) {
+        if (!journal.open(journal_path, config.name + " " + data_path)) {
+            std::cerr << "Error: Could not write journal: " << journal_path << "\n";
+            return 1;
+        }
+        runner.attach_journal(&journal);
+    }
     
     std::cout << "Running backtest: " << config.name << "\n";
     std::cout << "Data file: " << data_path << "\n";
     std::cout << "Processing ticks...\n";
     
-    size_t tick_count = 0;
-    
     // Main event loop
-    while (loader.has_next()) {
-        OHLCV tick = loader.next();
-        if (tick.close <= 0.0) continue; // Skip invalid ticks
-        
-        tick_count++;
-        
-        // Update indicators
-        indicators.add_price(tick.close, tick.volume);
-        
-        // Update regime detector
-        Regime current_regime = regime_detector.update_and_get(tick);
-
-        // Skip trading in volatile regime if configured
-        if (config.exclude_volatile_regime && current_regime == Regime::VOLATILE) {
-            continue;
+    size_t bad_rows = 0;
+    if (pipeline) {
+        // Read, parse and regime labelling run ahead on their own threads
+        BacktestPipeline stages(runner);
+        stages.run(loader);
+        bad_rows = stages.bad_rows();
+    } else if (load_threads > 1) {
+        // Parse the whole file on several threads first, then replay it
+        for (const auto& bar : loader.load_all(load_threads)) {
+            runner.on_bar(bar);
         }
-        
-        // Get strategy signals
-        std::vector<Order> orders = strategy.on_tick(tick, indicators);
-        
-        // Execute orders
-        for (const auto& order : orders) {
-            double realized_vol = indicators.get_realized_vol(20);
-            Fill fill = executor.execute(order, tick, realized_vol);
+    } else {
+        while (loader.has_next()) {
+            if (!runner.on_bar(loader.next())) continue;
             
-            // Record fill in analytics
-            double position_value = executor.get_position().size * tick.close;
-            analytics.record_fill(fill, current_regime, executor.get_cash(), position_value);
-        }
-        
-        // Progress indicator
-        if (tick_count % 1000 == 0) {
-            std::cout << "Processed " << tick_count << " ticks...\n";
+            // Progress indicator
+            if (runner.get_tick_count() % 1000 == 0) {
+                std::cout << "Processed " << runner.get_tick_count() << " ticks...\n";
+            }
         }
     }
     
+    size_t tick_count = runner.get_tick_count();
+    const Analytics& analytics = runner.get_analytics();
+    
     std::cout << "Completed processing " << tick_count << " ticks.\n";
+    bad_rows += loader.get_bad_rows();
+    if (bad_rows > 0) {
+        std::cout << "Skipped " << bad_rows << " malformed rows.\n";
+    }
+    if (!journal_path.empty()) {
+        if (!journal.close()) {
+            std::cerr << "Error: Failed writing journal: " << journal_path << "\n";
+            return 1;
+        }
+        std::cout << "Journal: " << journal.events() << " events written to " << journal_path << "\n";
+    }
     
     // Generate summary
     BacktestSummary summary = analytics.summary();
     print_summary(summary);
+    if (config.risk.enabled()) {
+        const RiskManager& risk = runner.get_risk();
+        std::cout << "Risk: " << risk.resized_entries() << " entries resized, "
+                  << risk.rejected_entries() << " rejected"
+                  << (risk.halted() ? ", drawdown kill switch tripped" : "") << "\n";
+    }
     
     // Export results
     if (!output_path.empty()) {
-        analytics.export_summary_json(output_path);
+        bool binary = output_path.size() > 4 && output_path.compare(output_path.size() - 4, 4, ".fxr") == 0;
+        if (binary) {
+            analytics.export_binary(output_path);
+        } else {
+            analytics.export_summary_json(output_path);
+        }
         
         // Export trade log to CSV (same directory, different extension)
         std::string trade_log_path = output_path;
@@ -151,26 +251,336 @@ int run_backtest(const std::string& strategy_path, const std::string& data_path,
     return 0;
 }
 
-int benchmark_mode(const std::string& strategy_path, const std::string& data_path, int parallel) {
-    std::cout << "Benchmark mode not yet implemented.\n";
-    std::cout << "This would run parameter sweeps with " << parallel << " parallel threads.\n";
+void print_journal_event(const JournalEvent& event) {
+    std::cout << "  " << format_timestamp(event.time) << "  bar " << event.bar << "  "
+              << JournalReader::type_name(event.type);
+    switch (event.type) {
+        case JournalEvent::ORDER:
+            std::cout << " " << (event.side == 0 ? "BUY" : "SELL") << " " << event.quantity << " @ " << event.price;
+            break;
+        case JournalEvent::FILL:
+            std::cout << " " << (event.side == 0 ? "BUY" : "SELL") << " " << event.quantity << " @ " << event.price
+                      << " (slippage " << event.detail << ", costs " << event.amount << ")";
+            break;
+        case JournalEvent::POSITION:
+            std::cout << " " << event.quantity << " @ " << event.price << ", cash " << event.amount;
+            break;
+        case JournalEvent::REGIME:
+            std::cout << " " << Analytics::regime_to_string(static_cast<Regime>(event.side));
+            break;
+    }
+    std::cout << "\n";
+}
+
+int replay_journal(const std::string& journal_path, const std::string& at, size_t context) {
+    JournalReader reader;
+    if (!reader.open(journal_path)) {
+        std::cerr << "Error: Could not read journal: " << journal_path << "\n";
+        return 1;
+    }
+    
+    std::cout << "Journal: " << reader.label() << " (" << reader.size() << " events)\n";
+    if (reader.size() == 0) return 0;
+    
+    JournalEvent first, last;
+    reader.read(0, first);
+    reader.read(reader.size() - 1, last);
+    int64_t time = last.time;
+    if (!at.empty() && !parse_range_bound(at, true, time)) return 1;
+    std::cout << "Span: " << format_timestamp(first.time) << " .. " << format_timestamp(last.time) << "\n";
+    
+    auto start = std::chrono::steady_clock::now();
+    JournalReader::State state = reader.state_at(time);
+    size_t position = reader.upper_bound(time);
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "\n=== State at " << format_timestamp(time) << " ===\n";
+    if (state.has_position) {
+        std::cout << "Position:         " << state.position << " @ " << state.avg_price << "\n";
+        std::cout << "Cash:             $" << state.cash << "\n";
+        std::cout << "Realized PnL:     $" << state.realized_pnl << "\n";
+    } else {
+        std::cout << "Position:         flat, no fills yet\n";
+    }
+    if (state.has_regime) {
+        std::cout << "Regime:           " << Analytics::regime_to_string(state.regime) << " since "
+                  << format_timestamp(state.regime_since) << "\n";
+    }
+    if (state.has_fill) {
+        std::cout << "Last fill:        " << format_timestamp(state.last_fill.time) << "\n";
+    }
+    std::cout << "Rebuilt in " << std::setprecision(3) << elapsed << " ms\n" << std::setprecision(2);
+    
+    // Events leading up to the timestamp and just after it
+    std::vector<JournalEvent> events;
+    size_t begin = position > context ? position - context : 0;
+    reader.read(begin, position - begin + context, events);
+    std::cout << "\n=== Events ===\n";
+    for (size_t i = 0; i < events.size(); ++i) {
+        if (begin + i == position) std::cout << "  ---- " << format_timestamp(time) << " ----\n";
+        print_journal_event(events[i]);
+    }
+    return 0;
+}
+
+int convert_data(const std::string& data_path, const std::string& output_path, size_t block_bars) {
+    DataLoader loader(data_path);
+    if (!loader.is_valid()) {
+        std::cerr << "Error: Could not open data file: " << data_path << "\n";
+        return 1;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    std::vector<OHLCV> bars = loader.load_all();
+    if (!BarStore::write(output_path, bars, block_bars)) {
+        return 1;
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::error_code ec;
+    double in_bytes = static_cast<double>(std::filesystem::file_size(data_path, ec));
+    double out_bytes = static_cast<double>(std::filesystem::file_size(output_path, ec));
+    std::cout << "Converted " << bars.size() << " bars in " << std::fixed << std::setprecision(2)
+              << elapsed << "s\n";
+    std::cout << "  " << data_path << ": " << in_bytes / 1e6 << " MB\n";
+    std::cout << "  " << output_path << ": " << out_bytes / 1e6 << " MB ("
+              << (out_bytes > 0 ? in_bytes / out_bytes : 0.0) << "x smaller)\n";
+    if (loader.get_bad_rows() > 0) {
+        std::cout << "Skipped " << loader.get_bad_rows() << " malformed rows.\n";
+    }
+    return 0;
+}
+
+int fit_regimes(const std::string& data_path, const std::string& output_path, int parallel, int iterations) {
+    DataLoader loader(data_path);
+    if (!loader.is_valid()) {
+        std::cerr << "Error: Could not open data file: " << data_path << "\n";
+        return 1;
+    }
+    std::vector<OHLCV> bars = loader.load_all();
+    
+    auto start = std::chrono::steady_clock::now();
+    RegimeModel model;
+    if (!model.fit(bars, parallel, iterations)) {
+        std::cerr << "Error: Not enough bars to fit a regime model.\n";
+        return 1;
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!model.save(output_path)) {
+        std::cerr << "Error: Could not write regime model: " << output_path << "\n";
+        return 1;
+    }
+    
+    std::cout << "Fitted " << REGIME_STATES << " regimes to " << model.points() << " bars in "
+              << model.iterations() << " iterations (" << std::fixed << std::setprecision(2)
+              << elapsed << "s, " << parallel << " thread(s))\n";
+    for (size_t k = 0; k < REGIME_STATES; ++k) {
+        double share = 100.0 * model.weight[k] / static_cast<double>(model.points());
+        std::cout << "  " << std::left << std::setw(9) << Analytics::regime_to_string(model.label[k])
+                  << std::right << std::setw(6) << share << "% of bars, vol "
+                  << std::setprecision(5) << model.mean[k][0] * model.scale[0] + model.shift[0]
+                  << ", stays " << std::setprecision(1) << 100.0 * model.transition[k][k] << "%\n"
+                  << std::setprecision(2);
+    }
+    std::cout << "Use it with  regime: { model: hmm | kmeans, model_path: " << output_path << " }\n";
+    return 0;
+}
+
+int benchmark_mode(const std::string& strategy_path, const std::string& data_path, int parallel,
+                   bool use_cache, bool persist_cache, const std::string& export_dir, bool wide,
+                   bool tiled) {
+    auto spec = ConfigParser::load_grid(strategy_path);
+    if (!spec || spec->base.name.empty()) {
+        std::cerr << "Error: Failed to parse strategy configuration.\n";
+        return 1;
+    }
+    
+    DataLoader loader(data_path);
+    if (!loader.is_valid()) {
+        std::cerr << "Error: Could not open data file: " << data_path << "\n";
+        return 1;
+    }
+    std::vector<OHLCV> bars = loader.load_all();
+    // Lists and ranges in the config define the grid; without them, sweep
+    // the exits around it
+    std::vector<StrategyConfig> grid = spec->axes.empty() ? SweepRunner::exit_grid(spec->base)
+                                                          : spec->expand();
+    auto label_of = [&spec, &grid](size_t index) {
+        return spec->axes.empty() ? SweepRunner::label(grid[index]) : spec->label(index);
+    };
+    
+    std::cout << "Sweep: " << grid.size() << " runs over " << bars.size()
+              << " bars with " << parallel << " thread(s)\n";
+    
+    // Indicators depend only on the data and entry windows, so every run
+    // in the exit grid shares one precomputed cache
+    IndicatorCache cache;
+    if (use_cache) {
+        auto cache_start = std::chrono::steady_clock::now();
+        std::string sidecar = IndicatorCache::sidecar_path(data_path);
+        bool loaded = persist_cache && cache.load(sidecar, data_path, bars.size());
+        if (!loaded) {
+            cache = IndicatorCache();
+        }
+        for (const auto& cfg : grid) {
+            cache.prepare(bars, cfg, parallel);
+        }
+        if (persist_cache && !loaded) {
+            cache.save(sidecar, data_path);
+        }
+        double cache_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - cache_start).count();
+        std::cout << "Indicator cache " << (loaded ? "loaded" : "built") << " in "
+                  << std::fixed << std::setprecision(2) << cache_ms << " ms\n";
+    }
+    
+    SweepRunner sweep(bars, use_cache ? &cache : nullptr);
+    sweep.set_wide(wide && use_cache);
+    sweep.set_tiled(tiled);
+    
+    // Per-run result files are written on a background thread while the
+    // workers move on to the next run
+    AsyncExporter exporter;
+    if (!export_dir.empty()) {
+        std::filesystem::create_directories(export_dir);
+        sweep.set_result_callback([&exporter, &export_dir, &label_of](size_t index, const SweepResult& result,
+                                                                      const Analytics& analytics) {
+            std::string path = export_dir + "/run_" + std::to_string(index) + ".fxr";
+            exporter.submit([path, summary = result.summary, trades = analytics.get_trades(),
+                             label = label_of(index)]() {
+                ResultWriter::write_binary(path, summary, trades, label);
+            });
+        });
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    std::vector<SweepResult> results = sweep.run(grid, parallel);
+    exporter.wait();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << "Completed " << results.size() << " runs in " << std::fixed << std::setprecision(3)
+              << elapsed << " s (" << std::setprecision(1)
+              << (elapsed > 0.0 ? results.size() / elapsed : 0.0) << " runs/sec)\n";
+    const ArenaStats& arena = sweep.arena_stats();
+    std::cout << "Arena: " << arena.allocations << " allocations over " << arena.runs << " runs in "
+              << arena.resets << " batches, " << std::setprecision(2) << arena.high_water_bytes / 1e6
+              << " MB peak per batch, "
+              << arena.upstream_allocations << " heap blocks\n";
+    
+    auto best = std::max_element(results.begin(), results.end(),
+        [](const SweepResult& a, const SweepResult& b) {
+            return a.summary.sharpe_ratio < b.summary.sharpe_ratio;
+        });
+    if (best != results.end()) {
+        std::cout << "Best Sharpe: " << std::setprecision(4) << best->summary.sharpe_ratio
+                  << " (" << label_of(static_cast<size_t>(best - results.begin()))
+                  << ", return=" << std::setprecision(2) << best->summary.total_return_pct << "%)\n";
+    }
+    return 0;
+}
+
+int stats_mode(const std::string& results_path, size_t top_n, int parallel, const std::string& sort_key) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::string> files = ResultStats::collect_files(results_path);
+    if (files.empty()) {
+        std::cerr << "Error: No result files found at: " << results_path << "\n";
+        return 1;
+    }
+    
+    size_t failed = 0;
+    std::vector<ResultRecord> records = ResultStats::load(files, parallel, &failed);
+    double elapsed_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << "Loaded " << records.size() << " result file(s) from " << results_path
+              << " in " << std::fixed << std::setprecision(1) << elapsed_ms << " ms";
+    if (failed > 0) {
+        std::cout << " (" << failed << " unreadable)";
+    }
+    std::cout << "\n";
+    if (records.empty()) return 1;
+    
+    ResultStats::print_report(records, top_n, sort_key);
     return 0;
 }
 
-int stats_mode(const std::string& results_path) {
-    std::ifstream file(results_path);
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open results file: " << results_path << "\n";
+void print_interval(const char* name, const ConfidenceInterval& ci) {
+    std::cout << std::left << std::setw(18) << name << std::right << std::fixed << std::setprecision(4)
+              << std::setw(12) << ci.p5 << std::setw(12) << ci.p50 << std::setw(12) << ci.p95
+              << std::setw(12) << ci.mean << "\n";
+}
+
+int montecarlo_mode(const std::string& strategy_path, const std::string& data_path,
+                    MonteCarloConfig mc_config, const std::string& mode) {
+    StrategyConfig config = ConfigParser::parse_yaml(strategy_path);
+    if (config.name.empty()) {
+        std::cerr << "Error: Failed to parse strategy configuration.\n";
         return 1;
     }
     
-    std::cout << "Reading results from: " << results_path << "\n";
-    std::string line;
-    while (std::getline(file, line)) {
-        std::cout << line << "\n";
+    DataLoader loader(data_path);
+    if (!loader.is_valid()) {
+        std::cerr << "Error: Could not open data file: " << data_path << "\n";
+        return 1;
     }
-    file.close();
     
+    BacktestRunner runner(config);
+    while (loader.has_next()) {
+        runner.on_bar(loader.next());
+    }
+    BacktestSummary summary = runner.summary();
+    mc_config.initial_cash = summary.initial_cash;
+    
+    std::vector<double> samples;
+    if (mode == "returns") {
+        const auto& curve = summary.equity_curve;
+        for (size_t i = 1; i < curve.size(); ++i) {
+            if (curve[i - 1].second > 0.0) {
+                samples.push_back(curve[i].second / curve[i - 1].second - 1.0);
+            }
+        }
+    } else {
+        for (const auto& trade : runner.get_analytics().get_trades()) {
+            samples.push_back(trade.pnl);
+        }
+    }
+    if (samples.empty()) {
+        std::cerr << "Error: Backtest produced no " << mode << " to resample.\n";
+        return 1;
+    }
+    // Annualize at the rate samples arrived over the run
+    double years = runner.get_calendar().years();
+    if (years > 0.0) {
+        mc_config.periods_per_year = samples.size() / years;
+    }
+    
+    std::cout << "Monte Carlo: " << mc_config.paths << " paths x " << samples.size() << " " << mode
+              << " (block " << mc_config.block_size << ", " << mc_config.threads << " thread(s), seed "
+              << mc_config.seed << ")\n";
+    
+    auto start = std::chrono::steady_clock::now();
+    MonteCarloResult result = (mode == "returns")
+        ? MonteCarlo::bootstrap_returns(samples, mc_config)
+        : MonteCarlo::bootstrap_trades(samples, mc_config);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << "\n=== Backtest (point estimate) ===\n";
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << "Total Return:     " << summary.total_return_pct << "%\n";
+    std::cout << "Sharpe Ratio:     " << summary.sharpe_ratio << "\n";
+    std::cout << "Max Drawdown:     " << summary.max_drawdown_pct << "%\n";
+    
+    std::cout << "\n=== Monte Carlo Confidence Intervals ===\n";
+    std::cout << std::left << std::setw(18) << "Metric" << std::right << std::setw(12) << "P5"
+              << std::setw(12) << "Median" << std::setw(12) << "P95" << std::setw(12) << "Mean" << "\n";
+    print_interval("Total Return %", result.total_return_pct);
+    print_interval("Sharpe Ratio", result.sharpe_ratio);
+    print_interval("Max Drawdown %", result.max_drawdown_pct);
+    std::cout << "Risk of Ruin (" << std::setprecision(1) << mc_config.ruin_pct << "% loss): "
+              << std::setprecision(4) << result.risk_of_ruin_pct << "%\n";
+    std::cout << "\nCompleted in " << std::setprecision(3) << elapsed << " s ("
+              << std::setprecision(0) << (elapsed > 0.0 ? result.paths / elapsed : 0.0) << " paths/sec)\n";
     return 0;
 }
 
@@ -183,7 +593,9 @@ int main(int argc, char** argv) {
     std::string command = argv[1];
     
     if (command == "run") {
-        std::string strategy_path, data_path, output_path;
+        std::string strategy_path, data_path, output_path, from, to, journal_path;
+        int load_threads = 1;
+        bool pipeline = false;
         
         for (int i = 2; i < argc; i++) {
             std::string arg = argv[i];
@@ -193,6 +605,16 @@ int main(int argc, char** argv) {
                 data_path = argv[++i];
             } else if (arg == "--out" && i + 1 < argc) {
                 output_path = argv[++i];
+            } else if (arg == "--parallel" && i + 1 < argc) {
+                load_threads = std::stoi(argv[++i]);
+            } else if (arg == "--from" && i + 1 < argc) {
+                from = argv[++i];
+            } else if (arg == "--to" && i + 1 < argc) {
+                to = argv[++i];
+            } else if (arg == "--journal" && i + 1 < argc) {
+                journal_path = argv[++i];
+            } else if (arg == "--pipeline") {
+                pipeline = true;
             }
         }
         
@@ -202,11 +624,39 @@ int main(int argc, char** argv) {
             return 1;
         }
         
-        return run_backtest(strategy_path, data_path, output_path);
+        return run_backtest(strategy_path, data_path, output_path, load_threads, pipeline, from, to, journal_path);
+        
+    } else if (command == "replay") {
+        std::string journal_path, at;
+        size_t context = 10;
+        
+        for (int i = 2; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--journal" && i + 1 < argc) {
+                journal_path = argv[++i];
+            } else if (arg == "--at" && i + 1 < argc) {
+                at = argv[++i];
+            } else if (arg == "--events" && i + 1 < argc) {
+                context = static_cast<size_t>(std::stoull(argv[++i]));
+            }
+        }
+        
+        if (journal_path.empty()) {
+            std::cerr << "Error: --journal is required.\n";
+            print_usage();
+            return 1;
+        }
+        
+        return replay_journal(journal_path, at, context);
         
     } else if (command == "benchmark") {
         std::string strategy_path, data_path;
         int parallel = 1;
+        bool use_cache = true;
+        bool persist_cache = false;
+        bool wide = false;
+        bool tiled = false;
+        std::string export_dir;
         
         for (int i = 2; i < argc; i++) {
             std::string arg = argv[i];
@@ -216,6 +666,16 @@ int main(int argc, char** argv) {
                 data_path = argv[++i];
             } else if (arg == "--parallel" && i + 1 < argc) {
                 parallel = std::stoi(argv[++i]);
+            } else if (arg == "--no-cache") {
+                use_cache = false;
+            } else if (arg == "--persist-cache") {
+                persist_cache = true;
+            } else if (arg == "--wide") {
+                wide = true;
+            } else if (arg == "--tiled") {
+                tiled = true;
+            } else if (arg == "--export" && i + 1 < argc) {
+                export_dir = argv[++i];
             }
         }
         
@@ -225,15 +685,24 @@ int main(int argc, char** argv) {
             return 1;
         }
         
-        return benchmark_mode(strategy_path, data_path, parallel);
+        return benchmark_mode(strategy_path, data_path, parallel, use_cache, persist_cache, export_dir, wide, tiled);
         
     } else if (command == "stats") {
         std::string results_path;
+        std::string sort_key = "sharpe";
+        size_t top_n = 10;
+        int parallel = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
         
         for (int i = 2; i < argc; i++) {
             std::string arg = argv[i];
             if (arg == "--results" && i + 1 < argc) {
                 results_path = argv[++i];
+            } else if (arg == "--top" && i + 1 < argc) {
+                top_n = static_cast<size_t>(std::stoul(argv[++i]));
+            } else if (arg == "--parallel" && i + 1 < argc) {
+                parallel = std::stoi(argv[++i]);
+            } else if (arg == "--sort" && i + 1 < argc) {
+                sort_key = argv[++i];
             }
         }
         
@@ -243,7 +712,157 @@ int main(int argc, char** argv) {
             return 1;
         }
         
-        return stats_mode(results_path);
+        return stats_mode(results_path, top_n, parallel, sort_key);
+        
+    } else if (command == "montecarlo") {
+        std::string strategy_path, data_path;
+        std::string mode = "trades";
+        MonteCarloConfig mc_config;
+        mc_config.threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        
+        for (int i = 2; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--strategy" && i + 1 < argc) {
+                strategy_path = argv[++i];
+            } else if (arg == "--data" && i + 1 < argc) {
+                data_path = argv[++i];
+            } else if (arg == "--paths" && i + 1 < argc) {
+                uint64_t paths = 0;
+                if (!parse_count("--paths", argv[++i], 1, MAX_MC_PATHS, paths)) return 1;
+                mc_config.paths = static_cast<size_t>(paths);
+            } else if (arg == "--block" && i + 1 < argc) {
+                uint64_t block = 0;
+                if (!parse_count("--block", argv[++i], 1, std::numeric_limits<size_t>::max(), block)) return 1;
+                mc_config.block_size = static_cast<size_t>(block);
+            } else if (arg == "--parallel" && i + 1 < argc) {
+                uint64_t threads = 0;
+                if (!parse_count("--parallel", argv[++i], 1, MAX_MC_THREADS, threads)) return 1;
+                mc_config.threads = static_cast<int>(threads);
+            } else if (arg == "--seed" && i + 1 < argc) {
+                if (!parse_count("--seed", argv[++i], 0, std::numeric_limits<uint64_t>::max(), mc_config.seed)) {
+                    return 1;
+                }
+            } else if (arg == "--ruin-pct" && i + 1 < argc) {
+                if (!parse_percent("--ruin-pct", argv[++i], mc_config.ruin_pct)) return 1;
+            } else if (arg == "--mode" && i + 1 < argc) {
+                mode = argv[++i];
+            }
+        }
+        
+        if (strategy_path.empty() || data_path.empty()) {
+            std::cerr << "Error: --strategy and --data are required.\n";
+            print_usage();
+            return 1;
+        }
+        if (mode != "trades" && mode != "returns") {
+            std::cerr << "Error: --mode must be 'trades' or 'returns'.\n";
+            return 1;
+        }
+        
+        return montecarlo_mode(strategy_path, data_path, mc_config, mode);
+        
+    } else if (command == "serve") {
+        ServerOptions options;
+        
+        for (int i = 2; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--port" && i + 1 < argc) {
+                options.port = std::stoi(argv[++i]);
+            } else if (arg == "--socket" && i + 1 < argc) {
+                options.socket_path = argv[++i];
+            } else if (arg == "--workers" && i + 1 < argc) {
+                options.workers = std::stoi(argv[++i]);
+            } else if (arg == "--data-root" && i + 1 < argc) {
+                options.data_root = argv[++i];
+            } else if (arg == "--allow-origin" && i + 1 < argc) {
+                options.allowed_origin = argv[++i];
+            }
+        }
+        
+        BacktestServer server(options);
+        return server.run();
+        
+    } else if (command == "live") {
+        std::string strategy_path;
+        LiveOptions options;
+        
+        for (int i = 2; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--strategy" && i + 1 < argc) {
+                strategy_path = argv[++i];
+            } else if (arg == "--follow" && i + 1 < argc) {
+                options.follow_path = argv[++i];
+            } else if (arg == "--from-end") {
+                options.from_start = false;
+            } else if (arg == "--no-follow") {
+                options.follow = false;
+            }
+        }
+        
+        if (strategy_path.empty()) {
+            std::cerr << "Error: --strategy is required.\n";
+            print_usage();
+            return 1;
+        }
+        
+        StrategyConfig config = ConfigParser::parse_yaml(strategy_path);
+        if (config.name.empty()) {
+            std::cerr << "Error: Failed to parse strategy configuration.\n";
+            return 1;
+        }
+        
+        // stdout carries the NDJSON signal stream; diagnostics go to stderr
+        LiveRunner live(config, options);
+        return live.run();
+        
+    } else if (command == "convert") {
+        std::string data_path, output_path;
+        size_t block_bars = BarStore::DEFAULT_BLOCK_BARS;
+        
+        for (int i = 2; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--data" && i + 1 < argc) {
+                data_path = argv[++i];
+            } else if (arg == "--out" && i + 1 < argc) {
+                output_path = argv[++i];
+            } else if (arg == "--block" && i + 1 < argc) {
+                block_bars = static_cast<size_t>(std::stoull(argv[++i]));
+            }
+        }
+        
+        if (data_path.empty() || output_path.empty()) {
+            std::cerr << "Error: --data and --out are required.\n";
+            print_usage();
+            return 1;
+        }
+        
+        return convert_data(data_path, output_path, block_bars);
+        
+    } else if (command == "fit-regimes") {
+        std::string data_path, output_path;
+        int parallel = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        int iterations = 50;
+        
+        for (int i = 2; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--data" && i + 1 < argc) {
+                data_path = argv[++i];
+            } else if (arg == "--out" && i + 1 < argc) {
+                output_path = argv[++i];
+            } else if (arg == "--parallel" && i + 1 < argc) {
+                parallel = std::stoi(argv[++i]);
+            } else if (arg == "--iterations" && i + 1 < argc) {
+                iterations = std::stoi(argv[++i]);
+            }
+        }
+        
+        if (data_path.empty() || output_path.empty()) {
+            std::cerr << "Error: --data and --out are required.\n";
+            print_usage();
+            return 1;
+        }
+        
+        return fit_regimes(data_path, output_path, parallel, iterations);
         
     } else {
         std::cerr << "Error: Unknown command: " << command << "\n\n";
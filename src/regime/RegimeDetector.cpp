@@ -1,11 +1,25 @@
 #include "regime/RegimeDetector.h"
+#include "regime/RegimeModel.h"
+#include "concurrency/ThreadPool.h"
 #include <numeric>
 #include <algorithm>
 
 namespace fluxback {
 
-RegimeDetector::RegimeDetector(int lookback_window)
-    : lookback_window(lookback_window), current_regime(Regime::SIDEWAYS) {
+bool parse_regime_backend(const std::string& name, RegimeBackend& backend) {
+    if (name == "threshold") backend = RegimeBackend::THRESHOLD;
+    else if (name == "kmeans") backend = RegimeBackend::KMEANS;
+    else if (name == "hmm") backend = RegimeBackend::HMM;
+    else return false;
+    return true;
+}
+
+RegimeDetector::RegimeDetector(int lookback_window, std::pmr::memory_resource* resource,
+                               RegimeBackend backend, const RegimeModel* model)
+    : lookback_window(lookback_window), current_regime(Regime::SIDEWAYS),
+      prices(resource), volumes(resource), ranges(resource), log_returns(resource),
+      backend(model != nullptr ? backend : RegimeBackend::THRESHOLD), model(model) {
+    reset();
 }
 
 void RegimeDetector::reset() {
@@ -13,9 +27,49 @@ void RegimeDetector::reset() {
     volumes.clear();
     ranges.clear();
     current_regime = Regime::SIDEWAYS;
+    if (model != nullptr) {
+        centroids = model->mean;
+        counts = model->weight;
+        filtered = model->initial;
+    }
 }
 
 Regime RegimeDetector::update_and_get(const OHLCV& tick) {
+    if (backend != RegimeBackend::THRESHOLD) {
+        RegimeFeatures features;
+        if (!update_features(tick, features)) {
+            return Regime::SIDEWAYS;
+        }
+        current_regime = classify_model(features);
+        return current_regime;
+    }
+    
+    if (!push_tick(tick)) {
+        return Regime::SIDEWAYS;
+    }
+    
+    // Calculate features
+    double vol = calculate_realized_vol();
+    double vol_zscore = calculate_volume_zscore();
+    double avg_range = calculate_range_mean();
+    
+    // Classify
+    current_regime = classify_regime(vol, vol_zscore, avg_range);
+    
+    return current_regime;
+}
+
+bool RegimeDetector::update_features(const OHLCV& tick, RegimeFeatures& features) {
+    if (!push_tick(tick)) {
+        return false;
+    }
+    features[0] = calculate_realized_vol();
+    features[1] = calculate_volume_zscore();
+    features[2] = tick.close > 0.0 ? calculate_range_mean() / tick.close : 0.0;
+    return true;
+}
+
+bool RegimeDetector::push_tick(const OHLCV& tick) {
     prices.push_back(tick.close);
     volumes.push_back(tick.volume);
     ranges.push_back(tick.high - tick.low);
@@ -28,25 +82,180 @@ Regime RegimeDetector::update_and_get(const OHLCV& tick) {
     }
     
     // Need enough data to classify
-    if (prices.size() < static_cast<size_t>(lookback_window / 2)) {
-        return Regime::SIDEWAYS;
+    return prices.size() >= static_cast<size_t>(lookback_window / 2);
+}
+
+Regime RegimeDetector::classify_model(const RegimeFeatures& features) {
+    RegimeFeatures z = model->standardize(features);
+    return backend == RegimeBackend::HMM ? classify_hmm(z) : classify_kmeans(z);
+}
+
+std::vector<uint8_t> RegimeDetector::label_series(const std::vector<OHLCV>& bars, int parallel,
+                                                  int lookback_window, RegimeBackend backend,
+                                                  const RegimeModel* model) {
+    const size_t n = bars.size();
+    const size_t lookback = static_cast<size_t>(std::max(1, lookback_window));
+    const size_t ready_size = static_cast<size_t>(lookback_window / 2);
+    const bool use_model = backend != RegimeBackend::THRESHOLD && model != nullptr;
+    
+    std::vector<uint8_t> labels(n, static_cast<uint8_t>(Regime::SIDEWAYS));
+    std::vector<RegimeFeatures> features(use_model ? n : 0);
+    std::vector<uint8_t> ready(use_model ? n : 0, 0);
+    
+    // Each chunk needs the bars of its first window too; the sums below run
+    // in the same order as the deque-based path, so results match exactly
+    auto label_chunk = [&](size_t begin, size_t end) {
+        size_t first = begin + 1 >= lookback ? begin + 1 - lookback : 0;
+        std::vector<double> log_return(end - first, 0.0);
+        std::vector<uint8_t> has_return(end - first, 0);
+        for (size_t i = first + 1; i < end; ++i) {
+            if (bars[i - 1].close > 0.0) {
+                log_return[i - first] = std::log(bars[i].close / bars[i - 1].close);
+                has_return[i - first] = 1;
+            }
+        }
+    
+        for (size_t t = begin; t < end; ++t) {
+            size_t w = t + 1 >= lookback ? t + 1 - lookback : 0;
+            size_t size = t + 1 - w;
+            if (size < ready_size) continue;
+    
+            double vol = 0.0;
+            if (size >= 2) {
+                double sum = 0.0;
+                size_t count = 0;
+                for (size_t i = w + 1; i <= t; ++i) {
+                    if (has_return[i - first]) {
+                        sum += log_return[i - first];
+                        count++;
+                    }
+                }
+                if (count > 0) {
+                    double mean = sum / count;
+                    double variance = 0.0;
+                    for (size_t i = w + 1; i <= t; ++i) {
+                        if (has_return[i - first]) {
+                            double diff = log_return[i - first] - mean;
+                            variance += diff * diff;
+                        }
+                    }
+                    vol = std::sqrt(variance / count);
+                }
+            }
+    
+            double vol_zscore = 0.0;
+            if (size >= 2) {
+                double sum = 0.0;
+                for (size_t i = w; i <= t; ++i) sum += static_cast<double>(bars[i].volume);
+                double mean = sum / size;
+                double variance = 0.0;
+                for (size_t i = w; i <= t; ++i) {
+                    double diff = static_cast<double>(bars[i].volume) - mean;
+                    variance += diff * diff;
+                }
+                double stddev = std::sqrt(variance / size);
+                if (stddev != 0.0) vol_zscore = (static_cast<double>(bars[t].volume) - mean) / stddev;
+            }
+    
+            double range_sum = 0.0;
+            for (size_t i = w; i <= t; ++i) range_sum += bars[i].high - bars[i].low;
+            double avg_range = range_sum / size;
+    
+            if (use_model) {
+                features[t] = {vol, vol_zscore, bars[t].close > 0.0 ? avg_range / bars[t].close : 0.0};
+                ready[t] = 1;
+            } else {
+                labels[t] = static_cast<uint8_t>(classify_regime(vol, vol_zscore, avg_range));
+            }
+        }
+    };
+    
+    const size_t chunk_bars = 1 << 16;
+    size_t chunks = (n + chunk_bars - 1) / chunk_bars;
+    ThreadPool::shared().parallel_for(chunks, parallel, [&](size_t c) {
+        label_chunk(c * chunk_bars, std::min(n, (c + 1) * chunk_bars));
+    });
+    
+    // HMM and streaming k-means state carries over every bar, so this pass
+    // is sequential; it is O(states^2) per bar
+    if (use_model) {
+        RegimeDetector detector(lookback_window, std::pmr::get_default_resource(), backend, model);
+        for (size_t t = 0; t < n; ++t) {
+            if (ready[t]) labels[t] = static_cast<uint8_t>(detector.classify_model(features[t]));
+        }
+    }
+    return labels;
+}
+
+Regime RegimeDetector::classify_kmeans(const RegimeFeatures& z) {
+    size_t best = 0;
+    double best_distance = 0.0;
+    for (size_t k = 0; k < REGIME_STATES; ++k) {
+        double distance = 0.0;
+        for (size_t f = 0; f < REGIME_FEATURES; ++f) {
+            double d = z[f] - centroids[k][f];
+            distance += d * d;
+        }
+        if (k == 0 || distance < best_distance) {
+            best = k;
+            best_distance = distance;
+        }
     }
     
-    // Calculate features
-    double vol = calculate_realized_vol();
-    double vol_zscore = calculate_volume_zscore();
-    double avg_range = calculate_range_mean();
+    // Streaming k-means: move the winner towards the point by 1/n
+    counts[best] += 1.0;
+    for (size_t f = 0; f < REGIME_FEATURES; ++f) {
+        centroids[best][f] += (z[f] - centroids[best][f]) / counts[best];
+    }
+    return model->label[best];
+}
+
+Regime RegimeDetector::classify_hmm(const RegimeFeatures& z) {
+    // Diagonal Gaussian log-likelihood of each state
+    std::array<double, REGIME_STATES> log_likelihood;
+    double max_log = 0.0;
+    for (size_t k = 0; k < REGIME_STATES; ++k) {
+        double sum = 0.0;
+        for (size_t f = 0; f < REGIME_FEATURES; ++f) {
+            double d = z[f] - model->mean[k][f];
+            sum += d * d / model->variance[k][f] + std::log(model->variance[k][f]);
+        }
+        log_likelihood[k] = -0.5 * sum;
+        max_log = k == 0 ? log_likelihood[k] : std::max(max_log, log_likelihood[k]);
+    }
     
-    // Classify
-    current_regime = classify_regime(vol, vol_zscore, avg_range);
+    // Forward step: predict through the transition matrix, weight by the
+    // likelihoods (relative to the best, to avoid underflow), normalize
+    std::array<double, REGIME_STATES> next;
+    double total = 0.0;
+    for (size_t to = 0; to < REGIME_STATES; ++to) {
+        double predicted = 0.0;
+        for (size_t from = 0; from < REGIME_STATES; ++from) {
+            predicted += filtered[from] * model->transition[from][to];
+        }
+        next[to] = predicted * std::exp(log_likelihood[to] - max_log);
+        total += next[to];
+    }
+    if (total > 0.0) {
+        for (size_t k = 0; k < REGIME_STATES; ++k) {
+            filtered[k] = next[k] / total;
+        }
+    } else {
+        filtered = model->initial;
+    }
     
-    return current_regime;
+    size_t best = 0;
+    for (size_t k = 1; k < REGIME_STATES; ++k) {
+        if (filtered[k] > filtered[best]) best = k;
+    }
+    return model->label[best];
 }
 
 double RegimeDetector::calculate_realized_vol() {
     if (prices.size() < 2) return 0.0;
     
-    std::vector<double> returns;
+    std::pmr::vector<double>& returns = log_returns;
+    returns.clear();
     for (size_t i = 1; i < prices.size(); ++i) {
         if (prices[i-1] > 0.0) {
             double ret = std::log(prices[i] / prices[i-1]);
@@ -1,7 +1,10 @@
 #pragma once
 
 #include "data/DataLoader.h"
+#include <array>
+#include <cstdint>
 #include <deque>
+#include <memory_resource>
 #include <vector>
 #include <cmath>
 
@@ -13,16 +16,53 @@ enum class Regime {
     SIDEWAYS
 };
 
+// How bars are mapped to regimes: the built-in thresholds, or a fitted
+// RegimeModel used for nearest-centroid (k-means) or HMM forward filtering
+enum class RegimeBackend {
+    THRESHOLD,
+    KMEANS,
+    HMM
+};
+
+// "threshold", "kmeans" or "hmm"
+bool parse_regime_backend(const std::string& name, RegimeBackend& backend);
+
+constexpr size_t REGIME_STATES = 3;
+constexpr size_t REGIME_FEATURES = 3;
+
+// Realized vol of log returns, volume z-score, mean bar range / close
+using RegimeFeatures = std::array<double, REGIME_FEATURES>;
+
+class RegimeModel;
+
 class RegimeDetector {
 public:
-    RegimeDetector(int lookback_window = 20);
+    // Model backends fall back to THRESHOLD when `model` is null; the
+    // model must outlive the detector
+    RegimeDetector(int lookback_window = 20,
+                   std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+                   RegimeBackend backend = RegimeBackend::THRESHOLD,
+                   const RegimeModel* model = nullptr);
     
     // Update with new tick and return current regime
     Regime update_and_get(const OHLCV& tick);
     
+    // Update with new tick; false while the window is still filling
+    bool update_features(const OHLCV& tick, RegimeFeatures& features);
+    
     // Get current regime without updating
     Regime get_current_regime() const { return current_regime; }
     
+    // Regime of every bar, identical to calling update_and_get() on each in
+    // turn (label i depends on bars [0, i] only), as uint8_t(Regime).
+    // Window features are computed in chunks on `parallel` threads, each
+    // chunk warmed up on the lookback_window bars before it; model backends
+    // then filter the features in order.
+    static std::vector<uint8_t> label_series(const std::vector<OHLCV>& bars, int parallel,
+                                             int lookback_window = 20,
+                                             RegimeBackend backend = RegimeBackend::THRESHOLD,
+                                             const RegimeModel* model = nullptr);
+    
     // Reset detector
     void reset();
 
@@ -30,9 +70,22 @@ private:
     int lookback_window;
     Regime current_regime;
     
-    std::deque<double> prices;
-    std::deque<double> volumes;
-    std::deque<double> ranges; // high - low
+    std::pmr::deque<double> prices;
+    std::pmr::deque<double> volumes;
+    std::pmr::deque<double> ranges; // high - low
+    std::pmr::vector<double> log_returns; // scratch, reused every bar
+    
+    // Model backends; fixed-size so updates never allocate
+    RegimeBackend backend;
+    const RegimeModel* model;
+    std::array<RegimeFeatures, REGIME_STATES> centroids; // k-means, adapted online
+    std::array<double, REGIME_STATES> counts;            // k-means points per centroid
+    std::array<double, REGIME_STATES> filtered;          // HMM P(state | bars so far)
+    
+    bool push_tick(const OHLCV& tick);
+    Regime classify_model(const RegimeFeatures& features);
+    Regime classify_kmeans(const RegimeFeatures& features);
+    Regime classify_hmm(const RegimeFeatures& features);
     
     // Features for classification
     double calculate_realized_vol();
@@ -40,7 +93,7 @@ private:
     double calculate_range_mean();
     
     // Simple threshold-based classification
-    Regime classify_regime(double vol, double vol_zscore, double avg_range);
+    static Regime classify_regime(double vol, double vol_zscore, double avg_range);
 };
 
 } // namespace fluxback
@@ -0,0 +1,304 @@
+#include "regime/RegimeModel.h"
+#include "concurrency/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+
+namespace fluxback {
+
+namespace {
+
+const char* MODEL_HEADER = "fluxback-regime-model";
+const int MODEL_VERSION = 1;
+
+// Work is split into fixed chunks and partial results are merged in chunk
+// order, so fits are identical for any thread count
+const size_t FIT_CHUNK = 1 << 16;
+const double MIN_VARIANCE = 1e-6;
+
+template <typename Fn>
+void for_each_chunk(size_t chunks, int parallel, Fn fn) {
+    ThreadPool::shared().parallel_for(chunks, parallel, fn);
+}
+
+struct ClusterSums {
+    std::array<RegimeFeatures, REGIME_STATES> sum{};
+    std::array<RegimeFeatures, REGIME_STATES> sum_sq{};
+    std::array<double, REGIME_STATES> count{};
+    size_t changed = 0;
+    
+    void merge(const ClusterSums& other) {
+        for (size_t k = 0; k < REGIME_STATES; ++k) {
+            for (size_t f = 0; f < REGIME_FEATURES; ++f) {
+                sum[k][f] += other.sum[k][f];
+                sum_sq[k][f] += other.sum_sq[k][f];
+            }
+            count[k] += other.count[k];
+        }
+        changed += other.changed;
+    }
+};
+
+size_t nearest(const RegimeFeatures& x, const std::array<RegimeFeatures, REGIME_STATES>& centroids) {
+    size_t best = 0;
+    double best_distance = 0.0;
+    for (size_t k = 0; k < REGIME_STATES; ++k) {
+        double distance = 0.0;
+        for (size_t f = 0; f < REGIME_FEATURES; ++f) {
+            double d = x[f] - centroids[k][f];
+            distance += d * d;
+        }
+        if (k == 0 || distance < best_distance) {
+            best = k;
+            best_distance = distance;
+        }
+    }
+    return best;
+}
+
+const char* regime_name(Regime regime) {
+    switch (regime) {
+        case Regime::TREND: return "TREND";
+        case Regime::VOLATILE: return "VOLATILE";
+        case Regime::SIDEWAYS: return "SIDEWAYS";
+    }
+    return "SIDEWAYS";
+}
+
+bool parse_regime_name(const std::string& name, Regime& regime) {
+    if (name == "TREND") regime = Regime::TREND;
+    else if (name == "VOLATILE") regime = Regime::VOLATILE;
+    else if (name == "SIDEWAYS") regime = Regime::SIDEWAYS;
+    else return false;
+    return true;
+}
+
+} // namespace
+
+RegimeBackend regime_backend(const StrategyConfig& config) {
+    RegimeBackend backend = RegimeBackend::THRESHOLD;
+    if (config.regime.fitted == nullptr || !parse_regime_backend(config.regime.model, backend)) {
+        return RegimeBackend::THRESHOLD;
+    }
+    return backend;
+}
+
+std::string regime_source(const StrategyConfig& config) {
+    if (regime_backend(config) == RegimeBackend::THRESHOLD) return "threshold";
+    return config.regime.model + ":" + config.regime.model_path;
+}
+
+RegimeFeatures RegimeModel::standardize(const RegimeFeatures& features) const {
+    RegimeFeatures z;
+    for (size_t f = 0; f < REGIME_FEATURES; ++f) {
+        z[f] = (features[f] - shift[f]) / scale[f];
+    }
+    return z;
+}
+
+bool RegimeModel::fit(const std::vector<OHLCV>& bars, int parallel, int max_iterations, int lookback_window) {
+    // Features only depend on the last `lookback_window` bars, so each chunk
+    // warms up a detector on the bars just before it
+    size_t chunks = (bars.size() + FIT_CHUNK - 1) / FIT_CHUNK;
+    std::vector<std::vector<RegimeFeatures>> chunk_rows(chunks);
+    for_each_chunk(chunks, parallel, [&](size_t c) {
+        size_t begin = c * FIT_CHUNK;
+        size_t end = std::min(bars.size(), begin + FIT_CHUNK);
+        size_t warmup = begin - std::min(begin, static_cast<size_t>(lookback_window));
+        RegimeDetector detector(lookback_window);
+        RegimeFeatures features;
+        for (size_t i = warmup; i < end; ++i) {
+            bool ready = detector.update_features(bars[i], features);
+            if (i < begin || !ready) continue;
+            if (std::isfinite(features[0]) && std::isfinite(features[1]) && std::isfinite(features[2])) {
+                chunk_rows[c].push_back(features);
+            }
+        }
+    });
+    
+    std::vector<RegimeFeatures> rows;
+    for (auto& chunk : chunk_rows) {
+        rows.insert(rows.end(), chunk.begin(), chunk.end());
+    }
+    chunk_rows.clear();
+    if (rows.size() < REGIME_STATES * 10) return false;
+    
+    // Standardize so no feature dominates the distances
+    for (size_t f = 0; f < REGIME_FEATURES; ++f) {
+        double sum = 0.0, sum_sq = 0.0;
+        for (const auto& row : rows) {
+            sum += row[f];
+            sum_sq += row[f] * row[f];
+        }
+        shift[f] = sum / rows.size();
+        double variance = sum_sq / rows.size() - shift[f] * shift[f];
+        scale[f] = variance > 0.0 ? std::sqrt(variance) : 1.0;
+    }
+    for (auto& row : rows) {
+        row = standardize(row);
+    }
+    
+    // Seed centroids at the 1/6, 1/2 and 5/6 volatility quantiles
+    std::vector<size_t> order(rows.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::array<RegimeFeatures, REGIME_STATES> centroids;
+    for (size_t k = 0; k < REGIME_STATES; ++k) {
+        auto nth = order.begin() + static_cast<std::ptrdiff_t>((2 * k + 1) * order.size() / (2 * REGIME_STATES));
+        std::nth_element(order.begin(), nth, order.end(),
+                         [&rows](size_t a, size_t b) { return rows[a][0] < rows[b][0]; });
+        centroids[k] = rows[*nth];
+    }
+    
+    // Lloyd iterations: assign in parallel, merge partial sums in chunk order
+    std::vector<uint8_t> labels(rows.size(), 0);
+    size_t row_chunks = (rows.size() + FIT_CHUNK - 1) / FIT_CHUNK;
+    std::vector<ClusterSums> partial(row_chunks);
+    ClusterSums totals;
+    fit_iterations = 0;
+    for (int iteration = 0; iteration < std::max(1, max_iterations); ++iteration) {
+        for_each_chunk(row_chunks, parallel, [&](size_t c) {
+            ClusterSums sums;
+            size_t end = std::min(rows.size(), (c + 1) * FIT_CHUNK);
+            for (size_t i = c * FIT_CHUNK; i < end; ++i) {
+                size_t k = nearest(rows[i], centroids);
+                if (k != labels[i] || iteration == 0) sums.changed++;
+                labels[i] = static_cast<uint8_t>(k);
+                sums.count[k] += 1.0;
+                for (size_t f = 0; f < REGIME_FEATURES; ++f) {
+                    sums.sum[k][f] += rows[i][f];
+                    sums.sum_sq[k][f] += rows[i][f] * rows[i][f];
+                }
+            }
+            partial[c] = sums;
+        });
+    
+        totals = ClusterSums();
+        for (const auto& sums : partial) {
+            totals.merge(sums);
+        }
+        fit_iterations = iteration + 1;
+        if (totals.changed == 0) break; // sums match the current centroids
+    
+        for (size_t k = 0; k < REGIME_STATES; ++k) {
+            if (totals.count[k] == 0.0) continue; // empty cluster keeps its centroid
+            for (size_t f = 0; f < REGIME_FEATURES; ++f) {
+                centroids[k][f] = totals.sum[k][f] / totals.count[k];
+            }
+        }
+    }
+    
+    // Gaussian per cluster, from the final assignment
+    for (size_t k = 0; k < REGIME_STATES; ++k) {
+        double n = totals.count[k];
+        weight[k] = n;
+        initial[k] = (n + 1.0) / (rows.size() + REGIME_STATES);
+        for (size_t f = 0; f < REGIME_FEATURES; ++f) {
+            mean[k][f] = n > 0.0 ? totals.sum[k][f] / n : centroids[k][f];
+            double variance = n > 0.0 ? totals.sum_sq[k][f] / n - mean[k][f] * mean[k][f] : 1.0;
+            this->variance[k][f] = std::max(variance, MIN_VARIANCE);
+        }
+    }
+    
+    // Transitions between consecutive labels, with add-one smoothing
+    std::array<std::array<double, REGIME_STATES>, REGIME_STATES> counts;
+    for (auto& row : counts) row.fill(1.0);
+    for (size_t i = 1; i < labels.size(); ++i) {
+        counts[labels[i - 1]][labels[i]] += 1.0;
+    }
+    for (size_t from = 0; from < REGIME_STATES; ++from) {
+        double total = 0.0;
+        for (double c : counts[from]) total += c;
+        for (size_t to = 0; to < REGIME_STATES; ++to) {
+            transition[from][to] = counts[from][to] / total;
+        }
+    }
+    
+    // Label by volatility: calmest is SIDEWAYS, most volatile is VOLATILE
+    std::array<size_t, REGIME_STATES> by_vol = {0, 1, 2};
+    std::sort(by_vol.begin(), by_vol.end(), [this](size_t a, size_t b) { return mean[a][0] < mean[b][0]; });
+    label[by_vol[0]] = Regime::SIDEWAYS;
+    label[by_vol[1]] = Regime::TREND;
+    label[by_vol[2]] = Regime::VOLATILE;
+    
+    fit_points = rows.size();
+    return true;
+}
+
+bool RegimeModel::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out.is_open()) return false;
+    
+    out.precision(17);
+    auto write_features = [&out](const RegimeFeatures& values) {
+        for (double v : values) out << ' ' << v;
+    };
+    out << MODEL_HEADER << ' ' << MODEL_VERSION << '\n';
+    out << "shift";
+    write_features(shift);
+    out << "\nscale";
+    write_features(scale);
+    out << '\n';
+    for (size_t k = 0; k < REGIME_STATES; ++k) {
+        out << "state " << regime_name(label[k]) << ' ' << weight[k] << ' ' << initial[k];
+        write_features(mean[k]);
+        write_features(variance[k]);
+        out << '\n';
+    }
+    for (size_t from = 0; from < REGIME_STATES; ++from) {
+        out << "transition";
+        for (double p : transition[from]) out << ' ' << p;
+        out << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+bool RegimeModel::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+    
+    std::string header;
+    int version = 0;
+    if (!(in >> header >> version) || header != MODEL_HEADER || version != MODEL_VERSION) return false;
+    
+    RegimeModel loaded;
+    size_t states = 0, rows = 0;
+    bool has_shift = false, has_scale = false;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string key;
+        if (!(fields >> key)) continue;
+    
+        bool ok = true;
+        if (key == "shift" || key == "scale") {
+            RegimeFeatures& target = key == "shift" ? loaded.shift : loaded.scale;
+            for (double& v : target) ok = ok && static_cast<bool>(fields >> v);
+            (key == "shift" ? has_shift : has_scale) = ok;
+        } else if (key == "state" && states < REGIME_STATES) {
+            std::string name;
+            ok = (fields >> name >> loaded.weight[states] >> loaded.initial[states]) &&
+                 parse_regime_name(name, loaded.label[states]);
+            for (double& v : loaded.mean[states]) ok = ok && static_cast<bool>(fields >> v);
+            for (double& v : loaded.variance[states]) ok = ok && static_cast<bool>(fields >> v);
+            states++;
+        } else if (key == "transition" && rows < REGIME_STATES) {
+            for (double& p : loaded.transition[rows]) ok = ok && static_cast<bool>(fields >> p);
+            rows++;
+        }
+        if (!ok) return false;
+    }
+    if (!has_shift || !has_scale || states != REGIME_STATES || rows != REGIME_STATES) return false;
+    for (size_t f = 0; f < REGIME_FEATURES; ++f) {
+        if (!(loaded.scale[f] > 0.0)) return false;
+        for (size_t k = 0; k < REGIME_STATES; ++k) {
+            if (!(loaded.variance[k][f] > 0.0)) return false;
+        }
+    }
+    
+    *this = loaded;
+    return true;
+}
+
+} // namespace fluxback
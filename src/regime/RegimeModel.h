@@ -0,0 +1,54 @@
+#pragma once
+
+#include "regime/RegimeDetector.h"
+#include "utils/ConfigParser.h"
+#include <string>
+#include <vector>
+
+namespace fluxback {
+
+// Three regime states fitted offline from RegimeDetector features. Each
+// state has a diagonal Gaussian over the standardized features (mean is
+// also the k-means centroid); the transition matrix and initial
+// distribution drive HMM filtering. States are ordered by volatility and
+// labelled SIDEWAYS, TREND, VOLATILE.
+class RegimeModel {
+public:
+    RegimeFeatures shift{};   // feature means used for standardizing
+    RegimeFeatures scale{};   // feature standard deviations
+    std::array<RegimeFeatures, REGIME_STATES> mean{};
+    std::array<RegimeFeatures, REGIME_STATES> variance{};
+    std::array<double, REGIME_STATES> weight{};   // training points per state
+    std::array<double, REGIME_STATES> initial{};
+    std::array<std::array<double, REGIME_STATES>, REGIME_STATES> transition{}; // [from][to]
+    std::array<Regime, REGIME_STATES> label{};
+    
+    // (x - shift) / scale, per feature
+    RegimeFeatures standardize(const RegimeFeatures& features) const;
+    
+    // Extract features and run k-means on `parallel` threads, then estimate
+    // variances and transitions from the clustering. Results do not depend
+    // on the thread count. Returns false if there are too few bars.
+    bool fit(const std::vector<OHLCV>& bars, int parallel, int max_iterations = 50,
+             int lookback_window = 20);
+    
+    // Text format, one state or matrix row per line
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+    
+    // Iterations the last fit() ran and the points it clustered
+    int iterations() const { return fit_iterations; }
+    size_t points() const { return fit_points; }
+
+private:
+    int fit_iterations = 0;
+    size_t fit_points = 0;
+};
+
+// Backend named by config.regime.model; THRESHOLD unless a model is loaded
+RegimeBackend regime_backend(const StrategyConfig& config);
+
+// Identifies the backend and model file a strategy's regimes come from
+std::string regime_source(const StrategyConfig& config);
+
+} // namespace fluxback
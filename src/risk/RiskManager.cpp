@@ -0,0 +1,108 @@
+#include "risk/RiskManager.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace fluxback {
+
+RiskManager::RiskManager(const StrategyConfig::RiskConfig& limits, double initial_cash)
+    : limits(limits) {
+    reset(initial_cash);
+}
+
+size_t RiskManager::add_symbol() {
+    symbols.emplace_back();
+    return symbols.size() - 1;
+}
+
+void RiskManager::reset(double initial_cash) {
+    for (auto& state : symbols) {
+        state = SymbolState();
+    }
+    cash = initial_cash;
+    gross = 0.0;
+    net = 0.0;
+    peak = initial_cash;
+    kill_switch = false;
+    resized = 0;
+    rejected = 0;
+}
+
+void RiskManager::set_exposure(SymbolState& state, int position, double price) {
+    double before = state.position * state.price;
+    double after = position * price;
+    net += after - before;
+    gross += std::fabs(after) - std::fabs(before);
+    state.position = position;
+    state.price = price;
+}
+
+void RiskManager::mark(size_t symbol, double price) {
+    SymbolState& state = symbols[symbol];
+    set_exposure(state, state.position, price);
+    check_drawdown();
+}
+
+void RiskManager::on_fill(size_t symbol, int quantity, double price, double costs) {
+    SymbolState& state = symbols[symbol];
+    cash -= quantity * price + costs;
+    set_exposure(state, state.position + quantity, state.price > 0.0 ? state.price : price);
+    check_drawdown();
+}
+
+void RiskManager::charge(double amount) {
+    cash -= amount;
+    check_drawdown();
+}
+
+double RiskManager::drawdown_pct() const {
+    return peak > 0.0 ? (peak - equity()) / peak * 100.0 : 0.0;
+}
+
+void RiskManager::check_drawdown() {
+    peak = std::max(peak, equity());
+    if (limits.max_drawdown_pct > 0.0 && drawdown_pct() >= limits.max_drawdown_pct) {
+        kill_switch = true;
+    }
+}
+
+int RiskManager::size_entry(size_t symbol, int side, int requested, double price, double realized_vol) const {
+    if (kill_switch || price <= 0.0) return 0;
+    
+    double units = requested;
+    if (limits.target_vol > 0.0 && realized_vol > 0.0) {
+        units = std::max(0.0, equity()) * limits.target_vol / (realized_vol * price);
+    }
+    
+    // Headroom per limit, in units. `held` is the symbol's signed exposure;
+    // an entry against it first unwinds it, freeing twice its size of gross.
+    const SymbolState& state = symbols[symbol];
+    const double held = state.position * state.price;
+    const double unwind = side * held < 0.0 ? 2.0 * std::fabs(held) : 0.0;
+    if (limits.max_symbol_exposure > 0.0) {
+        units = std::min(units, (limits.max_symbol_exposure - side * held) / price);
+    }
+    if (limits.max_gross_exposure > 0.0) {
+        units = std::min(units, (limits.max_gross_exposure - gross + unwind) / price);
+    }
+    if (limits.max_leverage > 0.0) {
+        units = std::min(units, (limits.max_leverage * equity() - gross + unwind) / price);
+    }
+    if (limits.max_net_exposure > 0.0) {
+        units = std::min(units, (limits.max_net_exposure - side * net) / price);
+    }
+    
+    units = std::floor(units);
+    if (!(units > 0.0)) return 0;
+    return units >= INT_MAX ? INT_MAX : static_cast<int>(units);
+}
+
+void RiskManager::record_adjustment(int requested, int approved) {
+    if (approved <= 0) {
+        ++rejected;
+    } else if (approved != requested) {
+        ++resized;
+    }
+}
+
+} // namespace fluxback
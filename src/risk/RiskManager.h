@@ -0,0 +1,73 @@
+#pragma once
+
+#include "utils/ConfigParser.h"
+#include <cstddef>
+#include <vector>
+
+namespace fluxback {
+
+// Pre-trade risk checks between StrategyEngine and ExecutionSimulator.
+// Keeps each symbol's position and last price, and portfolio gross / net
+// exposure and equity as running sums, so marking a price, applying a fill
+// and sizing an entry are O(1) however many symbols share one manager.
+class RiskManager {
+public:
+    explicit RiskManager(const StrategyConfig::RiskConfig& limits, double initial_cash = 100000.0);
+    
+    // Register a symbol; returns its slot
+    size_t add_symbol();
+    size_t symbol_count() const { return symbols.size(); }
+    
+    // New market price for a symbol; updates exposure, equity and the
+    // drawdown kill switch
+    void mark(size_t symbol, double price);
+    
+    // Apply a fill of `quantity` units (negative for sells) at `price`,
+    // paying `costs`. Exposure stays marked at the market price, so
+    // slippage shows up in equity.
+    void on_fill(size_t symbol, int quantity, double price, double costs = 0.0);
+    
+    // Take a cost outside a fill (overnight carry) out of equity
+    void charge(double amount);
+    
+    // Units an entry of `requested` on `side` (+1 long, -1 short) may take:
+    // vol-targeted when target_vol is set, then clipped to the symbol,
+    // gross, net and leverage limits. 0 once the kill switch has tripped.
+    int size_entry(size_t symbol, int side, int requested, double price, double realized_vol) const;
+    
+    // Count an entry the limits resized (approved > 0) or rejected
+    void record_adjustment(int requested, int approved);
+    
+    double gross_exposure() const { return gross; }
+    double net_exposure() const { return net; }
+    double equity() const { return cash + net; }
+    double drawdown_pct() const;
+    bool halted() const { return kill_switch; }
+    int position(size_t symbol) const { return symbols[symbol].position; }
+    size_t resized_entries() const { return resized; }
+    size_t rejected_entries() const { return rejected; }
+    
+    // Flatten every symbol (keeping the registrations) and restart from cash
+    void reset(double initial_cash);
+
+private:
+    struct SymbolState {
+        int position = 0;
+        double price = 0.0;
+    };
+    
+    StrategyConfig::RiskConfig limits;
+    std::vector<SymbolState> symbols;
+    double cash;
+    double gross;
+    double net;
+    double peak;
+    bool kill_switch;
+    size_t resized;
+    size_t rejected;
+    
+    void set_exposure(SymbolState& state, int position, double price);
+    void check_drawdown();
+};
+
+} // namespace fluxback
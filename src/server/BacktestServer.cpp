@@ -0,0 +1,633 @@
+#include "server/BacktestServer.h"
+#include "engine/BacktestRunner.h"
+#include "engine/SweepRunner.h"
+#include "analytics/ResultWriter.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace fluxback {
+
+namespace {
+
+std::atomic<bool> g_signal_stop{false};
+
+void on_signal(int) {
+    g_signal_stop = true;
+}
+
+bool hex4(const std::string& text, size_t at, unsigned& code) {
+    if (at + 4 > text.size()) return false;
+    code = 0;
+    for (size_t i = at; i < at + 4; ++i) {
+        char c = text[i];
+        unsigned digit;
+        if (c >= '0' && c <= '9') {
+            digit = static_cast<unsigned>(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            digit = static_cast<unsigned>(c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            digit = static_cast<unsigned>(c - 'A' + 10);
+        } else {
+            return false;
+        }
+        code = code * 16 + digit;
+    }
+    return true;
+}
+
+void append_utf8(std::string& out, unsigned code) {
+    if (code < 0x80) {
+        out += static_cast<char>(code);
+    } else if (code < 0x800) {
+        out += static_cast<char>(0xC0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        out += static_cast<char>(0xE0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (code >> 18));
+        out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+}
+
+// Extract a top-level string field from a flat JSON object, decoding
+// escapes (\uXXXX to UTF-8, surrogate pairs included). A missing field
+// reads as empty; false if the string is unterminated or has an invalid
+// escape or a lone surrogate.
+bool json_string_field(const std::string& body, const std::string& key, std::string& value) {
+    value.clear();
+    std::string needle = "\"" + key + "\"";
+    size_t pos = body.find(needle);
+    if (pos == std::string::npos) return true;
+    pos = body.find(':', pos + needle.size());
+    if (pos == std::string::npos) return true;
+    pos = body.find('"', pos + 1);
+    if (pos == std::string::npos) return true;
+    
+    for (size_t i = pos + 1; i < body.size(); ++i) {
+        char c = body[i];
+        if (c == '"') return true;
+        if (c != '\\') {
+            value += c;
+            continue;
+        }
+        if (++i >= body.size()) return false;
+        switch (body[i]) {
+            case '"': value += '"'; break;
+            case '\\': value += '\\'; break;
+            case '/': value += '/'; break;
+            case 'n': value += '\n'; break;
+            case 'r': value += '\r'; break;
+            case 't': value += '\t'; break;
+            case 'b': value += '\b'; break;
+            case 'f': value += '\f'; break;
+            case 'u': {
+                unsigned code;
+                if (!hex4(body, i + 1, code)) return false;
+                i += 4;
+                if (code >= 0xDC00 && code <= 0xDFFF) return false; // low half without a high one
+                if (code >= 0xD800 && code <= 0xDBFF) {
+                    unsigned low;
+                    if (i + 2 >= body.size() || body[i + 1] != '\\' || body[i + 2] != 'u' ||
+                        !hex4(body, i + 3, low) || low < 0xDC00 || low > 0xDFFF) {
+                        return false;
+                    }
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    i += 6;
+                }
+                append_utf8(value, code);
+                break;
+            }
+            default: return false;
+        }
+    }
+    return false;
+}
+
+// The string fields every request reads
+struct RequestFields {
+    std::string strategy;
+    std::string data;
+    std::string data_path;
+};
+
+bool read_fields(const std::string& body, RequestFields& fields) {
+    return json_string_field(body, "strategy", fields.strategy) && json_string_field(body, "data", fields.data) &&
+           json_string_field(body, "data_path", fields.data_path);
+}
+
+int json_int_field(const std::string& body, const std::string& key, int default_val) {
+    std::string needle = "\"" + key + "\"";
+    size_t pos = body.find(needle);
+    if (pos == std::string::npos) return default_val;
+    pos = body.find(':', pos + needle.size());
+    if (pos == std::string::npos) return default_val;
+    try {
+        return std::stoi(body.substr(pos + 1));
+    } catch (...) {
+        return default_val;
+    }
+}
+
+std::string json_error(const std::string& message) {
+    std::string escaped;
+    for (char c : message) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return "{\"error\": \"" + escaped + "\"}\n";
+}
+
+const char* status_text(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 408: return "Request Timeout";
+        case 413: return "Payload Too Large";
+        default: return "Internal Server Error";
+    }
+}
+
+} // namespace
+
+BacktestServer::BacktestServer(const ServerOptions& options)
+    : options(options), workers(static_cast<size_t>(std::max(1, options.workers))), arenas(workers),
+      connections(workers) {
+}
+
+BacktestServer::~BacktestServer() {
+    stop();
+    shutdown();
+}
+
+bool BacktestServer::resolve_data_path(const std::string& requested, std::string& resolved) const {
+    // Resolve symlinks and ".." before comparing, so neither can leave the root
+    std::error_code ec;
+    std::filesystem::path root = std::filesystem::canonical(options.data_root, ec);
+    if (ec) return false;
+    std::filesystem::path path = std::filesystem::canonical(root / requested, ec);
+    if (ec) return false;
+    auto common = std::mismatch(root.begin(), root.end(), path.begin(), path.end());
+    if (common.first != root.end() || !std::filesystem::is_regular_file(path, ec)) return false;
+    resolved = path.string();
+    return true;
+}
+
+bool BacktestServer::load_regime_model(StrategyConfig& config, std::string& error, int& status) const {
+    if (!config.regime.model_path.empty()) {
+        status = 403;
+        if (options.data_root.empty()) {
+            error = "regime.model_path is disabled; start the server with --data-root";
+            return false;
+        }
+        std::string model_path;
+        if (!resolve_data_path(config.regime.model_path, model_path)) {
+            error = "regime.model_path must name a file under the server's data root";
+            return false;
+        }
+        config.regime.model_path = model_path;
+    }
+    ConfigParser::load_regime_model(config);
+    return true;
+}
+
+std::shared_ptr<Dataset> BacktestServer::get_dataset(const std::string& csv_text, const std::string& requested_path,
+                                                     std::string& error, int& status) {
+    std::string key;
+    std::string data_path;
+    status = 400;
+    if (!requested_path.empty()) {
+        // Same answer for missing and forbidden files, so clients can't
+        // probe the filesystem
+        if (options.data_root.empty()) {
+            status = 403;
+            error = "data_path is disabled; send the CSV as data (or start the server with --data-root)";
+            return nullptr;
+        }
+        if (!resolve_data_path(requested_path, data_path)) {
+            status = 403;
+            error = "data_path must name a file under the server's data root";
+            return nullptr;
+        }
+        std::error_code ec;
+        auto size = std::filesystem::file_size(data_path, ec);
+        auto mtime = std::filesystem::last_write_time(data_path, ec).time_since_epoch().count();
+        key = "path:" + data_path + ":" + std::to_string(size) + ":" + std::to_string(mtime);
+    } else {
+        key = "text:" + std::to_string(csv_text.size()) + ":" +
+              std::to_string(std::hash<std::string>{}(csv_text));
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(datasets_mutex);
+        auto it = datasets.find(key);
+        if (it != datasets.end()) {
+            it->second->last_used = ++use_counter;
+            return it->second;
+        }
+    }
+    
+    // Parse outside the lock so other datasets stay available
+    auto dataset = std::make_shared<Dataset>();
+    if (!data_path.empty()) {
+        DataLoader loader(data_path);
+        dataset->bars = loader.load_all();
+    } else {
+        dataset->bars = DataLoader::parse_csv_text(csv_text);
+    }
+    if (dataset->bars.empty()) {
+        error = "No valid bars in data";
+        return nullptr;
+    }
+    
+    std::lock_guard<std::mutex> lock(datasets_mutex);
+    auto inserted = datasets.emplace(key, dataset);
+    inserted.first->second->last_used = ++use_counter;
+    
+    // Evict the least recently used dataset beyond the limit
+    while (datasets.size() > options.max_datasets) {
+        auto oldest = datasets.begin();
+        for (auto it = datasets.begin(); it != datasets.end(); ++it) {
+            if (it->second->last_used < oldest->second->last_used) oldest = it;
+        }
+        datasets.erase(oldest);
+    }
+    return inserted.first->second;
+}
+
+const IndicatorCache& BacktestServer::prepare_cache(Dataset& dataset, const StrategyConfig& config,
+                                                    std::shared_lock<std::shared_mutex>& lock) {
+    // The cache holds one regime series; a request with another regime
+    // model can replace it between the write and the shared lock, so
+    // check again until this config's series are there under the lock
+    while (!dataset.cache.covers(config)) {
+        lock.unlock();
+        {
+            std::unique_lock<std::shared_mutex> write_lock(dataset.cache_mutex);
+            dataset.cache.prepare(dataset.bars, config);
+        }
+        lock.lock();
+    }
+    return dataset.cache;
+}
+
+std::string BacktestServer::run_backtest(const std::string& body, int& status) {
+    RequestFields fields;
+    if (!read_fields(body, fields)) {
+        status = 400;
+        return json_error("Malformed JSON string");
+    }
+    // Model files are opened only once the path is vetted
+    StrategyConfig config = ConfigParser::parse_yaml_string(fields.strategy, false);
+    if (config.name.empty()) {
+        status = 400;
+        return json_error("Missing or invalid strategy");
+    }
+    
+    std::string error;
+    if (!load_regime_model(config, error, status)) {
+        return json_error(error);
+    }
+    auto dataset = get_dataset(fields.data, fields.data_path, error, status);
+    if (!dataset) {
+        return json_error(error);
+    }
+    
+    std::shared_lock<std::shared_mutex> lock(dataset->cache_mutex);
+    const IndicatorCache& cache = prepare_cache(*dataset, config, lock);
+    
+    // handle() may also be called from threads outside the pool
+    RunArena* arena = workers.worker_index() < workers.size() ? &arenas.local() : nullptr;
+    std::string result;
+    {
+        BacktestRunner runner(config, 100000.0, arena != nullptr ? arena : std::pmr::get_default_resource());
+        runner.attach_cache(&cache);
+        for (const auto& bar : dataset->bars) {
+            runner.on_bar(bar);
+        }
+        result = ResultWriter::summary_json(runner.summary());
+    }
+    if (arena != nullptr) arena->reset();
+    
+    status = 200;
+    return result;
+}
+
+std::string BacktestServer::run_sweep(const std::string& body, int& status) {
+    RequestFields fields;
+    if (!read_fields(body, fields)) {
+        status = 400;
+        return json_error("Malformed JSON string");
+    }
+    auto parsed = ConfigParser::parse_grid_string(fields.strategy, false);
+    if (!parsed || parsed->base.name.empty()) {
+        status = 400;
+        return json_error("Missing or invalid strategy");
+    }
+    ConfigGrid spec = *parsed; // the base gets its vetted regime model below
+    
+    // Bound the grid before expanding it (the product of the axes can
+    // overflow size_t, so stop multiplying once past the limit)
+    size_t grid_size = 1;
+    for (const auto& axis : spec.axes) {
+        if (axis.text.empty() || grid_size > options.max_grid) break;
+        grid_size = grid_size > options.max_grid / axis.text.size() ? options.max_grid + 1
+                                                                      : grid_size * axis.text.size();
+    }
+    if (grid_size > options.max_grid) {
+        status = 413;
+        return json_error("Sweep grid has more than " + std::to_string(options.max_grid) + " configs");
+    }
+    
+    std::string error;
+    if (!load_regime_model(spec.base, error, status)) {
+        return json_error(error);
+    }
+    auto dataset = get_dataset(fields.data, fields.data_path, error, status);
+    if (!dataset) {
+        return json_error(error);
+    }
+    
+    std::vector<StrategyConfig> grid = spec.axes.empty() ? SweepRunner::exit_grid(spec.base)
+                                                          : spec.expand();
+    std::shared_lock<std::shared_mutex> lock(dataset->cache_mutex);
+    for (const auto& cfg : grid) {
+        prepare_cache(*dataset, cfg, lock);
+    }
+    const IndicatorCache& cache = dataset->cache;
+    
+    SweepRunner sweep(dataset->bars, &cache);
+    const int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    auto results = sweep.run(grid, std::clamp(json_int_field(body, "parallel", 1), 1, cores));
+    
+    OutputBuffer out;
+    out.append("[\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& cfg = results[i].config;
+        out.append("{\"fast\": ").append_int(cfg.fast_sma)
+           .append(", \"slow\": ").append_int(cfg.slow_sma)
+           .append(", \"stop_loss_pct\": ").append_fixed(cfg.stop_loss_pct, 4)
+           .append(", \"take_profit_pct\": ").append_fixed(cfg.take_profit_pct, 4)
+           .append(", \"base_ticks\": ").append_int(cfg.slippage.base_ticks)
+           .append(", \"summary\": ");
+        ResultWriter::summary_json(out, results[i].summary, false);
+        out.append(i + 1 < results.size() ? "},\n" : "}\n");
+    }
+    out.append("]\n");
+    status = 200;
+    return out.str();
+}
+
+std::string BacktestServer::handle(const std::string& method, const std::string& path,
+                                   const std::string& body, int& status) {
+    if (method == "OPTIONS") {
+        status = 204;
+        return "";
+    }
+    if (method == "GET" && path == "/health") {
+        std::lock_guard<std::mutex> lock(datasets_mutex);
+        status = 200;
+        return "{\"status\": \"ok\", \"datasets\": " + std::to_string(datasets.size()) + "}\n";
+    }
+    if (method == "POST" && path == "/api/backtest") {
+        return run_backtest(body, status);
+    }
+    if (method == "POST" && path == "/api/sweep") {
+        return run_sweep(body, status);
+    }
+    status = 404;
+    return json_error("Unknown endpoint: " + method + " " + path);
+}
+
+std::string BacktestServer::cors_headers(const std::string& origin) const {
+    // Only the configured origin may read responses from a browser; any
+    // other page gets no CORS headers, and its preflights fail
+    if (options.allowed_origin.empty() || origin != options.allowed_origin) return "";
+    return "Access-Control-Allow-Origin: " + origin + "\r\n"
+           "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
+           "Access-Control-Allow-Headers: Content-Type\r\n"
+           "Vary: Origin\r\n";
+}
+
+#ifndef _WIN32
+
+void BacktestServer::serve_connection(int fd) {
+    std::string request;
+    char buffer[64 * 1024];
+    size_t header_end = std::string::npos;
+    size_t content_length = 0;
+    int status = 400;
+    std::string response_body;
+    std::string origin;
+    
+    // The whole request must arrive by the deadline, so an idle or
+    // trickling client can't hold a worker
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.request_timeout_ms);
+    while (true) {
+        auto left = std::chrono::duration_cast<std::chrono::microseconds>(deadline - std::chrono::steady_clock::now());
+        if (left.count() <= 0) {
+            status = 408;
+            response_body = json_error("Request timed out");
+            break;
+        }
+        timeval timeout{};
+        timeout.tv_sec = static_cast<time_t>(left.count() / 1000000);
+        timeout.tv_usec = static_cast<suseconds_t>(left.count() % 1000000);
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        
+        ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            status = 408;
+            response_body = json_error("Request timed out");
+            break;
+        }
+        if (n <= 0) break;
+        request.append(buffer, static_cast<size_t>(n));
+        
+        if (header_end == std::string::npos) {
+            header_end = request.find("\r\n\r\n");
+            if (header_end == std::string::npos || header_end > options.max_header_bytes) {
+                if (request.size() <= options.max_header_bytes) continue;
+                status = 413;
+                response_body = json_error("Request headers too large");
+                break;
+            }
+            std::string headers = request.substr(0, header_end);
+            for (auto& c : headers) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            size_t cl = headers.find("content-length:");
+            if (cl != std::string::npos) {
+                content_length = std::strtoull(headers.c_str() + cl + 15, nullptr, 10);
+            }
+            size_t origin_at = headers.find("\r\norigin:");
+            if (origin_at != std::string::npos) {
+                // Case-sensitive value from the original request
+                size_t begin = std::min(request.find_first_not_of(' ', origin_at + 9), header_end);
+                size_t end = std::min(request.find("\r\n", begin), header_end);
+                origin = request.substr(begin, end - begin);
+            }
+        }
+        if (content_length > options.max_body_bytes) {
+            status = 413;
+            response_body = json_error("Request body too large");
+            break;
+        }
+        if (request.size() >= header_end + 4 + content_length) {
+            std::istringstream request_line(request.substr(0, request.find("\r\n")));
+            std::string method, path;
+            request_line >> method >> path;
+            try {
+                response_body = handle(method, path, request.substr(header_end + 4, content_length), status);
+            } catch (const std::exception& e) {
+                status = 500;
+                response_body = json_error(e.what());
+            }
+            break;
+        }
+    }
+    
+    std::ostringstream response;
+    response << "HTTP/1.1 " << status << " " << status_text(status) << "\r\n"
+             << "Content-Type: application/json\r\n"
+             << cors_headers(origin)
+             << "Content-Length: " << response_body.size() << "\r\n"
+             << "Connection: close\r\n\r\n"
+             << response_body;
+    std::string out = response.str();
+    size_t sent = 0;
+    while (sent < out.size()) {
+        ssize_t n = ::send(fd, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) break;
+        sent += static_cast<size_t>(n);
+    }
+    ::close(fd);
+}
+
+int BacktestServer::run() {
+    if (options.port > 0) {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        int yes = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(options.port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // localhost only
+        if (fd < 0 || ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            ::listen(fd, 128) != 0) {
+            std::cerr << "Error: Could not listen on 127.0.0.1:" << options.port
+                      << " - " << std::strerror(errno) << std::endl;
+            if (fd >= 0) ::close(fd);
+            return 1;
+        }
+        listen_fds.push_back(fd);
+        std::cout << "Listening on http://127.0.0.1:" << options.port << "\n";
+    }
+    
+    if (!options.socket_path.empty()) {
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, options.socket_path.c_str(), sizeof(addr.sun_path) - 1);
+        ::unlink(options.socket_path.c_str());
+        if (fd < 0 || ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            ::listen(fd, 128) != 0) {
+            std::cerr << "Error: Could not listen on " << options.socket_path
+                      << " - " << std::strerror(errno) << std::endl;
+            if (fd >= 0) ::close(fd);
+            shutdown();
+            return 1;
+        }
+        listen_fds.push_back(fd);
+        std::cout << "Listening on unix:" << options.socket_path << "\n";
+    }
+    
+    if (listen_fds.empty()) {
+        std::cerr << "Error: No listener configured (use --port or --socket).\n";
+        return 1;
+    }
+    
+    g_signal_stop = false;
+    stop_requested = false;
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+    
+    std::cout << "Serving with " << workers.size() << " worker(s). Press Ctrl+C to stop.\n";
+    
+    std::vector<pollfd> fds;
+    for (int fd : listen_fds) fds.push_back(pollfd{fd, POLLIN, 0});
+    
+    while (!g_signal_stop && !stop_requested) {
+        int ready = ::poll(fds.data(), fds.size(), 200);
+        if (ready <= 0) continue;
+        for (auto& p : fds) {
+            if (!(p.revents & POLLIN)) continue;
+            int client = ::accept(p.fd, nullptr, nullptr);
+            if (client < 0) continue;
+            int one = 1;
+            ::setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            connections.run([this, client]() { serve_connection(client); });
+        }
+    }
+    
+    shutdown();
+    std::cout << "Server stopped.\n";
+    return 0;
+}
+
+void BacktestServer::stop() {
+    stop_requested = true;
+}
+
+void BacktestServer::shutdown() {
+    // Finish the connections already accepted
+    connections.wait();
+    for (int fd : listen_fds) ::close(fd);
+    listen_fds.clear();
+    if (!options.socket_path.empty()) {
+        ::unlink(options.socket_path.c_str());
+    }
+}
+
+#else
+
+int BacktestServer::run() {
+    std::cerr << "Error: serve mode is only supported on POSIX systems.\n";
+    return 1;
+}
+
+void BacktestServer::stop() {
+}
+
+void BacktestServer::shutdown() {
+}
+
+void BacktestServer::serve_connection(int) {
+}
+
+#endif
+
+} // namespace fluxback
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "concurrency/ThreadPool.h"
+#include "data/DataLoader.h"
+#include "indicators/IndicatorCache.h"
+#include "utils/ConfigParser.h"
+#include "utils/RunArena.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fluxback {
+
+struct ServerOptions {
+    int port = 8765;            // HTTP on 127.0.0.1; 0 disables TCP
+    std::string socket_path;    // Unix domain socket; empty disables
+    int workers = 4;
+    size_t max_datasets = 16;   // datasets kept warm in memory
+    size_t max_grid = 10000;    // configs one sweep request may expand to
+    
+    // Per-request limits: a client must send the whole request within the
+    // timeout (else 408), and headers and body are capped (else 413)
+    int request_timeout_ms = 10000;
+    size_t max_header_bytes = 64 * 1024;
+    size_t max_body_bytes = 256u * 1024u * 1024u;
+    
+    // Directory `data_path` and `regime.model_path` requests may read
+    // from; empty accepts inline `data` and threshold regimes only, so the
+    // server never opens files a client names
+    std::string data_root;
+    
+    // Browser origin allowed to call the server cross-origin (e.g. the web
+    // UI's "https://app.example.com"); empty sends no CORS headers
+    std::string allowed_origin;
+};
+
+// Bars for one dataset plus its indicator cache, shared by all requests.
+// Runs hold cache_mutex shared; adding new series takes it exclusively.
+struct Dataset {
+    std::vector<OHLCV> bars;
+    IndicatorCache cache;
+    std::shared_mutex cache_mutex;
+    uint64_t last_used = 0;
+};
+
+// Long-running backtest process (`fluxback serve`). Speaks a minimal
+// HTTP/1.1 over localhost TCP and/or a Unix socket:
+//   GET  /health
+//   POST /api/backtest  {"strategy": <yaml>, "data": <csv> | "data_path": <path>}
+//   POST /api/sweep     same body, runs the exit-parameter grid
+// `data_path` and the strategy's `regime.model_path` are resolved under
+// ServerOptions::data_root and refused when no root is configured.
+// Parsed bars and indicator caches stay in memory between requests.
+class BacktestServer {
+public:
+    explicit BacktestServer(const ServerOptions& options);
+    ~BacktestServer();
+    
+    // Bind listeners and serve until stop() (or SIGINT/SIGTERM)
+    int run();
+    
+    // Ask a running server to stop; safe to call from any thread
+    void stop();
+    
+    // Handle one request body; exposed for tests and embedding
+    std::string handle(const std::string& method, const std::string& path,
+                       const std::string& body, int& status);
+
+private:
+    ServerOptions options;
+    std::vector<int> listen_fds;
+    std::atomic<bool> stop_requested{false};
+    
+    // Connections are served as tasks on the server's own pool; each
+    // worker reuses one arena for its runs
+    ThreadPool workers;
+    WorkerLocal<RunArena> arenas;
+    TaskGroup connections;
+    
+    std::mutex datasets_mutex;
+    std::unordered_map<std::string, std::shared_ptr<Dataset>> datasets;
+    uint64_t use_counter = 0;
+    
+    std::shared_ptr<Dataset> get_dataset(const std::string& csv_text, const std::string& data_path,
+                                         std::string& error, int& status);
+    bool resolve_data_path(const std::string& requested, std::string& resolved) const;
+    bool load_regime_model(StrategyConfig& config, std::string& error, int& status) const;
+    const IndicatorCache& prepare_cache(Dataset& dataset, const StrategyConfig& config,
+                                        std::shared_lock<std::shared_mutex>& lock);
+    
+    std::string run_backtest(const std::string& body, int& status);
+    std::string run_sweep(const std::string& body, int& status);
+    
+    void shutdown();
+    void serve_connection(int fd);
+    std::string cors_headers(const std::string& origin) const;
+};
+
+} // namespace fluxback
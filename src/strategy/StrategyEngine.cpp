@@ -5,7 +5,9 @@ namespace fluxback {
 
 StrategyEngine::StrategyEngine(const StrategyConfig& cfg)
     : config(cfg), current_position(0), entry_price(0.0), position_opened(false),
-      prev_fast_sma(0.0), prev_slow_sma(0.0), sma_initialized(false) {
+      prev_fast_sma(0.0), prev_slow_sma(0.0), sma_initialized(false),
+      timeframes(nullptr), trend_slot(-1) {
+    orders.reserve(2);
 }
 
 void StrategyEngine::reset() {
@@ -17,14 +19,24 @@ void StrategyEngine::reset() {
     sma_initialized = false;
 }
 
-std::vector<Order> StrategyEngine::on_tick(const OHLCV& tick, IndicatorEngine& ie) {
-    std::vector<Order> orders;
+void StrategyEngine::set_position(int size) {
+    current_position = size;
+    if (size == 0) {
+        entry_price = 0.0;
+        position_opened = false;
+    }
+}
+
+const std::vector<Order>& StrategyEngine::on_tick(const OHLCV& tick, IndicatorEngine& ie,
+                                                  MultiTimeframe* timeframes) {
+    orders.clear();
+    this->timeframes = timeframes;
     
     // Update SMAs for crossover detection
     double fast_sma = ie.get_sma(config.fast_sma);
     double slow_sma = ie.get_sma(config.slow_sma);
     double realized_vol = ie.get_realized_vol(20);
-
+    
     // Volatility filter: skip trading when realized vol above threshold
     if (config.use_vol_filter && realized_vol > config.vol_threshold) {
         // Still update previous SMA state to avoid stale crossover detection
@@ -42,8 +54,7 @@ std::vector<Order> StrategyEngine::on_tick(const OHLCV& tick, IndicatorEngine& i
             // Close position
             Order exit_order(current_position > 0 ? Order::SELL : Order::BUY,
                            std::abs(current_position),
-                           tick.close,
-                           tick.timestamp);
+                           tick.close);
             orders.push_back(exit_order);
             current_position = 0;
             entry_price = 0.0;
@@ -55,13 +66,13 @@ std::vector<Order> StrategyEngine::on_tick(const OHLCV& tick, IndicatorEngine& i
     // Check entry conditions only if flat
     if (current_position == 0 && sma_initialized) {
         if (check_entry_long(tick, ie)) {
-            Order buy_order(Order::BUY, config.position_size, tick.close, tick.timestamp);
+            Order buy_order(Order::BUY, config.position_size, tick.close);
             orders.push_back(buy_order);
             current_position = config.position_size;
             entry_price = tick.close;
             position_opened = true;
         } else if (check_entry_short(tick, ie)) {
-            Order sell_order(Order::SELL, config.position_size, tick.close, tick.timestamp);
+            Order sell_order(Order::SELL, config.position_size, tick.close);
             orders.push_back(sell_order);
             current_position = -config.position_size;
             entry_price = tick.close;
@@ -91,6 +102,8 @@ bool StrategyEngine::check_entry_long(const OHLCV& tick, IndicatorEngine& ie) {
     bool crossover = (prev_fast_sma <= prev_slow_sma) && (fast_sma > slow_sma);
     
     if (!crossover) return false;
+    if (!check_trend_confirms(true)) return false;
+    if (!check_vwap_distance(tick, ie, true)) return false;
     
     // Optional RSI filter
     if (config.use_rsi_filter) {
@@ -116,6 +129,8 @@ bool StrategyEngine::check_entry_short(const OHLCV& tick, IndicatorEngine& ie) {
     bool crossover = (prev_fast_sma >= prev_slow_sma) && (fast_sma < slow_sma);
     
     if (!crossover) return false;
+    if (!check_trend_confirms(false)) return false;
+    if (!check_vwap_distance(tick, ie, false)) return false;
     
     // Optional RSI filter
     if (config.use_rsi_filter) {
@@ -129,6 +144,36 @@ bool StrategyEngine::check_entry_short(const OHLCV& tick, IndicatorEngine& ie) {
     return true;
 }
 
+bool StrategyEngine::check_trend_confirms(bool is_long) {
+    if (config.trend_timeframe_minutes <= 0) return true;
+    if (timeframes == nullptr) return false;
+    
+    if (trend_slot < 0) {
+        trend_slot = timeframes->find(config.trend_timeframe_minutes);
+        if (trend_slot < 0) return false;
+    }
+    
+    const BarAggregator& htf_bars = timeframes->bars(static_cast<size_t>(trend_slot));
+    if (!htf_bars.has_completed()) return false;
+    
+    double htf_close = htf_bars.last_completed().close;
+    double htf_sma = timeframes->indicators(static_cast<size_t>(trend_slot)).get_sma(config.trend_sma);
+    if (htf_sma <= 0.0) return false;
+    
+    return is_long ? htf_close > htf_sma : htf_close < htf_sma;
+}
+
+bool StrategyEngine::check_vwap_distance(const OHLCV& tick, IndicatorEngine& ie, bool is_long) {
+    if (config.vwap.max_entry_sigma <= 0.0) return true;
+    
+    // Don't chase: longs no further above session VWAP than the band,
+    // shorts no further below
+    const SessionProfile& session = ie.get_session();
+    if (session.volume() <= 0.0) return false;
+    return is_long ? tick.close <= session.upper_band(config.vwap.max_entry_sigma)
+                   : tick.close >= session.lower_band(config.vwap.max_entry_sigma);
+}
+
 bool StrategyEngine::check_stop_loss(const OHLCV& tick) {
     if (entry_price <= 0.0) return false;
     
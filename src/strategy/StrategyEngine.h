@@ -3,27 +3,32 @@
 #include "utils/ConfigParser.h"
 #include "data/DataLoader.h"
 #include "indicators/IndicatorEngine.h"
+#include "indicators/MultiTimeframe.h"
 #include <vector>
 
 namespace fluxback {
 
+// Orders are executed on the bar they were made for; the Fill carries
+// that bar's timestamp
 struct Order {
     enum Type { BUY, SELL };
     Type type;
     int size;
     double price;
-    std::string timestamp;
     
-    Order(Type t, int s, double p, const std::string& ts)
-        : type(t), size(s), price(p), timestamp(ts) {}
+    Order(Type t, int s, double p)
+        : type(t), size(s), price(p) {}
 };
 
 class StrategyEngine {
 public:
     explicit StrategyEngine(const StrategyConfig& cfg);
     
-    // Evaluate strategy on new tick and return orders
-    std::vector<Order> on_tick(const OHLCV& tick, IndicatorEngine& ie);
+    // Evaluate strategy on new tick and return orders, valid until the
+    // next call. Higher timeframes are only needed when the config enables
+    // trend confirmation.
+    const std::vector<Order>& on_tick(const OHLCV& tick, IndicatorEngine& ie,
+                                      MultiTimeframe* timeframes = nullptr);
     
     // Get current position state
     bool is_long() const { return current_position > 0; }
@@ -31,11 +36,16 @@ public:
     bool is_flat() const { return current_position == 0; }
     int get_position() const { return current_position; }
     
+    // Override the position after the risk layer resized an entry or
+    // forced an exit; 0 leaves the strategy flat
+    void set_position(int size);
+    
     // Reset strategy state
     void reset();
 
 private:
     StrategyConfig config;
+    std::vector<Order> orders; // reused tick to tick
     int current_position;
     double entry_price;
     bool position_opened;
@@ -45,9 +55,15 @@ private:
     double prev_slow_sma;
     bool sma_initialized;
     
+    // Higher-timeframe state for the current tick
+    MultiTimeframe* timeframes;
+    int trend_slot;
+    
     // Check entry conditions
     bool check_entry_long(const OHLCV& tick, IndicatorEngine& ie);
     bool check_entry_short(const OHLCV& tick, IndicatorEngine& ie);
+    bool check_trend_confirms(bool is_long);
+    bool check_vwap_distance(const OHLCV& tick, IndicatorEngine& ie, bool is_long);
     
     // Check exit conditions
     bool check_stop_loss(const OHLCV& tick);
@@ -0,0 +1,692 @@
+#include "utils/ConfigNode.h"
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace fluxback {
+
+namespace {
+
+// Deepest flow / JSON nesting accepted
+const int MAX_DEPTH = 64;
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+std::string trim(const std::string& str) {
+    size_t first = 0;
+    while (first < str.size() && is_space(str[first])) ++first;
+    size_t last = str.size();
+    while (last > first && is_space(str[last - 1])) --last;
+    return str.substr(first, last - first);
+}
+
+bool parse_number(const std::string& text, double& value) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    value = std::strtod(text.c_str(), &end);
+    return end == text.c_str() + text.size() && std::isfinite(value);
+}
+
+void append_utf8(std::string& out, unsigned long code) {
+    if (code < 0x80) {
+        out += static_cast<char>(code);
+    } else if (code < 0x800) {
+        out += static_cast<char>(0xC0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        out += static_cast<char>(0xE0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (code >> 18));
+        out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+}
+
+// "first..last" or "first..last step s", expanded into a list of scalars.
+// Integer bounds and step give integer values; the last value is included
+// when the step lands on it.
+bool expand_range(const std::string& spec, ConfigNode& out, std::string& error) {
+    std::string bounds = trim(spec);
+    std::string step_text = "1";
+    size_t step_at = bounds.find("step");
+    if (step_at != std::string::npos) {
+        step_text = trim(bounds.substr(step_at + 4));
+        bounds = trim(bounds.substr(0, step_at));
+    }
+    size_t dots = bounds.find("..");
+    std::string first_text = trim(bounds.substr(0, dots));
+    std::string last_text = trim(bounds.substr(dots + 2));
+    
+    double first, last, step;
+    if (!parse_number(first_text, first) || !parse_number(last_text, last) ||
+        !parse_number(step_text, step)) {
+        error = "invalid range [" + spec + "]";
+        return false;
+    }
+    if (step <= 0.0 || last < first) {
+        error = "range [" + spec + "] needs first <= last and a positive step";
+        return false;
+    }
+    double count = std::floor((last - first) / step + 1e-9) + 1.0;
+    if (count > static_cast<double>(ConfigNode::MAX_RANGE)) {
+        error = "range [" + spec + "] has more than " + std::to_string(ConfigNode::MAX_RANGE) + " values";
+        return false;
+    }
+    
+    auto integral = [](const std::string& text) {
+        return text.find_first_of(".eE") == std::string::npos;
+    };
+    const bool integers = integral(first_text) && integral(last_text) && integral(step_text);
+    
+    out.type = ConfigNode::LIST;
+    out.items.resize(static_cast<size_t>(count));
+    char buffer[32];
+    for (size_t k = 0; k < out.items.size(); ++k) {
+        double v = first + static_cast<double>(k) * step; // no accumulated error
+        if (integers) {
+            std::snprintf(buffer, sizeof(buffer), "%lld", std::llround(v));
+        } else {
+            std::snprintf(buffer, sizeof(buffer), "%.12g", v);
+        }
+        out.items[k].type = ConfigNode::SCALAR;
+        out.items[k].value = buffer;
+    }
+    return true;
+}
+
+// One-line YAML flow values: [a, b], {k: v}, [a..b step s], quoted and
+// plain scalars
+class FlowParser {
+public:
+    FlowParser(const std::string& text, std::string& error) : text(text), error(error) {}
+    
+    bool parse(ConfigNode& out) {
+        if (!value(out, 0)) return false;
+        skip();
+        if (pos != text.size()) {
+            error = std::string("unexpected '") + text[pos] + "'";
+            return false;
+        }
+        return true;
+    }
+    
+    // A quoted scalar starting at pos
+    bool quoted(std::string& out) {
+        const char quote = text[pos++];
+        out.clear();
+        while (pos < text.size()) {
+            char c = text[pos++];
+            if (c == quote) {
+                if (quote == '\'' && pos < text.size() && text[pos] == '\'') {
+                    out += '\''; // '' escapes a single quote
+                    ++pos;
+                    continue;
+                }
+                return true;
+            }
+            if (c == '\\' && quote == '"' && pos < text.size()) {
+                char e = text[pos++];
+                switch (e) {
+                    case 'n': out += '\n'; break;
+                    case 't': out += '\t'; break;
+                    case 'r': out += '\r'; break;
+                    default: out += e; break;
+                }
+                continue;
+            }
+            out += c;
+        }
+        error = "unterminated quoted string";
+        return false;
+    }
+    
+    size_t position() const { return pos; }
+
+private:
+    const std::string& text;
+    std::string& error;
+    size_t pos = 0;
+    
+    void skip() {
+        while (pos < text.size() && is_space(text[pos])) ++pos;
+    }
+    
+    bool value(ConfigNode& out, int depth) {
+        if (depth > MAX_DEPTH) {
+            error = "nesting too deep";
+            return false;
+        }
+        skip();
+        if (pos >= text.size()) {
+            error = "missing value";
+            return false;
+        }
+        char c = text[pos];
+        if (c == '[') return list(out, depth);
+        if (c == '{') return map(out, depth);
+        out.type = ConfigNode::SCALAR;
+        if (c == '"' || c == '\'') return quoted(out.value);
+        size_t start = pos;
+        while (pos < text.size() && text[pos] != ',' && text[pos] != ']' && text[pos] != '}') ++pos;
+        out.value = trim(text.substr(start, pos - start));
+        return true;
+    }
+    
+    bool list(ConfigNode& out, int depth) {
+        ++pos; // [
+        size_t close = text.find(']', pos);
+        if (close != std::string::npos) {
+            std::string inner = text.substr(pos, close - pos);
+            if (inner.find("..") != std::string::npos && inner.find_first_of(",[{\"'") == std::string::npos) {
+                pos = close + 1;
+                return expand_range(inner, out, error);
+            }
+        }
+    
+        out.type = ConfigNode::LIST;
+        skip();
+        if (pos < text.size() && text[pos] == ']') {
+            ++pos;
+            return true;
+        }
+        while (true) {
+            ConfigNode item;
+            if (!value(item, depth + 1)) return false;
+            out.items.push_back(std::move(item));
+            skip();
+            if (pos < text.size() && text[pos] == ',') {
+                ++pos;
+            } else if (pos < text.size() && text[pos] == ']') {
+                ++pos;
+                return true;
+            } else {
+                error = "expected ',' or ']'";
+                return false;
+            }
+        }
+    }
+    
+    bool map(ConfigNode& out, int depth) {
+        ++pos; // {
+        out.type = ConfigNode::MAP;
+        skip();
+        if (pos < text.size() && text[pos] == '}') {
+            ++pos;
+            return true;
+        }
+        while (true) {
+            skip();
+            std::string key;
+            if (pos < text.size() && (text[pos] == '"' || text[pos] == '\'')) {
+                if (!quoted(key)) return false;
+                skip();
+            } else {
+                size_t start = pos;
+                while (pos < text.size() && text[pos] != ':' && text[pos] != ',' && text[pos] != '}') ++pos;
+                key = trim(text.substr(start, pos - start));
+            }
+            if (pos >= text.size() || text[pos] != ':' || key.empty()) {
+                error = "expected 'key: value' in flow map";
+                return false;
+            }
+            ++pos;
+            ConfigNode child;
+            if (!value(child, depth + 1)) return false;
+            if (out.find(key)) {
+                error = "duplicate key '" + key + "'";
+                return false;
+            }
+            out.fields.emplace_back(key, std::move(child));
+            skip();
+            if (pos < text.size() && text[pos] == ',') {
+                ++pos;
+            } else if (pos < text.size() && text[pos] == '}') {
+                ++pos;
+                return true;
+            } else {
+                error = "expected ',' or '}'";
+                return false;
+            }
+        }
+    }
+};
+
+struct YamlLine {
+    size_t indent;
+    std::string content;
+    size_t number; // 1-based, for errors
+};
+
+// Block-structured YAML: each block is a map or a list at one indentation
+class YamlParser {
+public:
+    explicit YamlParser(std::string& error) : error(error) {}
+    
+    bool parse(const std::string& text, ConfigNode& root) {
+        if (!split_lines(text)) return false;
+        root = ConfigNode();
+        if (lines.empty()) return true;
+        if (!block(lines[0].indent, root)) return false;
+        if (pos < lines.size()) return fail(pos, "unexpected indentation");
+        return true;
+    }
+
+private:
+    std::vector<YamlLine> lines;
+    size_t pos = 0;
+    std::string& error;
+    
+    bool fail(size_t index, const std::string& message) {
+        size_t number = index < lines.size() ? lines[index].number : 0;
+        error = "line " + std::to_string(number) + ": " + message;
+        return false;
+    }
+    
+    // A quote opens only at the start of a token, so apostrophes inside
+    // plain scalars don't hide a later comment
+    static std::string strip_comment(const std::string& line) {
+        char quote = 0;
+        for (size_t i = 0; i < line.size(); ++i) {
+            char c = line[i];
+            bool token_start = i == 0 || line[i - 1] == ' ' || line[i - 1] == '\t' ||
+                               line[i - 1] == ':' || line[i - 1] == '[' ||
+                               line[i - 1] == '{' || line[i - 1] == ',';
+            if (quote) {
+                if (c == '\\' && quote == '"') {
+                    ++i;
+                } else if (c == quote) {
+                    quote = 0;
+                }
+            } else if ((c == '"' || c == '\'') && token_start) {
+                quote = c;
+            } else if (c == '#' && (i == 0 || line[i - 1] == ' ' || line[i - 1] == '\t')) {
+                return line.substr(0, i);
+            }
+        }
+        return line;
+    }
+    
+    bool split_lines(const std::string& text) {
+        size_t start = 0;
+        size_t number = 0;
+        while (start <= text.size()) {
+            size_t end = text.find('\n', start);
+            if (end == std::string::npos) end = text.size();
+            std::string raw = text.substr(start, end - start);
+            start = end + 1;
+            ++number;
+    
+            std::string line = strip_comment(raw);
+            while (!line.empty() && is_space(line.back())) line.pop_back();
+            size_t indent = line.find_first_not_of(' ');
+            if (indent == std::string::npos) continue;
+            if (line[indent] == '\t') {
+                lines.push_back({indent, "", number});
+                return fail(lines.size() - 1, "tabs are not allowed in indentation");
+            }
+            std::string content = line.substr(indent);
+            if (indent == 0 && (content == "---" || content == "...")) continue;
+            lines.push_back({indent, content, number});
+        }
+        return true;
+    }
+    
+    static bool is_list_item(const std::string& content) {
+        return content == "-" || content.compare(0, 2, "- ") == 0;
+    }
+    
+    // Split "key: value" at the first ': ' (or trailing ':') outside quotes
+    // and brackets
+    static bool split_key(const std::string& content, std::string& key, std::string& rest) {
+        char quote = 0;
+        int depth = 0;
+        for (size_t i = 0; i < content.size(); ++i) {
+            char c = content[i];
+            if (quote) {
+                if (c == quote) quote = 0;
+                continue;
+            }
+            if ((c == '"' || c == '\'') && i == 0) {
+                quote = c;
+            } else if (c == '[' || c == '{') {
+                ++depth;
+            } else if (c == ']' || c == '}') {
+                --depth;
+            } else if (c == ':' && depth == 0 && (i + 1 == content.size() || content[i + 1] == ' ')) {
+                key = trim(content.substr(0, i));
+                rest = trim(content.substr(i + 1));
+                if (key.size() >= 2 && (key[0] == '"' || key[0] == '\'') && key.back() == key[0]) {
+                    key = key.substr(1, key.size() - 2);
+                }
+                return !key.empty();
+            }
+        }
+        return false;
+    }
+    
+    bool block(size_t indent, ConfigNode& out) {
+        return is_list_item(lines[pos].content) ? list(indent, out) : map(indent, out);
+    }
+    
+    // The block under a key with no inline value: deeper lines, or a list
+    // at the key's own indentation
+    bool nested(size_t indent, ConfigNode& out, bool same_indent_list) {
+        if (pos >= lines.size()) return true;
+        const YamlLine& next = lines[pos];
+        if (next.indent > indent) return block(next.indent, out);
+        if (same_indent_list && next.indent == indent && is_list_item(next.content)) {
+            return list(indent, out);
+        }
+        return true; // empty value
+    }
+    
+    bool map(size_t indent, ConfigNode& out) {
+        out.type = ConfigNode::MAP;
+        while (pos < lines.size()) {
+            const YamlLine& line = lines[pos];
+            if (line.indent < indent) break;
+            if (line.indent > indent) return fail(pos, "unexpected indentation");
+            if (is_list_item(line.content)) return fail(pos, "list item where a key was expected");
+    
+            std::string key, rest;
+            if (!split_key(line.content, key, rest)) return fail(pos, "expected 'key: value'");
+            if (out.find(key)) return fail(pos, "duplicate key '" + key + "'");
+            ConfigNode child;
+            size_t index = pos++;
+            if (rest.empty()) {
+                if (!nested(indent, child, true)) return false;
+            } else if (!inline_value(rest, child, index)) {
+                return false;
+            }
+            out.fields.emplace_back(key, std::move(child));
+        }
+        return true;
+    }
+    
+    bool list(size_t indent, ConfigNode& out) {
+        out.type = ConfigNode::LIST;
+        while (pos < lines.size()) {
+            YamlLine& line = lines[pos];
+            if (line.indent < indent) break;
+            if (line.indent > indent) return fail(pos, "unexpected indentation");
+            if (!is_list_item(line.content)) break;
+    
+            ConfigNode item;
+            size_t offset = line.content.find_first_not_of(' ', 1);
+            if (offset == std::string::npos) {
+                ++pos;
+                if (!nested(indent, item, false)) return false;
+            } else {
+                std::string rest = line.content.substr(offset);
+                std::string key, value;
+                bool flow = rest[0] == '[' || rest[0] == '{' || rest[0] == '"' || rest[0] == '\'';
+                if (is_list_item(rest) || (!flow && split_key(rest, key, value))) {
+                    // A map or list opening on the dash line continues at its column
+                    line.indent += offset;
+                    line.content = rest;
+                    if (!block(line.indent, item)) return false;
+                } else if (!inline_value(rest, item, pos++)) {
+                    return false;
+                }
+            }
+            out.items.push_back(std::move(item));
+        }
+        return true;
+    }
+    
+    bool inline_value(const std::string& text, ConfigNode& out, size_t index) {
+        char c = text[0];
+        if (c == '[' || c == '{') {
+            FlowParser flow(text, error);
+            return flow.parse(out) || fail(index, error);
+        }
+        if (c == '"' || c == '\'') {
+            FlowParser flow(text, error);
+            out.type = ConfigNode::SCALAR;
+            if (!flow.quoted(out.value)) return fail(index, error);
+            if (flow.position() != text.size()) return fail(index, "text after quoted string");
+            return true;
+        }
+        if (c == '|' || c == '>') return fail(index, "block scalars are not supported");
+        if (text == "~" || text == "null") return true; // NONE
+        out.type = ConfigNode::SCALAR;
+        out.value = text;
+        return true;
+    }
+};
+
+class JsonParser {
+public:
+    JsonParser(const std::string& text, std::string& error) : text(text), error(error) {}
+    
+    bool parse(ConfigNode& root) {
+        root = ConfigNode();
+        if (!value(root, 0)) return fail(error);
+        skip();
+        if (pos != text.size()) return fail("unexpected text after the document");
+        return true;
+    }
+
+private:
+    const std::string& text;
+    std::string& error;
+    size_t pos = 0;
+    
+    bool fail(const std::string& message) {
+        size_t line = 1;
+        for (size_t i = 0; i < pos && i < text.size(); ++i) {
+            if (text[i] == '\n') ++line;
+        }
+        error = "line " + std::to_string(line) + ": " + message;
+        return false;
+    }
+    
+    void skip() {
+        while (pos < text.size() && is_space(text[pos])) ++pos;
+    }
+    
+    bool literal(const char* word) {
+        size_t n = std::char_traits<char>::length(word);
+        if (text.compare(pos, n, word) != 0) return false;
+        pos += n;
+        return true;
+    }
+    
+    bool value(ConfigNode& out, int depth) {
+        if (depth > MAX_DEPTH) {
+            error = "nesting too deep";
+            return false;
+        }
+        skip();
+        if (pos >= text.size()) {
+            error = "unexpected end of input";
+            return false;
+        }
+        char c = text[pos];
+        if (c == '{') return object(out, depth);
+        if (c == '[') return array(out, depth);
+        if (c == '"') {
+            out.type = ConfigNode::SCALAR;
+            return string(out.value);
+        }
+        if (literal("true") || literal("false")) {
+            out.type = ConfigNode::SCALAR;
+            out.value = text[pos - 2] == 'u' ? "true" : "false"; // tr[u]e / fal[s]e
+            return true;
+        }
+        if (literal("null")) return true; // NONE
+    
+        size_t start = pos;
+        while (pos < text.size() && (std::isdigit(static_cast<unsigned char>(text[pos])) ||
+                                     text[pos] == '-' || text[pos] == '+' || text[pos] == '.' ||
+                                     text[pos] == 'e' || text[pos] == 'E')) {
+            ++pos;
+        }
+        double number;
+        out.type = ConfigNode::SCALAR;
+        out.value = text.substr(start, pos - start);
+        if (!parse_number(out.value, number)) {
+            pos = start;
+            error = "invalid value";
+            return false;
+        }
+        return true;
+    }
+    
+    bool hex4(unsigned long& code) {
+        if (pos + 4 > text.size()) return false;
+        code = 0;
+        for (int i = 0; i < 4; ++i) {
+            char h = text[pos++];
+            code <<= 4;
+            if (h >= '0' && h <= '9') code |= static_cast<unsigned long>(h - '0');
+            else if (h >= 'a' && h <= 'f') code |= static_cast<unsigned long>(h - 'a' + 10);
+            else if (h >= 'A' && h <= 'F') code |= static_cast<unsigned long>(h - 'A' + 10);
+            else return false;
+        }
+        return true;
+    }
+    
+    bool string(std::string& out) {
+        ++pos; // "
+        out.clear();
+        while (pos < text.size()) {
+            char c = text[pos++];
+            if (c == '"') return true;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= text.size()) break;
+            char e = text[pos++];
+            switch (e) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    unsigned long code;
+                    if (!hex4(code)) {
+                        error = "invalid \\u escape";
+                        return false;
+                    }
+                    // Surrogate pair
+                    if (code >= 0xD800 && code < 0xDC00 && text.compare(pos, 2, "\\u") == 0) {
+                        pos += 2;
+                        unsigned long low;
+                        if (!hex4(low) || low < 0xDC00 || low > 0xDFFF) {
+                            error = "invalid surrogate pair";
+                            return false;
+                        }
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    append_utf8(out, code);
+                    break;
+                }
+                default:
+                    error = std::string("invalid escape '\\") + e + "'";
+                    return false;
+            }
+        }
+        error = "unterminated string";
+        return false;
+    }
+    
+    bool array(ConfigNode& out, int depth) {
+        ++pos; // [
+        out.type = ConfigNode::LIST;
+        skip();
+        if (pos < text.size() && text[pos] == ']') {
+            ++pos;
+            return true;
+        }
+        while (true) {
+            ConfigNode item;
+            if (!value(item, depth + 1)) return false;
+            out.items.push_back(std::move(item));
+            skip();
+            if (pos < text.size() && text[pos] == ',') {
+                ++pos;
+            } else if (pos < text.size() && text[pos] == ']') {
+                ++pos;
+                return true;
+            } else {
+                error = "expected ',' or ']'";
+                return false;
+            }
+        }
+    }
+    
+    bool object(ConfigNode& out, int depth) {
+        ++pos; // {
+        out.type = ConfigNode::MAP;
+        skip();
+        if (pos < text.size() && text[pos] == '}') {
+            ++pos;
+            return true;
+        }
+        while (true) {
+            skip();
+            std::string key;
+            if (pos >= text.size() || text[pos] != '"') {
+                error = "expected a quoted key";
+                return false;
+            }
+            if (!string(key)) return false;
+            skip();
+            if (pos >= text.size() || text[pos] != ':') {
+                error = "expected ':'";
+                return false;
+            }
+            ++pos;
+            ConfigNode child;
+            if (!value(child, depth + 1)) return false;
+            if (out.find(key)) {
+                error = "duplicate key '" + key + "'";
+                return false;
+            }
+            out.fields.emplace_back(key, std::move(child));
+            skip();
+            if (pos < text.size() && text[pos] == ',') {
+                ++pos;
+            } else if (pos < text.size() && text[pos] == '}') {
+                ++pos;
+                return true;
+            } else {
+                error = "expected ',' or '}'";
+                return false;
+            }
+        }
+    }
+};
+
+} // namespace
+
+const ConfigNode* ConfigNode::find(const std::string& key) const {
+    for (const auto& field : fields) {
+        if (field.first == key) return &field.second;
+    }
+    return nullptr;
+}
+
+bool ConfigNode::parse_yaml(const std::string& text, ConfigNode& root, std::string& error) {
+    YamlParser parser(error);
+    return parser.parse(text, root);
+}
+
+bool ConfigNode::parse_json(const std::string& text, ConfigNode& root, std::string& error) {
+    JsonParser parser(text, error);
+    return parser.parse(root);
+}
+
+} // namespace fluxback
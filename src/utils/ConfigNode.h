@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fluxback {
+
+// A parsed config document: nested maps, lists and scalars. Scalars keep
+// their source text (unquoted); converting them is up to the reader.
+struct ConfigNode {
+    enum Type { NONE, SCALAR, LIST, MAP };
+    
+    Type type = NONE;
+    std::string value;                                      // SCALAR
+    std::vector<ConfigNode> items;                          // LIST
+    std::vector<std::pair<std::string, ConfigNode>> fields; // MAP, in document order
+    
+    // Field `key` of a map, or nullptr
+    const ConfigNode* find(const std::string& key) const;
+    
+    // YAML subset: block maps and lists by indentation, `#` comments, quoted
+    // scalars, one-line flow lists and maps ([a, b], {k: v}), and ranges
+    // ([5..50 step 5], step defaults to 1) expanded into lists.
+    // Errors carry the line number.
+    static bool parse_yaml(const std::string& text, ConfigNode& root, std::string& error);
+    
+    // JSON; numbers and true / false become scalars, null becomes NONE
+    static bool parse_json(const std::string& text, ConfigNode& root, std::string& error);
+    
+    // Largest list a range may expand into
+    static constexpr size_t MAX_RANGE = 1000000;
+};
+
+} // namespace fluxback
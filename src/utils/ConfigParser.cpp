@@ -1,166 +1,420 @@
 #include "utils/ConfigParser.h"
-#include <fstream>
-#include <sstream>
+#include "utils/ConfigNode.h"
+#include "utils/Timestamp.h"
+#include "regime/RegimeModel.h"
+#include "execution/CostModel.h"
+#include "data/SessionCalendar.h"
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
 
 namespace fluxback {
 
-std::string ConfigParser::trim(const std::string& str) {
-    size_t first = str.find_first_not_of(" \t\n\r");
-    if (first == std::string::npos) return "";
-    size_t last = str.find_last_not_of(" \t\n\r");
-    return str.substr(first, (last - first + 1));
+namespace {
+
+using Setter = void (*)(StrategyConfig&, const std::string&, double);
+
+// A config key: the section it lives in, whether its value must be
+// numeric, and whether it may be swept
+struct FieldSpec {
+    const char* section;
+    const char* key;
+    bool numeric;
+    bool sweepable;
+    Setter apply;
+};
+
+bool truthy(const std::string& text) {
+    return text == "true" || text == "1";
 }
 
-std::string ConfigParser::get_value(const std::string& line, const std::string& key) {
-    size_t pos = line.find(key + ":");
-    if (pos == std::string::npos) return "";
+const FieldSpec FIELDS[] = {
+    {"strategy", "name", false, false, [](StrategyConfig& c, const std::string& t, double) { c.name = t; }},
+    {"strategy", "type", false, false, [](StrategyConfig& c, const std::string& t, double) { c.type = t; }},
+    {"strategy", "symbol", false, false, [](StrategyConfig& c, const std::string& t, double) { c.symbol = t; }},
+    {"strategy", "timeframe", false, false, [](StrategyConfig& c, const std::string& t, double) { c.timeframe = t; }},
+    {"strategy", "exclude_volatile_regime", false, true,
+     [](StrategyConfig& c, const std::string& t, double) { c.exclude_volatile_regime = truthy(t); }},
     
-    size_t start = pos + key.length() + 1;
-    std::string value = line.substr(start);
-    value = trim(value);
+    {"entry", "fast", true, true, [](StrategyConfig& c, const std::string&, double v) { c.fast_sma = static_cast<int>(v); }},
+    {"entry", "fast_sma", true, true, [](StrategyConfig& c, const std::string&, double v) { c.fast_sma = static_cast<int>(v); }},
+    {"entry", "slow", true, true, [](StrategyConfig& c, const std::string&, double v) { c.slow_sma = static_cast<int>(v); }},
+    {"entry", "slow_sma", true, true, [](StrategyConfig& c, const std::string&, double v) { c.slow_sma = static_cast<int>(v); }},
+    {"entry", "rsi_overbought", true, true, [](StrategyConfig& c, const std::string&, double v) {
+        c.rsi_overbought = v;
+        c.use_rsi_filter = true;
+    }},
+    {"entry", "rsi_oversold", true, true, [](StrategyConfig& c, const std::string&, double v) {
+        c.rsi_oversold = v;
+        c.use_rsi_filter = true;
+    }},
+    {"entry", "vol_threshold", true, true, [](StrategyConfig& c, const std::string&, double v) {
+        c.vol_threshold = v;
+        c.use_vol_filter = true;
+    }},
+    {"entry", "trend_timeframe", false, true, [](StrategyConfig& c, const std::string& t, double) {
+        c.trend_timeframe_minutes = parse_timeframe_minutes(t);
+    }},
+    {"entry", "trend_sma", true, true, [](StrategyConfig& c, const std::string&, double v) { c.trend_sma = static_cast<int>(v); }},
+    {"entry", "exclude_volatile_regime", false, true,
+     [](StrategyConfig& c, const std::string& t, double) { c.exclude_volatile_regime = truthy(t); }},
     
-    // Remove quotes if present
-    if (value.front() == '"' && value.back() == '"') {
-        value = value.substr(1, value.length() - 2);
-    }
+    {"exit", "stop_loss_pct", true, true, [](StrategyConfig& c, const std::string&, double v) { c.stop_loss_pct = v; }},
+    {"exit", "take_profit_pct", true, true, [](StrategyConfig& c, const std::string&, double v) { c.take_profit_pct = v; }},
     
-    return value;
-}
+    {"risk", "position_size", true, true, [](StrategyConfig& c, const std::string&, double v) { c.position_size = static_cast<int>(v); }},
+    {"risk", "lots", false, true, [](StrategyConfig& c, const std::string& t, double) {
+        if (t == "fifo") {
+            c.lots = StrategyConfig::LotMethod::FIFO;
+        } else if (t == "average") {
+            c.lots = StrategyConfig::LotMethod::AVERAGE;
+        } else {
+            std::cerr << "Warning: unknown lot method '" << t << "', using fifo" << std::endl;
+        }
+    }},
+    {"risk", "target_vol", true, true, [](StrategyConfig& c, const std::string&, double v) { c.risk.target_vol = v; }},
+    {"risk", "max_symbol_exposure", true, true, [](StrategyConfig& c, const std::string&, double v) { c.risk.max_symbol_exposure = v; }},
+    {"risk", "max_gross_exposure", true, true, [](StrategyConfig& c, const std::string&, double v) { c.risk.max_gross_exposure = v; }},
+    {"risk", "max_net_exposure", true, true, [](StrategyConfig& c, const std::string&, double v) { c.risk.max_net_exposure = v; }},
+    {"risk", "max_leverage", true, true, [](StrategyConfig& c, const std::string&, double v) { c.risk.max_leverage = v; }},
+    {"risk", "max_drawdown_pct", true, true, [](StrategyConfig& c, const std::string&, double v) { c.risk.max_drawdown_pct = v; }},
+    
+    {"slippage", "type", false, true, [](StrategyConfig& c, const std::string& t, double) { c.slippage.type = t; }},
+    {"slippage", "base_ticks", true, true, [](StrategyConfig& c, const std::string&, double v) { c.slippage.base_ticks = static_cast<int>(v); }},
+    {"slippage", "vol_multiplier", true, true, [](StrategyConfig& c, const std::string&, double v) { c.slippage.vol_multiplier = v; }},
+    {"slippage", "vol_low", true, true, [](StrategyConfig& c, const std::string&, double v) { c.slippage.vol_low = v; }},
+    {"slippage", "vol_high", true, true, [](StrategyConfig& c, const std::string&, double v) { c.slippage.vol_high = v; }},
+    {"slippage", "low_factor", true, true, [](StrategyConfig& c, const std::string&, double v) { c.slippage.low_factor = v; }},
+    {"slippage", "high_factor", true, true, [](StrategyConfig& c, const std::string&, double v) { c.slippage.high_factor = v; }},
+    
+    {"costs", "venue", false, false, [](StrategyConfig& c, const std::string& t, double) {
+        if (!CostModel::apply_venue(t, c.costs)) {
+            std::cerr << "Warning: unknown cost venue '" << t << "'" << std::endl;
+        }
+    }},
+    {"costs", "commission_per_share", true, true, [](StrategyConfig& c, const std::string&, double v) { c.costs.commission_per_share = v; }},
+    {"costs", "commission_bps", true, true, [](StrategyConfig& c, const std::string&, double v) { c.costs.commission_bps = v; }},
+    {"costs", "commission_min", true, true, [](StrategyConfig& c, const std::string&, double v) { c.costs.commission_min = v; }},
+    {"costs", "commission_max_pct", true, true, [](StrategyConfig& c, const std::string&, double v) { c.costs.commission_max_pct = v; }},
+    {"costs", "commission_tiers", false, false, [](StrategyConfig& c, const std::string& t, double) {
+        if (!CostModel::parse_tiers(t, c.costs)) {
+            std::cerr << "Warning: invalid commission_tiers '" << t << "'" << std::endl;
+        }
+    }},
+    {"costs", "exchange_fee_per_share", true, true, [](StrategyConfig& c, const std::string&, double v) { c.costs.exchange_fee_per_share = v; }},
+    {"costs", "exchange_fee_bps", true, true, [](StrategyConfig& c, const std::string&, double v) { c.costs.exchange_fee_bps = v; }},
+    {"costs", "sell_fee_bps", true, true, [](StrategyConfig& c, const std::string&, double v) { c.costs.sell_fee_bps = v; }},
+    {"costs", "borrow_rate_pct", true, true, [](StrategyConfig& c, const std::string&, double v) { c.costs.borrow_rate_pct = v; }},
+    {"costs", "financing_rate_pct", true, true, [](StrategyConfig& c, const std::string&, double v) { c.costs.financing_rate_pct = v; }},
+    
+    {"vwap", "max_entry_sigma", true, true, [](StrategyConfig& c, const std::string&, double v) { c.vwap.max_entry_sigma = v; }},
+    {"vwap", "benchmark", false, true, [](StrategyConfig& c, const std::string& t, double) { c.vwap.benchmark = truthy(t); }},
+    {"vwap", "bucket_pct", true, true, [](StrategyConfig& c, const std::string&, double v) { c.vwap.bucket_pct = v; }},
+    
+    {"calendar", "market", false, false, [](StrategyConfig& c, const std::string& t, double) {
+        if (!SessionCalendar::apply_market(t, c.calendar)) {
+            std::cerr << "Warning: unknown market '" << t << "'" << std::endl;
+        }
+    }},
+    {"calendar", "session", false, true, [](StrategyConfig& c, const std::string& t, double) {
+        if (!SessionCalendar::parse_session(t, c.calendar)) {
+            std::cerr << "Warning: invalid session '" << t << "', expected HH:MM-HH:MM" << std::endl;
+        }
+    }},
+    {"calendar", "days_per_year", true, true, [](StrategyConfig& c, const std::string&, double v) { c.calendar.days_per_year = v; }},
+    
+    {"regime", "model", false, false, [](StrategyConfig& c, const std::string& t, double) { c.regime.model = t; }},
+    {"regime", "model_path", false, false, [](StrategyConfig& c, const std::string& t, double) { c.regime.model_path = t; }},
+};
 
-int ConfigParser::get_int_value(const std::string& line, const std::string& key, int default_val) {
-    std::string val = get_value(line, key);
-    if (val.empty()) return default_val;
-    try {
-        return std::stoi(val);
-    } catch (...) {
-        return default_val;
+const FieldSpec* find_field(const std::string& section, const std::string& key) {
+    for (const FieldSpec& field : FIELDS) {
+        if (section == field.section && key == field.key) return &field;
     }
+    return nullptr;
 }
 
-double ConfigParser::get_double_value(const std::string& line, const std::string& key, double default_val) {
-    std::string val = get_value(line, key);
-    if (val.empty()) return default_val;
-    try {
-        return std::stod(val);
-    } catch (...) {
-        return default_val;
+// Section a nested map's fields belong to. Sections may nest in any order
+// (sma_demo.yaml puts entry: and exit: under strategy:); execution: holds
+// slippage keys directly or under slippage:
+std::string section_for(const std::string& key) {
+    if (key == "execution") return "slippage";
+    for (const char* section : {"strategy", "entry", "exit", "risk", "slippage", "costs", "vwap", "calendar", "regime"}) {
+        if (key == section) return key;
     }
+    return "";
 }
 
-std::string ConfigParser::get_string_value(const std::string& line, const std::string& key, const std::string& default_val) {
-    std::string val = get_value(line, key);
-    return val.empty() ? default_val : val;
+double to_number(const std::string& text) {
+    char* end = nullptr;
+    double value = std::strtod(text.c_str(), &end);
+    if (text.empty() || end != text.c_str() + text.size() || !std::isfinite(value)) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return value;
 }
 
-StrategyConfig ConfigParser::parse_yaml_simple(const std::string& yaml_path) {
-    StrategyConfig config;
-    std::ifstream file(yaml_path);
+bool visit(const ConfigNode& node, const std::string& section, const std::string& path,
+           ConfigGrid& grid, std::string& error) {
+    // A venue or market preset replaces the whole fee schedule / session,
+    // so it goes before the keys that override it
+    std::vector<const std::pair<std::string, ConfigNode>*> fields;
+    for (const auto& entry : node.fields) fields.push_back(&entry);
+    std::stable_partition(fields.begin(), fields.end(), [](const auto* entry) {
+        return entry->first == "venue" || entry->first == "market";
+    });
     
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open config file: " << yaml_path << std::endl;
-        return config;
-    }
-    
-    std::string line;
-    std::string current_section;
-    
-    while (std::getline(file, line)) {
-        line = trim(line);
-        if (line.empty() || line[0] == '#') continue;
+    for (const auto* entry : fields) {
+        const std::string& key = entry->first;
+        const ConfigNode& child = entry->second;
+        std::string child_path = path.empty() ? key : path + "." + key;
+        if (child.type == ConfigNode::NONE) continue;
         
-        // Detect sections
-        if (line.find("strategy:") != std::string::npos) {
-            current_section = "strategy";
-            continue;
-        } else if (line.find("risk:") != std::string::npos) {
-            current_section = "risk";
-            continue;
-        } else if (line.find("execution:") != std::string::npos) {
-            current_section = "execution";
-            continue;
-        } else if (line.find("entry:") != std::string::npos) {
-            current_section = "entry";
+        if (child.type == ConfigNode::MAP) {
+            std::string child_section = section_for(key);
+            if (child_section.empty()) {
+                std::cerr << "Warning: unknown config section '" << child_path << "'" << std::endl;
+            } else if (!visit(child, child_section, child_path, grid, error)) {
+                return false;
+            }
             continue;
-        } else if (line.find("exit:") != std::string::npos) {
-            current_section = "exit";
+        }
+        
+        const FieldSpec* field = find_field(section, key);
+        if (!field) {
+            std::cerr << "Warning: unknown config key '" << child_path << "'" << std::endl;
             continue;
         }
         
-        // Parse fields
-        if (current_section == "strategy") {
-            if (line.find("name:") != std::string::npos) {
-                config.name = get_string_value(line, "name");
-            } else if (line.find("type:") != std::string::npos) {
-                config.type = get_string_value(line, "type");
-            } else if (line.find("symbol:") != std::string::npos) {
-                config.symbol = get_string_value(line, "symbol");
-            } else if (line.find("timeframe:") != std::string::npos) {
-                config.timeframe = get_string_value(line, "timeframe");
-            }
-        } else if (current_section == "entry") {
-            if (line.find("fast:") != std::string::npos) {
-                config.fast_sma = get_int_value(line, "fast", 10);
-            } else if (line.find("slow:") != std::string::npos) {
-                config.slow_sma = get_int_value(line, "slow", 20);
-            } else if (line.find("rsi_overbought:") != std::string::npos) {
-                config.rsi_overbought = get_double_value(line, "rsi_overbought", 70.0);
-                config.use_rsi_filter = true;
-            } else if (line.find("rsi_oversold:") != std::string::npos) {
-                config.rsi_oversold = get_double_value(line, "rsi_oversold", 30.0);
-                config.use_rsi_filter = true;
-            } else if (line.find("vol_threshold:") != std::string::npos) {
-                config.vol_threshold = get_double_value(line, "vol_threshold", 0.05);
-                config.use_vol_filter = true;
+        SweepAxis axis;
+        axis.key = child_path;
+        axis.apply = field->apply;
+        if (child.type == ConfigNode::SCALAR) {
+            axis.text.push_back(child.value);
+        } else {
+            for (const ConfigNode& item : child.items) {
+                if (item.type != ConfigNode::SCALAR) {
+                    error = "'" + child_path + "' values must be scalars";
+                    return false;
+                }
+                axis.text.push_back(item.value);
             }
-        } else if (current_section == "exit") {
-            if (line.find("stop_loss_pct:") != std::string::npos) {
-                config.stop_loss_pct = get_double_value(line, "stop_loss_pct", 0.5);
-            } else if (line.find("take_profit_pct:") != std::string::npos) {
-                config.take_profit_pct = get_double_value(line, "take_profit_pct", 1.0);
+            if (axis.text.empty()) {
+                error = "'" + child_path + "' has an empty list";
+                return false;
             }
-        } else if (current_section == "risk") {
-            if (line.find("position_size:") != std::string::npos) {
-                config.position_size = get_int_value(line, "position_size", 100);
+            if (axis.text.size() > 1 && !field->sweepable) {
+                error = "'" + child_path + "' cannot be swept";
+                return false;
             }
-        } else if (current_section == "execution") {
-            if (line.find("type:") != std::string::npos) {
-                config.slippage.type = get_string_value(line, "type", "fixed");
-            } else if (line.find("base_ticks:") != std::string::npos) {
-                config.slippage.base_ticks = get_int_value(line, "base_ticks", 1);
-            } else if (line.find("vol_multiplier:") != std::string::npos) {
-                config.slippage.vol_multiplier = get_double_value(line, "vol_multiplier", 0.001);
-            } else if (line.find("vol_low:") != std::string::npos) {
-                config.slippage.vol_low = get_double_value(line, "vol_low", 0.01);
-            } else if (line.find("vol_high:") != std::string::npos) {
-                config.slippage.vol_high = get_double_value(line, "vol_high", 0.05);
-            } else if (line.find("low_factor:") != std::string::npos) {
-                config.slippage.low_factor = get_double_value(line, "low_factor", 0.5);
-            } else if (line.find("high_factor:") != std::string::npos) {
-                config.slippage.high_factor = get_double_value(line, "high_factor", 1.5);
-            }
-        } else if (current_section == "strategy") {
-            if (line.find("exclude_volatile_regime:") != std::string::npos) {
-                std::string val = get_string_value(line, "exclude_volatile_regime", "false");
-                config.exclude_volatile_regime = (val == "true" || val == "1");
+        }
+        for (const std::string& text : axis.text) {
+            axis.number.push_back(to_number(text));
+            if (field->numeric && std::isnan(axis.number.back())) {
+                error = "'" + child_path + "' expects a number, got '" + text + "'";
+                return false;
             }
         }
+        
+        if (axis.text.size() == 1) {
+            axis.apply(grid.base, axis.text[0], axis.number[0]);
+        } else {
+            grid.axes.push_back(std::move(axis));
+        }
+    }
+    return true;
+}
+
+// Parsed grids, so repeated loads of one file or request body skip the parse
+struct CachedGrid {
+    uintmax_t size = 0;
+    long long mtime = 0;
+    std::shared_ptr<const ConfigGrid> grid;
+};
+
+const size_t MAX_CACHED_GRIDS = 64;
+
+std::mutex grid_cache_mutex;
+std::unordered_map<std::string, CachedGrid> file_grids;
+std::unordered_map<std::string, std::shared_ptr<const ConfigGrid>> text_grids[2]; // by load_models
+
+bool looks_like_json(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t\r\n");
+    return first != std::string::npos && text[first] == '{';
+}
+
+} // namespace
+
+size_t ConfigGrid::size() const {
+    size_t count = 1;
+    for (const SweepAxis& axis : axes) {
+        count *= axis.text.size();
+    }
+    return count;
+}
+
+StrategyConfig ConfigGrid::at(size_t index) const {
+    StrategyConfig config = base;
+    for (size_t a = axes.size(); a-- > 0;) {
+        const SweepAxis& axis = axes[a];
+        size_t i = index % axis.text.size();
+        index /= axis.text.size();
+        axis.apply(config, axis.text[i], axis.number[i]);
     }
-    
-    file.close();
     return config;
 }
 
+std::string ConfigGrid::label(size_t index) const {
+    std::string text;
+    for (size_t a = axes.size(); a-- > 0;) {
+        const SweepAxis& axis = axes[a];
+        size_t i = index % axis.text.size();
+        index /= axis.text.size();
+        text.insert(0, (a > 0 ? "," : "") + axis.key + "=" + axis.text[i]);
+    }
+    return text;
+}
+
+std::vector<StrategyConfig> ConfigGrid::expand() const {
+    const size_t count = size();
+    std::vector<StrategyConfig> grid;
+    grid.reserve(count);
+    
+    // Odometer over the axes, last axis fastest
+    std::vector<size_t> digit(axes.size(), 0);
+    for (size_t n = 0; n < count; ++n) {
+        grid.push_back(base);
+        StrategyConfig& config = grid.back();
+        for (size_t a = 0; a < axes.size(); ++a) {
+            axes[a].apply(config, axes[a].text[digit[a]], axes[a].number[digit[a]]);
+        }
+        for (size_t a = axes.size(); a-- > 0;) {
+            if (++digit[a] < axes[a].text.size()) break;
+            digit[a] = 0;
+        }
+    }
+    return grid;
+}
+
+bool ConfigParser::build_grid(const ConfigNode& root, ConfigGrid& grid, std::string& error,
+                              bool load_models) {
+    if (root.type != ConfigNode::MAP) {
+        error = "expected a map of config sections";
+        return false;
+    }
+    grid = ConfigGrid();
+    if (!visit(root, "", "", grid, error)) return false;
+    if (load_models) {
+        load_regime_model(grid.base); // once, shared by every config of the grid
+    }
+    return true;
+}
+
+std::shared_ptr<const ConfigGrid> ConfigParser::parse_text(const std::string& text, bool json,
+                                                           const std::string& source, bool load_models) {
+    ConfigNode root;
+    std::string error;
+    bool parsed = json ? ConfigNode::parse_json(text, root, error)
+                       : ConfigNode::parse_yaml(text, root, error);
+    auto grid = std::make_shared<ConfigGrid>();
+    if (!parsed || !build_grid(root, *grid, error, load_models)) {
+        std::cerr << "Error: " << source << ": " << error << std::endl;
+        return nullptr;
+    }
+    return grid;
+}
+
+std::shared_ptr<const ConfigGrid> ConfigParser::load_grid(const std::string& path) {
+    std::error_code ec;
+    uintmax_t size = std::filesystem::file_size(path, ec);
+    long long mtime = ec ? 0 : std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+    if (ec) {
+        std::cerr << "Error: Could not open config file: " << path << std::endl;
+        return nullptr;
+    }
+    {
+        std::lock_guard<std::mutex> lock(grid_cache_mutex);
+        auto it = file_grids.find(path);
+        if (it != file_grids.end() && it->second.size == size && it->second.mtime == mtime) {
+            return it->second.grid;
+        }
+    }
+    
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open config file: " << path << std::endl;
+        return nullptr;
+    }
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    std::string text = contents.str();
+    
+    bool json = (path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0) ||
+                looks_like_json(text);
+    auto grid = parse_text(text, json, path, true);
+    if (grid) {
+        std::lock_guard<std::mutex> lock(grid_cache_mutex);
+        if (file_grids.size() >= MAX_CACHED_GRIDS) file_grids.clear();
+        file_grids[path] = {size, mtime, grid};
+    }
+    return grid;
+}
+
+std::shared_ptr<const ConfigGrid> ConfigParser::parse_grid_string(const std::string& text, bool load_models) {
+    auto& grids = text_grids[load_models ? 1 : 0];
+    {
+        std::lock_guard<std::mutex> lock(grid_cache_mutex);
+        auto it = grids.find(text);
+        if (it != grids.end()) return it->second;
+    }
+    auto grid = parse_text(text, looks_like_json(text), "config", load_models);
+    if (grid) {
+        std::lock_guard<std::mutex> lock(grid_cache_mutex);
+        if (grids.size() >= MAX_CACHED_GRIDS) grids.clear();
+        grids[text] = grid;
+    }
+    return grid;
+}
+
+void ConfigParser::load_regime_model(StrategyConfig& config) {
+    RegimeBackend backend;
+    if (!parse_regime_backend(config.regime.model, backend)) {
+        std::cerr << "Warning: unknown regime model '" << config.regime.model
+                  << "', using threshold" << std::endl;
+        config.regime.model = "threshold";
+        return;
+    }
+    if (backend == RegimeBackend::THRESHOLD) return;
+    
+    auto model = std::make_shared<RegimeModel>();
+    if (config.regime.model_path.empty() || !model->load(config.regime.model_path)) {
+        std::cerr << "Warning: could not load regime model '" << config.regime.model_path
+                  << "', using threshold" << std::endl;
+        config.regime.model = "threshold";
+        return;
+    }
+    config.regime.fitted = std::move(model);
+}
+
 StrategyConfig ConfigParser::parse_yaml(const std::string& yaml_path) {
-    return parse_yaml_simple(yaml_path);
+    auto grid = load_grid(yaml_path);
+    return grid ? grid->at(0) : StrategyConfig();
 }
 
 StrategyConfig ConfigParser::parse_json(const std::string& json_path) {
-    // For MVP, JSON parsing can be added later
-    // For now, redirect to YAML parser
     return parse_yaml(json_path);
 }
 
-} // namespace fluxback
+StrategyConfig ConfigParser::parse_yaml_string(const std::string& yaml_text, bool load_models) {
+    auto grid = parse_grid_string(yaml_text, load_models);
+    return grid ? grid->at(0) : StrategyConfig();
+}
 
+} // namespace fluxback
@@ -1,10 +1,16 @@
 #pragma once
 
+#include <array>
 #include <string>
 #include <map>
+#include <istream>
+#include <memory>
+#include <vector>
 
 namespace fluxback {
 
+class RegimeModel;
+
 struct StrategyConfig {
     std::string name;
     std::string type;
@@ -20,6 +26,11 @@ struct StrategyConfig {
     bool use_vol_filter = false;
     double vol_threshold = 0.05; // annualized realized vol threshold
     
+    // Higher-timeframe trend confirmation (0 = disabled): longs need the
+    // last completed HTF close above its SMA, shorts below
+    int trend_timeframe_minutes = 0;
+    int trend_sma = 20;
+    
     // Exit parameters
     double stop_loss_pct = 0.5;
     double take_profit_pct = 1.0;
@@ -27,6 +38,28 @@ struct StrategyConfig {
     // Risk parameters
     int position_size = 100;
     
+    // How Analytics matches closing fills against open lots: oldest lot
+    // first, or one lot at the average entry price
+    enum class LotMethod { FIFO, AVERAGE };
+    LotMethod lots = LotMethod::FIFO;
+    
+    // Pre-trade limits applied by RiskManager; 0 disables each. With
+    // target_vol set, entries are sized to that annualized volatility
+    // instead of position_size. Exposures are notional (cash terms).
+    struct RiskConfig {
+        double target_vol = 0.0;
+        double max_symbol_exposure = 0.0;
+        double max_gross_exposure = 0.0;
+        double max_net_exposure = 0.0;
+        double max_leverage = 0.0;     // gross exposure / equity
+        double max_drawdown_pct = 0.0; // kill switch: flatten, then no new entries
+        
+        bool enabled() const {
+            return target_vol > 0.0 || max_symbol_exposure > 0.0 || max_gross_exposure > 0.0 ||
+                   max_net_exposure > 0.0 || max_leverage > 0.0 || max_drawdown_pct > 0.0;
+        }
+    } risk;
+    
     // Execution parameters
     struct SlippageConfig {
         std::string type = "fixed"; // "fixed" or "adaptive"
@@ -37,23 +70,131 @@ struct StrategyConfig {
         double low_factor = 0.5;
         double high_factor = 1.5;
     } slippage;
-
+    
+    // Trading costs, charged per fill and per overnight hold (all 0 =
+    // free). `venue` names a preset schedule from CostModel's table;
+    // explicit keys override it.
+    struct CostConfig {
+        static constexpr size_t MAX_TIERS = 8;
+        struct Tier {
+            double volume = 0.0;    // units traded so far from which the tier applies
+            double per_share = 0.0;
+        };
+        
+        std::string venue;
+        double commission_per_share = 0.0;
+        double commission_bps = 0.0;         // of notional
+        double commission_min = 0.0;         // per order
+        double commission_max_pct = 0.0;     // cap, % of notional (0 = none)
+        std::array<Tier, MAX_TIERS> tiers{}; // when set, replace commission_per_share
+        size_t tier_count = 0;
+        double exchange_fee_per_share = 0.0;
+        double exchange_fee_bps = 0.0;
+        double sell_fee_bps = 0.0;           // regulatory fee on sells
+        double borrow_rate_pct = 0.0;        // annual, on shorts held overnight
+        double financing_rate_pct = 0.0;     // annual, on longs held overnight
+        
+        bool per_fill() const {
+            return commission_per_share > 0.0 || commission_bps > 0.0 || commission_min > 0.0 ||
+                   tier_count > 0 || exchange_fee_per_share > 0.0 || exchange_fee_bps > 0.0 ||
+                   sell_fee_bps > 0.0;
+        }
+        bool overnight() const { return borrow_rate_pct > 0.0 || financing_rate_pct > 0.0; }
+        bool enabled() const { return per_fill() || overnight(); }
+    } costs;
+    
+    // Session-anchored VWAP and volume profile (SessionProfile), tracked
+    // only when the entry filter or the fill benchmark needs them
+    struct VwapConfig {
+        double max_entry_sigma = 0.0; // longs need price <= VWAP + this many sigma, shorts >= VWAP - (0 = off)
+        bool benchmark = false;       // stamp fills with the session VWAP; the summary reports shortfall
+        double bucket_pct = 0.05;     // profile bucket width, % of the session's first price
+        
+        bool enabled() const { return max_entry_sigma > 0.0 || benchmark; }
+    } vwap;
+    
+    // Market sessions, for annualizing returns and volatility and for
+    // session-reset indicators. `market` names a preset from
+    // SessionCalendar's table; explicit keys override it. Sessions open
+    // and close on the same calendar date.
+    struct CalendarConfig {
+        std::string market = "us_equity";
+        int open_minute = 570;      // minutes after midnight, exchange time
+        int close_minute = 960;
+        double days_per_year = 252.0;
+    } calendar;
+    
     // Regime handling
     bool exclude_volatile_regime = false;
+    
+    // Regime backend ("threshold", "kmeans" or "hmm"); the model backends
+    // read a model written by `fluxback fit-regimes`, loaded once here and
+    // shared by every copy of the config
+    struct RegimeConfig {
+        std::string model = "threshold";
+        std::string model_path;
+        std::shared_ptr<const RegimeModel> fitted;
+    } regime;
+};
+
+struct ConfigNode;
+
+// One swept setting: its key and the values it takes
+struct SweepAxis {
+    std::string key; // document path, e.g. "strategy.entry.fast"
+    void (*apply)(StrategyConfig& config, const std::string& text, double number) = nullptr;
+    std::vector<std::string> text;
+    std::vector<double> number; // parsed once; NaN for non-numeric values
+};
+
+// A base config and the axes swept around it. The grid is the cartesian
+// product of the axes, the first axis varying slowest.
+class ConfigGrid {
+public:
+    StrategyConfig base;
+    std::vector<SweepAxis> axes;
+    
+    size_t size() const;
+    StrategyConfig at(size_t index) const;
+    std::vector<StrategyConfig> expand() const;
+    
+    // "key=value,..." of every axis at config `index`, e.g.
+    // "strategy.entry.fast=5,risk.stop_loss_pct=0.02"
+    std::string label(size_t index) const;
 };
 
 class ConfigParser {
 public:
+    // The first config of the file's grid (every swept key at its first
+    // value), or a config with an empty name on errors. YAML and JSON are
+    // told apart by extension and content, so either works for both.
     static StrategyConfig parse_yaml(const std::string& yaml_path);
     static StrategyConfig parse_json(const std::string& json_path);
     
+    // Parse YAML or JSON already held in memory (e.g. a request body).
+    // With load_models false, regime.model_path is kept but not opened,
+    // so a caller that doesn't trust the text can vet the path first and
+    // then call load_regime_model.
+    static StrategyConfig parse_yaml_string(const std::string& yaml_text, bool load_models = true);
+    
+    // The sweep grid a file or document describes; nullptr on errors.
+    // Parsed grids are cached (files by path, size and mtime, text by
+    // content), so repeated loads neither re-read nor re-parse.
+    static std::shared_ptr<const ConfigGrid> load_grid(const std::string& path);
+    static std::shared_ptr<const ConfigGrid> parse_grid_string(const std::string& text, bool load_models = true);
+    
+    // Map a parsed document onto a grid. Lists and ranges on numeric keys
+    // become axes; unknown keys are reported and skipped.
+    static bool build_grid(const ConfigNode& root, ConfigGrid& grid, std::string& error,
+                           bool load_models = true);
+    
+    // Load the model regime.model_path names for a model backend; falls
+    // back to the threshold backend (with a warning) when it can't
+    static void load_regime_model(StrategyConfig& config);
+    
 private:
-    static StrategyConfig parse_yaml_simple(const std::string& yaml_path);
-    static std::string trim(const std::string& str);
-    static std::string get_value(const std::string& line, const std::string& key);
-    static int get_int_value(const std::string& line, const std::string& key, int default_val = 0);
-    static double get_double_value(const std::string& line, const std::string& key, double default_val = 0.0);
-    static std::string get_string_value(const std::string& line, const std::string& key, const std::string& default_val = "");
+    static std::shared_ptr<const ConfigGrid> parse_text(const std::string& text, bool json,
+                                                        const std::string& source, bool load_models);
 };
 
 } // namespace fluxback
@@ -0,0 +1,111 @@
+#include "utils/NumaTopology.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace fluxback {
+
+namespace {
+
+const char* NODE_ROOT = "/sys/devices/system/node/";
+
+bool read_line(const std::string& path, std::string& line) {
+    std::ifstream in(path);
+    return in.is_open() && static_cast<bool>(std::getline(in, line));
+}
+
+} // namespace
+
+std::vector<int> NumaTopology::parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        size_t dash = range.find('-');
+        try {
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        } catch (...) {
+            // Skip malformed ranges (and the trailing newline's empty token)
+        }
+    }
+    return cpus;
+}
+
+NumaTopology NumaTopology::detect() {
+    NumaTopology topology;
+    std::string online;
+    if (read_line(std::string(NODE_ROOT) + "online", online)) {
+        for (int node : parse_cpu_list(online)) {
+            std::string cpulist;
+            if (!read_line(std::string(NODE_ROOT) + "node" + std::to_string(node) + "/cpulist", cpulist)) {
+                continue;
+            }
+            std::vector<int> cpus = parse_cpu_list(cpulist);
+            if (!cpus.empty()) {
+                topology.nodes.push_back(std::move(cpus)); // memory-only nodes have no CPUs
+            }
+        }
+    }
+    if (topology.nodes.empty()) {
+        topology.nodes.emplace_back();
+    }
+    return topology;
+}
+
+size_t NumaTopology::node_for(int slot, int workers) const {
+    if (nodes.size() <= 1 || workers <= 0) return 0;
+    size_t node = static_cast<size_t>(slot) * nodes.size() / static_cast<size_t>(workers);
+    return std::min(node, nodes.size() - 1);
+}
+
+bool NumaTopology::bind_current_thread(size_t node, std::vector<int>& previous) const {
+#ifdef __linux__
+    if (node >= nodes.size() || nodes[node].empty()) return false;
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(allowed), &allowed) != 0) return false;
+    
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : nodes[node]) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)) CPU_SET(cpu, &set);
+    }
+    if (CPU_COUNT(&set) == 0 || pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) return false;
+    
+    previous.clear();
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed)) previous.push_back(cpu);
+    }
+    return true;
+#else
+    (void)node;
+    (void)previous;
+    return false;
+#endif
+}
+
+bool NumaTopology::restore_current_thread(const std::vector<int>& previous) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : previous) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    if (CPU_COUNT(&set) == 0) return false;
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)previous;
+    return false;
+#endif
+}
+
+} // namespace fluxback
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace fluxback {
+
+// NUMA nodes and the CPUs on each, read from /sys/devices/system/node.
+// Hosts without that (or non-Linux builds) look like one node with no
+// CPU list, and binding is then a no-op.
+class NumaTopology {
+public:
+    static NumaTopology detect();
+    
+    size_t node_count() const { return nodes.size(); }
+    const std::vector<int>& cpus(size_t node) const { return nodes[node]; }
+    
+    // Node for worker `slot` of `workers`: consecutive slots share a node,
+    // and workers are split evenly over the nodes
+    size_t node_for(int slot, int workers) const;
+    
+    // Restrict the calling thread to the CPUs of `node` it may already
+    // use (so a taskset limit still holds); the CPUs it was allowed
+    // before go to `previous`
+    bool bind_current_thread(size_t node, std::vector<int>& previous) const;
+    
+    // Give the calling thread back the CPUs bind_current_thread saved
+    static bool restore_current_thread(const std::vector<int>& previous);
+    
+    // Parse a sysfs CPU list such as "0-3,8,10-11"
+    static std::vector<int> parse_cpu_list(const std::string& list);
+
+private:
+    std::vector<std::vector<int>> nodes;
+};
+
+} // namespace fluxback
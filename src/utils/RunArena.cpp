@@ -0,0 +1,90 @@
+#include "utils/RunArena.h"
+#include <algorithm>
+
+namespace fluxback {
+
+ArenaStats& ArenaStats::operator+=(const ArenaStats& other) {
+    allocations += other.allocations;
+    bytes_allocated += other.bytes_allocated;
+    upstream_allocations += other.upstream_allocations;
+    upstream_bytes += other.upstream_bytes;
+    high_water_bytes = std::max(high_water_bytes, other.high_water_bytes);
+    runs += other.runs;
+    resets += other.resets;
+    return *this;
+}
+
+void* RunArena::HeapCounter::do_allocate(size_t bytes, size_t alignment) {
+    allocations++;
+    this->bytes += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void RunArena::HeapCounter::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+bool RunArena::HeapCounter::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+RunArena::RunArena(size_t initial_bytes)
+    : buffer(std::max<size_t>(initial_bytes, 4096)), live_bytes(0) {
+    counters.upstream_allocations = 1;
+    counters.upstream_bytes = buffer.size();
+    rebuild();
+}
+
+RunArena::~RunArena() {
+    pool.reset();
+    monotonic.reset();
+}
+
+void RunArena::rebuild() {
+    pool.reset();
+    monotonic.reset();
+    heap.allocations = 0;
+    heap.bytes = 0;
+    monotonic.emplace(buffer.data(), buffer.size(), &heap);
+    pool.emplace(&*monotonic);
+}
+
+void RunArena::reset(size_t runs) {
+    counters.upstream_allocations += heap.allocations;
+    counters.upstream_bytes += heap.bytes;
+    size_t overflow = heap.bytes;
+    
+    // Tear down (returning overflow blocks to the heap), then make the
+    // buffer big enough that a run like this one fits next time
+    pool.reset();
+    monotonic.reset();
+    if (overflow > 0) {
+        buffer = std::vector<std::byte>(buffer.size() + overflow);
+        counters.upstream_allocations++;
+        counters.upstream_bytes += buffer.size();
+    }
+    rebuild();
+    
+    live_bytes = 0;
+    counters.runs += runs;
+    counters.resets++;
+}
+
+void* RunArena::do_allocate(size_t bytes, size_t alignment) {
+    counters.allocations++;
+    counters.bytes_allocated += bytes;
+    live_bytes += bytes;
+    counters.high_water_bytes = std::max(counters.high_water_bytes, live_bytes);
+    return pool->allocate(bytes, alignment);
+}
+
+void RunArena::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    live_bytes -= std::min(live_bytes, bytes);
+    pool->deallocate(p, bytes, alignment);
+}
+
+bool RunArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+} // namespace fluxback
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+namespace fluxback {
+
+struct ArenaStats {
+    size_t allocations = 0;           // requests served by the arena
+    size_t bytes_allocated = 0;
+    size_t upstream_allocations = 0;  // blocks taken from the global heap
+    size_t upstream_bytes = 0;
+    size_t high_water_bytes = 0;      // most memory live at once between resets
+    size_t runs = 0;                  // runs released by reset()
+    size_t resets = 0;                // one per run, or per batch of runs
+    
+    ArenaStats& operator+=(const ArenaStats& other);
+};
+
+// Per-worker memory resource for the state of one backtest run
+// (std::pmr-compatible). A pool recycles blocks freed during a run, on top
+// of a monotonic buffer that reset() drops in one go. The buffer grows to
+// the largest run seen, so once a worker has warmed up its runs take
+// nothing from the global heap. Not thread-safe: one arena per thread.
+class RunArena : public std::pmr::memory_resource {
+public:
+    explicit RunArena(size_t initial_bytes = 1 << 20);
+    ~RunArena() override;
+    
+    RunArena(const RunArena&) = delete;
+    RunArena& operator=(const RunArena&) = delete;
+    
+    // Release everything allocated since the last reset by `runs` runs
+    // (more than one when a batch shares the arena). Every object using
+    // the arena must already be destroyed.
+    void reset(size_t runs = 1);
+    
+    const ArenaStats& stats() const { return counters; }
+    size_t capacity() const { return buffer.size(); }
+
+private:
+    // Counts what the monotonic buffer has to take from the global heap
+    class HeapCounter : public std::pmr::memory_resource {
+    public:
+        size_t allocations = 0;
+        size_t bytes = 0;
+    
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    };
+    
+    HeapCounter heap;
+    std::vector<std::byte> buffer;
+    std::optional<std::pmr::monotonic_buffer_resource> monotonic;
+    std::optional<std::pmr::unsynchronized_pool_resource> pool;
+    ArenaStats counters;
+    size_t live_bytes;  // allocated and not yet freed this run
+    
+    void rebuild();
+    
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+};
+
+} // namespace fluxback
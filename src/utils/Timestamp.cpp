@@ -0,0 +1,113 @@
+#include "utils/Timestamp.h"
+#include <cstdio>
+
+namespace fluxback {
+
+int64_t days_from_civil(int year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(year - era * 400);
+    const unsigned doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+std::string format_timestamp(int64_t epoch_seconds, char separator) {
+    std::string text;
+    format_timestamp(epoch_seconds, text, separator);
+    return text;
+}
+
+void format_timestamp(int64_t epoch_seconds, std::string& out, char separator) {
+    if (separator == '\0') {
+        out = std::to_string(epoch_seconds);
+        return;
+    }
+    
+    int64_t days = epoch_seconds / 86400;
+    int64_t secs = epoch_seconds % 86400;
+    if (secs < 0) {
+        secs += 86400;
+        days -= 1;
+    }
+    
+    // civil_from_days, the inverse of days_from_civil
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(days - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    const unsigned day = doy - (153 * mp + 2) / 5 + 1;
+    const unsigned month = mp < 10 ? mp + 3 : mp - 9;
+    const int64_t year = static_cast<int64_t>(yoe) + era * 400 + (month <= 2);
+    
+    char text[32];
+    int length = std::snprintf(text, sizeof(text), "%04lld-%02u-%02u%c%02d:%02d:%02d", static_cast<long long>(year),
+                               month, day, separator, static_cast<int>(secs / 3600),
+                               static_cast<int>(secs / 60 % 60), static_cast<int>(secs % 60));
+    out.assign(text, static_cast<size_t>(length));
+}
+
+namespace {
+
+bool read_digits(std::string_view text, size_t pos, size_t count, int& value) {
+    if (pos + count > text.size()) return false;
+    value = 0;
+    for (size_t i = pos; i < pos + count; ++i) {
+        char c = text[i];
+        if (c < '0' || c > '9') return false;
+        value = value * 10 + (c - '0');
+    }
+    return true;
+}
+
+} // namespace
+
+bool parse_timestamp(std::string_view text, int64_t& epoch_seconds) {
+    int year, month, day, hour = 0, minute = 0, second = 0;
+    
+    if (text.size() >= 10 && text[4] == '-' && text[7] == '-') {
+        if (!read_digits(text, 0, 4, year) || !read_digits(text, 5, 2, month) ||
+            !read_digits(text, 8, 2, day)) {
+            return false;
+        }
+        if (text.size() >= 16 && (text[10] == 'T' || text[10] == ' ')) {
+            if (!read_digits(text, 11, 2, hour) || text[13] != ':' || !read_digits(text, 14, 2, minute)) {
+                return false;
+            }
+            if (text.size() >= 19 && text[16] == ':') {
+                read_digits(text, 17, 2, second);
+            }
+        }
+        if (month < 1 || month > 12 || day < 1 || day > 31) return false;
+        epoch_seconds = days_from_civil(year, static_cast<unsigned>(month), static_cast<unsigned>(day)) * 86400 +
+                        hour * 3600 + minute * 60 + second;
+        return true;
+    }
+    
+    // Plain epoch seconds
+    if (text.empty()) return false;
+    int64_t value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+        value = value * 10 + (c - '0');
+    }
+    epoch_seconds = value;
+    return true;
+}
+
+int parse_timeframe_minutes(const std::string& text) {
+    if (text.empty()) return 0;
+    size_t digits = 0;
+    while (digits < text.size() && text[digits] >= '0' && text[digits] <= '9') digits++;
+    if (digits == 0) return 0;
+    int value = std::stoi(text.substr(0, digits));
+    std::string unit = text.substr(digits);
+    if (unit.empty() || unit == "m" || unit == "min") return value;
+    if (unit == "h") return value * 60;
+    if (unit == "d") return value * 1440;
+    return 0;
+}
+
+} // namespace fluxback
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace fluxback {
+
+// Parse "YYYY-MM-DD[T| ]HH:MM[:SS]" (timezone suffixes ignored) or a plain
+// integer epoch in seconds into seconds since 1970-01-01 (timestamps are
+// treated as exchange-local wall-clock time)
+bool parse_timestamp(std::string_view text, int64_t& epoch_seconds);
+
+// Parse a bar period such as "5m", "1h", "1d" or a bare minute count;
+// returns 0 if the text is not a period
+int parse_timeframe_minutes(const std::string& text);
+
+// Days since 1970-01-01 for a civil date (proleptic Gregorian)
+int64_t days_from_civil(int year, unsigned month, unsigned day);
+
+// Inverse of parse_timestamp: "YYYY-MM-DD<separator>HH:MM:SS", or the plain
+// epoch when separator is '\0'
+std::string format_timestamp(int64_t epoch_seconds, char separator = ' ');
+
+// Same, into `out` (reusing its buffer when formatting bar after bar)
+void format_timestamp(int64_t epoch_seconds, std::string& out, char separator = ' ');
+
+} // namespace fluxback
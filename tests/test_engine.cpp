@@ -0,0 +1,1908 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "engine/BacktestRunner.h"
+#include "engine/BacktestPipeline.h"
+#include "engine/SweepRunner.h"
+#include "engine/WideKernel.h"
+#include "indicators/IndicatorCache.h"
+#include "analytics/ResultWriter.h"
+#include "analytics/ResultStats.h"
+#include "analytics/MonteCarlo.h"
+#include "data/BarAggregator.h"
+#include "data/BarStore.h"
+#include "data/SessionCalendar.h"
+#include "utils/Timestamp.h"
+#include "utils/RunArena.h"
+#include "utils/NumaTopology.h"
+#include "utils/ConfigNode.h"
+#include "utils/ConfigParser.h"
+#include "execution/CostModel.h"
+#include "concurrency/MpscRing.h"
+#include "concurrency/SpscRing.h"
+#include "concurrency/ThreadPool.h"
+#include "journal/RunJournal.h"
+#include "fluxback/Backtest.h"
+#include "server/BacktestServer.h"
+#include "live/LiveRunner.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <set>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace fluxback;
+
+// Global operator new calls made on this thread while counting_news is set
+thread_local bool counting_news = false;
+thread_local size_t counted_news = 0;
+
+void* operator new(std::size_t size) {
+    if (counting_news) ++counted_news;
+    if (void* p = std::malloc(size != 0 ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+// Deterministic oscillating series so the SMA crossover trades
+std::vector<OHLCV> make_bars(size_t count) {
+    std::vector<OHLCV> bars;
+    for (size_t i = 0; i < count; ++i) {
+        double mid = 100.0 + 5.0 * std::sin(i * 0.05) + 0.3 * std::sin(i * 0.9);
+        OHLCV bar;
+        bar.timestamp = "2024-01-02T09:" + std::to_string(i);
+        bar.open = mid - 0.1;
+        bar.close = mid + 0.1;
+        bar.high = mid + 0.4;
+        bar.low = mid - 0.4;
+        bar.volume = 1000 + static_cast<long>((i * 37) % 500);
+        bars.push_back(bar);
+    }
+    return bars;
+}
+
+StrategyConfig make_config() {
+    StrategyConfig config;
+    config.name = "test";
+    config.fast_sma = 5;
+    config.slow_sma = 15;
+    config.stop_loss_pct = 1.0;
+    config.take_profit_pct = 2.0;
+    return config;
+}
+
+} // namespace
+
+TEST_CASE("Cached run matches live run", "[engine]") {
+    auto bars = make_bars(600);
+    StrategyConfig config = make_config();
+    
+    BacktestRunner live(config);
+    for (const auto& bar : bars) live.on_bar(bar);
+    
+    IndicatorCache cache;
+    cache.prepare(bars, config);
+    BacktestRunner cached(config);
+    cached.attach_cache(&cache);
+    for (const auto& bar : bars) cached.on_bar(bar);
+    
+    auto a = live.summary();
+    auto b = cached.summary();
+    REQUIRE(a.total_trades > 0);
+    REQUIRE(a.total_trades == b.total_trades);
+    REQUIRE(a.final_cash == Approx(b.final_cash));
+    REQUIRE(a.sharpe_ratio == Approx(b.sharpe_ratio));
+}
+
+TEST_CASE("Cache sidecar round-trips and corrupt sidecars miss", "[engine]") {
+    std::string data_path = "test_engine_cache.csv";
+    std::string cache_path = IndicatorCache::sidecar_path(data_path);
+    std::ofstream(data_path) << "timestamp,open,high,low,close,volume\n";
+    auto bars = make_bars(500);
+    
+    IndicatorCache cache;
+    cache.prepare(bars, make_config());
+    REQUIRE(cache.save(cache_path, data_path));
+    IndicatorCache loaded;
+    REQUIRE(loaded.load(cache_path, data_path, bars.size()));
+    REQUIRE(loaded.value(IndicatorCache::SMA, 15, 400) == cache.value(IndicatorCache::SMA, 15, 400));
+    REQUIRE_FALSE(loaded.load(cache_path, data_path, bars.size() + 1)); // other data
+    
+    // A huge bar count must be rejected before anything is allocated
+    {
+        std::fstream file(cache_path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(24); // magic, version, data size, data mtime
+        uint64_t huge = uint64_t(1) << 60;
+        file.write(reinterpret_cast<const char*>(&huge), sizeof(huge));
+    }
+    REQUIRE_FALSE(loaded.load(cache_path, data_path, uint64_t(1) << 60));
+    
+    // Truncated mid-series
+    REQUIRE(cache.save(cache_path, data_path));
+    std::filesystem::resize_file(cache_path, std::filesystem::file_size(cache_path) / 2);
+    REQUIRE_FALSE(loaded.load(cache_path, data_path, bars.size()));
+    
+    std::remove(cache_path.c_str());
+    std::remove(data_path.c_str());
+}
+
+TEST_CASE("Shipped demo trades, with identical results cache on and off", "[engine][regression]") {
+    const std::string root = FLUXBACK_SOURCE_DIR;
+    StrategyConfig config = ConfigParser::parse_yaml(root + "/config/sma_demo.yaml");
+    REQUIRE_FALSE(config.name.empty());
+    REQUIRE(config.use_vol_filter);
+    
+    std::vector<OHLCV> demo;
+    DataLoader loader(root + "/demo/sample_data.csv");
+    while (loader.has_next()) demo.push_back(loader.next());
+    
+    // The demo data, and a longer series whose realized vol
+    // straddles the threshold so the vol filter both blocks and passes entries
+    StrategyConfig straddle = config;
+    straddle.vol_threshold = 0.68;
+    std::vector<std::pair<std::vector<OHLCV>, StrategyConfig>> cases = {{demo, config}, {make_bars(3000), straddle}};
+    for (const auto& entry : cases) {
+        const auto& bars = entry.first;
+        const StrategyConfig& config = entry.second;
+        BacktestRunner live(config);
+        for (const auto& bar : bars) live.on_bar(bar);
+        
+        IndicatorCache cache;
+        cache.prepare(bars, config);
+        BacktestRunner cached(config);
+        cached.attach_cache(&cache);
+        for (const auto& bar : bars) cached.on_bar(bar);
+        
+        const auto& expected = live.get_analytics().get_fills();
+        const auto& actual = cached.get_analytics().get_fills();
+        REQUIRE(live.summary().total_trades > 0);
+        REQUIRE(actual.size() == expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            REQUIRE(actual[i].timestamp == expected[i].timestamp);
+            REQUIRE(actual[i].fill_price == expected[i].fill_price);
+        }
+        REQUIRE(cached.summary().final_cash == live.summary().final_cash);
+    }
+}
+
+TEST_CASE("Sweep results are independent of thread count", "[engine]") {
+    auto bars = make_bars(400);
+    auto grid = SweepRunner::exit_grid(make_config());
+    
+    IndicatorCache cache;
+    cache.prepare(bars, grid.front());
+    SweepRunner sweep(bars, &cache);
+    
+    auto serial = sweep.run(grid, 1);
+    auto parallel = sweep.run(grid, 4);
+    REQUIRE(serial.size() == grid.size());
+    for (size_t i = 0; i < serial.size(); ++i) {
+        REQUIRE(serial[i].summary.final_cash == Approx(parallel[i].summary.final_cash));
+        REQUIRE(serial[i].summary.total_trades == parallel[i].summary.total_trades);
+    }
+}
+
+TEST_CASE("Wide sweep matches one runner per config", "[engine]") {
+    auto bars = make_bars(1500);
+    std::vector<StrategyConfig> grid;
+    for (int fast : {3, 5, 8}) {
+        StrategyConfig base = make_config();
+        base.fast_sma = fast;
+        base.slow_sma = fast * 3;
+        base.use_rsi_filter = fast == 5;
+        base.use_vol_filter = fast == 8;
+        base.vol_threshold = 0.62;
+        base.exclude_volatile_regime = fast != 3;
+        base.slippage.type = fast == 3 ? "fixed" : "adaptive";
+        for (const auto& config : SweepRunner::exit_grid(base)) grid.push_back(config);
+    }
+    REQUIRE(grid.size() > WideKernel::MAX_LANES); // spans more than one batch
+    
+    IndicatorCache cache;
+    for (const auto& config : grid) cache.prepare(bars, config);
+    SweepRunner sweep(bars, &cache);
+    auto scalar = sweep.run(grid, 2);
+    sweep.set_wide(true);
+    auto wide = sweep.run(grid, 2);
+    
+    REQUIRE(wide.size() == grid.size());
+    for (size_t i = 0; i < grid.size(); ++i) {
+        REQUIRE(scalar[i].summary.total_trades > 0);
+        REQUIRE(wide[i].summary.total_trades == scalar[i].summary.total_trades);
+        REQUIRE(wide[i].summary.final_cash == scalar[i].summary.final_cash);
+        REQUIRE(wide[i].summary.sharpe_ratio == Approx(scalar[i].summary.sharpe_ratio));
+    }
+    REQUIRE(sweep.arena_stats().allocations > 0);
+    REQUIRE(sweep.arena_stats().runs == grid.size());
+    REQUIRE(sweep.arena_stats().resets == (grid.size() + WideKernel::MAX_LANES - 1) / WideKernel::MAX_LANES);
+}
+
+TEST_CASE("Wide batches annualize each lane with its own calendar", "[engine]") {
+    // Hourly bars over about two months, so the year span matters
+    auto bars = make_bars(1500);
+    for (size_t i = 0; i < bars.size(); ++i) {
+        bars[i].timestamp = format_timestamp(1704186000 + static_cast<int64_t>(i) * 3600, ' ');
+    }
+    
+    // The same 16 configs under three markets, all in one batch
+    auto exits = SweepRunner::exit_grid(make_config());
+    std::vector<StrategyConfig> grid;
+    for (const char* market : {"us_equity", "crypto", "forex"}) {
+        for (size_t i = 0; i < 16; ++i) {
+            grid.push_back(exits[i]);
+            REQUIRE(SessionCalendar::apply_market(market, grid.back().calendar));
+        }
+    }
+    grid[1].calendar.days_per_year = 300.0; // custom year within a market
+    REQUIRE(grid.size() <= WideKernel::MAX_LANES);
+    
+    IndicatorCache cache;
+    for (const auto& config : grid) cache.prepare(bars, config);
+    std::vector<Analytics> lanes(grid.size());
+    WideKernel(bars, cache).run(grid.data(), grid.size(), lanes.data());
+    
+    for (size_t i = 0; i < grid.size(); ++i) {
+        BacktestRunner runner(grid[i]);
+        runner.attach_cache(&cache);
+        for (const auto& bar : bars) runner.on_bar(bar);
+        BacktestSummary expected = runner.summary();
+        BacktestSummary wide = lanes[i].summary();
+        REQUIRE(expected.total_trades > 0);
+        REQUIRE(wide.final_cash == expected.final_cash);
+        REQUIRE(wide.annualized_return_pct == Approx(expected.annualized_return_pct));
+        REQUIRE(wide.sharpe_ratio == Approx(expected.sharpe_ratio));
+    }
+    REQUIRE(lanes[0].summary().final_cash == lanes[16].summary().final_cash);
+    REQUIRE(lanes[0].summary().annualized_return_pct != Approx(lanes[16].summary().annualized_return_pct));
+}
+
+TEST_CASE("Tiled sweep matches one runner per config", "[engine]") {
+    auto bars = make_bars(2000);
+    auto grid = SweepRunner::exit_grid(make_config());
+    
+    IndicatorCache cache;
+    cache.prepare(bars, grid.front());
+    const IndicatorCache* caches[] = {nullptr, &cache};
+    for (const IndicatorCache* shared : caches) {
+        SweepRunner sweep(bars, shared);
+        auto plain = sweep.run(grid, 2);
+        REQUIRE(SweepRunner::bytes_per_bar(bars, shared) > sizeof(OHLCV)); // counts heap timestamps
+        REQUIRE(SweepRunner::bytes_per_bar(bars, shared) ==
+                SweepRunner::bytes_per_bar(bars, nullptr) + (shared ? shared->bytes_per_bar() : 0));
+        sweep.set_tiled(true, 64 * SweepRunner::bytes_per_bar(bars, shared)); // many tiles, two batches
+        auto tiled = sweep.run(grid, 2);
+    
+        REQUIRE(tiled.size() == grid.size());
+        for (size_t i = 0; i < grid.size(); ++i) {
+            REQUIRE(tiled[i].summary.total_trades == plain[i].summary.total_trades);
+            REQUIRE(tiled[i].summary.final_cash == plain[i].summary.final_cash);
+        }
+    }
+}
+
+TEST_CASE("NUMA CPU lists parse ranges and singles", "[engine]") {
+    REQUIRE(NumaTopology::parse_cpu_list("0-3,8,10-11\n") == std::vector<int>{0, 1, 2, 3, 8, 10, 11});
+    REQUIRE(NumaTopology::parse_cpu_list("").empty());
+    
+    NumaTopology topology = NumaTopology::detect();
+    REQUIRE(topology.node_count() >= 1);
+    REQUIRE(topology.node_for(7, 8) < topology.node_count());
+    
+#ifdef __linux__
+    // Binding saves the thread's own mask and restoring brings back exactly
+    // that one, not every CPU of every node
+    cpu_set_t before, after;
+    CPU_ZERO(&before);
+    CPU_ZERO(&after);
+    REQUIRE(pthread_getaffinity_np(pthread_self(), sizeof(before), &before) == 0);
+    std::vector<int> previous;
+    if (topology.bind_current_thread(0, previous)) {
+        REQUIRE(static_cast<int>(previous.size()) == CPU_COUNT(&before));
+        REQUIRE(NumaTopology::restore_current_thread(previous));
+    }
+    REQUIRE(pthread_getaffinity_np(pthread_self(), sizeof(after), &after) == 0);
+    REQUIRE(CPU_EQUAL(&before, &after));
+#endif
+}
+
+TEST_CASE("Runs on a warmed-up arena take nothing from the heap", "[engine]") {
+    auto bars = make_bars(3000); // timestamps too long for the small-string buffer
+    StrategyConfig costed = ConfigParser::parse_yaml_string(
+        "strategy:\n  name: costed\n  entry:\n    fast: 5\n    slow: 15\n"
+        "  exit:\n    stop_loss_pct: 1.0\n    take_profit_pct: 2.0\n"
+        "risk:\n  lots: average\ncosts:\n  venue: tiered\n  sell_fee_bps: 1\nvwap:\n  benchmark: true\n");
+    
+    for (const StrategyConfig& config : {make_config(), costed}) {
+        RunArena arena(4096); // deliberately too small for the first run
+        BacktestSummary first, second;
+        for (BacktestSummary* out : {&first, &second}) {
+            size_t heap_before = arena.stats().upstream_allocations;
+            {
+                BacktestRunner runner(config, 100000.0, &arena);
+                counted_news = 0;
+                counting_news = out == &second;
+                for (const auto& bar : bars) runner.on_bar(bar);
+                counting_news = false;
+                *out = runner.summary();
+            }
+            if (out == &second) {
+                REQUIRE(counted_news == 0);
+                REQUIRE(arena.stats().upstream_allocations == heap_before);
+            }
+            arena.reset();
+        }
+        
+        REQUIRE(arena.stats().allocations > 0);
+        REQUIRE(arena.capacity() > 4096);
+        REQUIRE(second.total_trades > 0);
+        REQUIRE(second.total_trades == first.total_trades);
+        REQUIRE(second.final_cash == first.final_cash);
+        
+        BacktestRunner heap_runner(config);
+        for (const auto& bar : bars) heap_runner.on_bar(bar);
+        REQUIRE(heap_runner.summary().final_cash == first.final_cash);
+    }
+}
+
+TEST_CASE("Binary result file round-trips", "[engine]") {
+    auto bars = make_bars(600);
+    BacktestRunner runner(make_config());
+    for (const auto& bar : bars) runner.on_bar(bar);
+    
+    std::string path = "test_engine_roundtrip.fxr";
+    runner.get_analytics().export_binary(path);
+    
+    BacktestSummary loaded;
+    TradeLog trades;
+    REQUIRE(ResultWriter::read_binary(path, loaded, &trades));
+    std::remove(path.c_str());
+    
+    auto original = runner.summary();
+    REQUIRE(loaded.total_trades == original.total_trades);
+    REQUIRE(loaded.final_cash == original.final_cash);
+    REQUIRE(loaded.pnl_by_regime == original.pnl_by_regime);
+    REQUIRE(loaded.equity_curve == original.equity_curve);
+    REQUIRE(trades.size() == runner.get_analytics().get_trades().size());
+    REQUIRE(trades.front().entry_timestamp == runner.get_analytics().get_trades().front().entry_timestamp);
+    
+    // Every summary scalar survives, including the VWAP shortfall
+    original.vwap_shortfall_bps = 3.5;
+    REQUIRE(ResultWriter::write_binary(path, original, runner.get_analytics().get_trades(), "vwap"));
+    REQUIRE(ResultWriter::read_binary(path, loaded, nullptr, nullptr, true));
+    REQUIRE(loaded.vwap_shortfall_bps == 3.5);
+    
+    // Sizes that don't fit in the file make it unreadable, not a huge allocation
+    std::string good;
+    {
+        std::ifstream in(path, std::ios::binary);
+        good.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    auto corrupt = [&](size_t at, uint64_t value, size_t width) {
+        std::string bytes = good;
+        std::memcpy(&bytes[at], &value, width);
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << bytes;
+        return ResultWriter::read_binary(path, loaded, &trades);
+    };
+    const size_t regimes_at = 4 + 4 + 4 + 15 * sizeof(double) + 3 * sizeof(int32_t); // after label "vwap"
+    uint32_t regime_count = 0;
+    std::memcpy(&regime_count, good.data() + regimes_at, sizeof(regime_count));
+    const size_t trades_at = regimes_at + 4 + regime_count * (1 + 4 + 8);
+    const size_t lengths_at = trades_at + 8 + trades.size() * (4 * 8 + 4 + 3);
+    REQUIRE(corrupt(trades_at, trades.size(), 8));
+    REQUIRE(corrupt(lengths_at, trades.front().entry_timestamp.size(), 4));
+    REQUIRE_FALSE(corrupt(4, 0xffffffffu, 4));                 // label size
+    REQUIRE_FALSE(corrupt(trades_at, uint64_t(1) << 61, 8));   // trade count
+    REQUIRE_FALSE(corrupt(lengths_at, 0xfffffff0u, 4));         // first timestamp length
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Pareto frontier keeps only non-dominated runs", "[stats]") {
+    auto record = [](double ret, double sharpe, double dd) {
+        ResultRecord r;
+        r.total_return_pct = ret;
+        r.sharpe_ratio = sharpe;
+        r.max_drawdown_pct = dd;
+        return r;
+    };
+    std::vector<ResultRecord> records = {
+        record(5.0, 2.0, 3.0),
+        record(4.0, 1.5, 4.0),   // dominated by the first
+        record(8.0, 1.0, 6.0),   // best return
+        record(1.0, 0.5, 0.5),   // lowest drawdown
+    };
+    
+    auto frontier = ResultStats::pareto_frontier(records);
+    REQUIRE(frontier.size() == 3);
+    REQUIRE(frontier.front().sharpe_ratio == 2.0);
+    
+    auto d = ResultStats::distribution({1.0, 2.0, 3.0, 4.0, 5.0});
+    REQUIRE(d.median == 3.0);
+    REQUIRE(d.mean == 3.0);
+}
+
+TEST_CASE("Monte Carlo is reproducible across thread counts", "[montecarlo]") {
+    std::vector<double> pnl = {120.0, -80.0, 45.0, -30.0, 200.0, -150.0, 60.0, 10.0};
+    MonteCarloConfig config;
+    config.paths = 2000;
+    config.block_size = 2;
+    
+    config.threads = 1;
+    auto serial = MonteCarlo::bootstrap_trades(pnl, config);
+    config.threads = 4;
+    auto parallel = MonteCarlo::bootstrap_trades(pnl, config);
+    
+    REQUIRE(serial.total_return_pct.p50 == parallel.total_return_pct.p50);
+    REQUIRE(serial.max_drawdown_pct.p95 == parallel.max_drawdown_pct.p95);
+    REQUIRE(serial.total_return_pct.p5 <= serial.total_return_pct.p95);
+    REQUIRE(serial.risk_of_ruin_pct == 0.0);
+}
+
+TEST_CASE("Bar aggregator builds higher-timeframe bars incrementally", "[timeframes]") {
+    BarAggregator five_min(parse_timeframe_minutes("5m"));
+    size_t completed = 0;
+    
+    for (int i = 0; i < 12; ++i) {
+        OHLCV bar;
+        bar.timestamp = "2024-01-02T09:" + std::string(i < 10 ? "0" : "") + std::to_string(i) + ":00";
+        bar.open = 100.0 + i;
+        bar.high = 101.0 + i;
+        bar.low = 99.0 + i;
+        bar.close = 100.5 + i;
+        bar.volume = 10;
+        if (five_min.update(bar)) completed++;
+    }
+    
+    // 09:00-09:04 and 09:05-09:09 are closed; 09:10-09:11 is still building
+    REQUIRE(completed == 2);
+    const OHLCV& last = five_min.last_completed();
+    REQUIRE(last.open == 105.0);
+    REQUIRE(last.high == 110.0);
+    REQUIRE(last.low == 104.0);
+    REQUIRE(last.close == 109.5);
+    REQUIRE(last.volume == 50);
+    REQUIRE(five_min.current().volume == 20);
+    REQUIRE(parse_timeframe_minutes("1h") == 60);
+}
+
+TEST_CASE("Parallel CSV load matches serial load", "[data]") {
+    // Large enough to take the multi-threaded path
+    std::string path = "test_engine_large.csv";
+    {
+        std::ofstream out(path);
+        out << "timestamp,open,high,low,close,volume\n";
+        for (int i = 0; i < 200000; ++i) {
+            if (i % 50000 == 7) out << "garbage,row\n";
+            out << "2024-01-02T09:15:" << i << ",100.5,101.25,99.75," << (100.0 + (i % 97) * 0.01)
+                << "," << 1000 + i << "\r\n";
+        }
+    }
+    
+    DataLoader serial_loader(path);
+    auto serial = serial_loader.load_all(1);
+    DataLoader parallel_loader(path);
+    auto parallel = parallel_loader.load_all(4);
+    std::remove(path.c_str());
+    std::remove(DataIndex::sidecar_path(path).c_str());
+    
+    REQUIRE(serial.size() == 200000);
+    REQUIRE(parallel.size() == serial.size());
+    REQUIRE(serial_loader.get_bad_rows() == 4);
+    REQUIRE(parallel_loader.get_bad_rows() == 4);
+    for (size_t i = 0; i < serial.size(); i += 997) {
+        REQUIRE(parallel[i].timestamp == serial[i].timestamp);
+        REQUIRE(parallel[i].close == serial[i].close);
+        REQUIRE(parallel[i].volume == serial[i].volume);
+    }
+    REQUIRE(parallel.back().timestamp == serial.back().timestamp);
+}
+
+TEST_CASE("Bar store round-trips bars and decodes only the requested range", "[data]") {
+    // One bar a minute with a session gap, irregular prices and volumes
+    std::vector<OHLCV> bars = make_bars(5000);
+    int64_t start = days_from_civil(2024, 1, 2) * 86400 + 9 * 3600 + 15 * 60;
+    for (size_t i = 0; i < bars.size(); ++i) {
+        int64_t epoch = start + static_cast<int64_t>(i) * 60 + (i >= 2500 ? 17 * 3600 : 0);
+        bars[i].timestamp = format_timestamp(epoch, 'T');
+        bars[i].high += (i % 7) * 0.01;
+    }
+    bars[100].close = bars[99].close;
+    
+    std::string path = "test_engine_bars.fxb";
+    REQUIRE(BarStore::write(path, bars, 1000));
+    REQUIRE(BarStore::is_bar_store(path));
+    
+    BarStore store;
+    REQUIRE(store.open(path));
+    REQUIRE(store.size() == bars.size());
+    REQUIRE(store.blocks().size() == 5);
+    auto decoded = store.read_all();
+    REQUIRE(decoded.size() == bars.size());
+    for (size_t i = 0; i < bars.size(); ++i) {
+        REQUIRE(decoded[i].timestamp == bars[i].timestamp);
+        REQUIRE(decoded[i].open == bars[i].open);
+        REQUIRE(decoded[i].high == bars[i].high);
+        REQUIRE(decoded[i].low == bars[i].low);
+        REQUIRE(decoded[i].close == bars[i].close);
+        REQUIRE(decoded[i].volume == bars[i].volume);
+    }
+    
+    // Range covering bars 1500..2200 (inside blocks 1 and 2 only)
+    int64_t first = 0, last = 0;
+    parse_timestamp(bars[1500].timestamp, first);
+    parse_timestamp(bars[2200].timestamp, last);
+    auto range = store.read_range(first, last);
+    REQUIRE(range.size() == 701);
+    REQUIRE(range.front().timestamp == bars[1500].timestamp);
+    REQUIRE(range.back().timestamp == bars[2200].timestamp);
+    
+    // DataLoader streams the store the same way it streams CSV
+    DataLoader loader(path);
+    REQUIRE(loader.is_valid());
+    REQUIRE(loader.get_total_lines() == bars.size());
+    size_t streamed = 0;
+    while (loader.has_next()) {
+        OHLCV bar = loader.next();
+        REQUIRE(bar.close == bars[streamed].close);
+        streamed++;
+    }
+    REQUIRE(streamed == bars.size());
+    
+    // Quoted prices take the scaled-decimal path and still read back exactly
+    for (auto& bar : bars) {
+        bar.open = std::round(bar.open * 100.0) / 100.0;
+        bar.close = std::round(bar.close * 10000.0) / 10000.0;
+    }
+    REQUIRE(BarStore::write(path, bars, 1000));
+    REQUIRE(store.open(path));
+    decoded = store.read_all();
+    for (size_t i = 0; i < bars.size(); ++i) {
+        REQUIRE(decoded[i].open == bars[i].open);
+        REQUIRE(decoded[i].close == bars[i].close);
+    }
+    
+    // Counts and offsets that don't fit the file are rejected at open
+    std::string good;
+    {
+        std::ifstream in(path, std::ios::binary);
+        good.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    uint64_t index_offset = 0;
+    std::memcpy(&index_offset, good.data() + good.size() - 8, 8);
+    auto corrupt = [&](size_t at, uint64_t value, size_t width) {
+        std::string bytes = good;
+        std::memcpy(&bytes[at], &value, width);
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << bytes;
+        return store.open(path);
+    };
+    REQUIRE_FALSE(corrupt(16, uint64_t(1) << 62, 8));           // header bar count
+    REQUIRE_FALSE(corrupt(index_offset, uint64_t(1) << 40, 8)); // block count
+    REQUIRE_FALSE(corrupt(index_offset + 8 + 16, 1u << 30, 4)); // first block's bar count
+    REQUIRE_FALSE(corrupt(index_offset + 8 + 24, good.size(), 8)); // first block's offset
+    REQUIRE_FALSE(corrupt(good.size() - 8, good.size(), 8));     // index offset
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << good.substr(0, good.size() / 2);
+    REQUIRE_FALSE(store.open(path));
+    REQUIRE(corrupt(0, 'F', 1));
+    REQUIRE(store.read_all().size() == bars.size());
+    
+    // A store cut short after opening reads as corrupt, not as fewer bars
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << good.substr(0, good.size() / 2);
+    REQUIRE(store.read_all().empty());
+    std::remove(path.c_str());
+    
+    // Timestamps that would not read back identically are rejected
+    std::vector<OHLCV> odd = make_bars(3);
+    REQUIRE_FALSE(BarStore::write(path, odd));
+}
+
+TEST_CASE("Date range reads seek through the sidecar index", "[data]") {
+    std::string path = "test_engine_range.csv";
+    int64_t start = days_from_civil(2024, 1, 1) * 86400;
+    {
+        std::ofstream out(path);
+        out << "timestamp,open,high,low,close,volume\n";
+        for (int i = 0; i < 10000; ++i) {
+            out << format_timestamp(start + i * 3600, ' ') << ",100,101,99," << 100 + i % 10 << ",1000\n";
+        }
+    }
+    int64_t from = start + 2500 * 3600;
+    int64_t to = start + 7300 * 3600;
+    
+    DataLoader loader(path);
+    REQUIRE(loader.get_total_lines() == 10000);
+    loader.set_range(from, to);
+    size_t count = 0;
+    std::string first_timestamp;
+    while (loader.has_next()) {
+        OHLCV bar = loader.next();
+        if (count++ == 0) first_timestamp = bar.timestamp;
+    }
+    REQUIRE(count == 4801);
+    REQUIRE(first_timestamp == format_timestamp(from, ' '));
+    
+    // Second open reuses the cached sidecar; load_all honours the range too
+    DataIndex index;
+    REQUIRE(index.load(DataIndex::sidecar_path(path), path));
+    REQUIRE(index.row_count() == 10000);
+    REQUIRE(index.is_sorted());
+    DataLoader cached(path);
+    cached.set_range(from, to);
+    auto bars = cached.load_all(1);
+    REQUIRE(bars.size() == 4801);
+    REQUIRE(bars.back().timestamp == format_timestamp(to, ' '));
+    
+    // A sample count that doesn't match the file is a miss, and the
+    // next range read rebuilds the sidecar
+    {
+        std::fstream sidecar(DataIndex::sidecar_path(path), std::ios::in | std::ios::out | std::ios::binary);
+        uint64_t huge = uint64_t(1) << 61;
+        sidecar.seekp(41); // after magic, version, fingerprint, rows, data offset, sorted flag
+        sidecar.write(reinterpret_cast<const char*>(&huge), sizeof(huge));
+    }
+    REQUIRE_FALSE(index.load(DataIndex::sidecar_path(path), path));
+    DataLoader rebuilt(path);
+    rebuilt.set_range(from, to);
+    REQUIRE(rebuilt.load_all(1).size() == 4801);
+    REQUIRE(index.load(DataIndex::sidecar_path(path), path));
+    
+    std::remove(path.c_str());
+    std::remove(DataIndex::sidecar_path(path).c_str());
+}
+
+TEST_CASE("Sidecar index is built on first range read and checks every row", "[data]") {
+    namespace fs = std::filesystem;
+    std::string path = "test_engine_unsorted.csv";
+    std::string sidecar = DataIndex::sidecar_path(path);
+    int64_t start = days_from_civil(2024, 1, 1) * 86400;
+    {
+        // One late row far from any sampled row (every 1024th)
+        std::ofstream out(path);
+        out << "timestamp,open,high,low,close,volume\n";
+        for (int i = 0; i < 10000; ++i) {
+            int hour = i == 5000 ? 100 : i;
+            out << format_timestamp(start + hour * 3600, ' ') << ",100,101,99,100,1000\n";
+        }
+    }
+    fs::remove(sidecar);
+    
+    // Whole-file reads don't need the index
+    DataLoader full(path);
+    REQUIRE(full.load_all(1).size() == 10000);
+    REQUIRE_FALSE(fs::exists(sidecar));
+    
+    // The late row is in range, so the read must not stop at hour 150
+    DataLoader ranged(path);
+    ranged.set_range(start + 50 * 3600, start + 150 * 3600);
+    REQUIRE(fs::exists(sidecar));
+    REQUIRE(ranged.load_all(1).size() == 102);
+    DataIndex index;
+    REQUIRE(index.load(sidecar, path));
+    REQUIRE_FALSE(index.is_sorted());
+    
+    // Where the sidecar can't be written the range read still works
+    fs::remove(sidecar);
+    fs::create_directory(sidecar + ".tmp");
+    DataLoader unwritable(path);
+    unwritable.set_range(start + 50 * 3600, start + 150 * 3600);
+    REQUIRE(unwritable.load_all(1).size() == 102);
+    REQUIRE(unwritable.get_total_lines() == 10000);
+    REQUIRE_FALSE(fs::exists(sidecar));
+    
+    fs::remove(sidecar + ".tmp");
+    fs::remove(path);
+}
+
+TEST_CASE("Config lists and ranges expand into a sweep grid", "[config]") {
+    const std::string yaml =
+        "strategy:\n"
+        "  name: \"sweep demo\"   # quoted\n"
+        "  entry:\n"
+        "    fast: [5..50 step 5]\n"
+        "    slow: [60, 120]\n"
+        "    rsi_overbought: 65\n"
+        "  exit:\n"
+        "    stop_loss_pct: [0.25..1.0 step 0.25]\n"
+        "risk: {position_size: 50}\n"
+        "execution:\n"
+        "  slippage:\n"
+        "    type: adaptive\n";
+    auto grid = ConfigParser::parse_grid_string(yaml);
+    REQUIRE(grid);
+    REQUIRE(grid->axes.size() == 3);
+    REQUIRE(grid->size() == 10 * 2 * 4);
+    REQUIRE(grid->base.name == "sweep demo");
+    REQUIRE(grid->base.use_rsi_filter);
+    REQUIRE(grid->base.position_size == 50);
+    REQUIRE(grid->base.slippage.type == "adaptive");
+    
+    // First axis varies slowest; at() agrees with expand()
+    auto configs = grid->expand();
+    REQUIRE(configs.size() == 80);
+    REQUIRE(configs[0].fast_sma == 5);
+    REQUIRE(configs[0].slow_sma == 60);
+    REQUIRE(configs[0].stop_loss_pct == 0.25);
+    REQUIRE(configs[1].stop_loss_pct == 0.5);
+    REQUIRE(configs[4].slow_sma == 120);
+    REQUIRE(configs[79].fast_sma == 50);
+    REQUIRE(configs[79].stop_loss_pct == 1.0);
+    for (size_t i = 0; i < configs.size(); i += 7) {
+        StrategyConfig at = grid->at(i);
+        REQUIRE(at.fast_sma == configs[i].fast_sma);
+        REQUIRE(at.slow_sma == configs[i].slow_sma);
+        REQUIRE(at.stop_loss_pct == configs[i].stop_loss_pct);
+    }
+    
+    // Labels name every axis, whichever keys are swept
+    REQUIRE(grid->label(0) == "strategy.entry.fast=5,strategy.entry.slow=60,strategy.exit.stop_loss_pct=0.25");
+    REQUIRE(grid->label(79) == "strategy.entry.fast=50,strategy.entry.slow=120,strategy.exit.stop_loss_pct=1");
+    auto filters = ConfigParser::parse_grid_string(
+        "strategy:\n  name: filters\n  entry:\n    rsi_overbought: [60, 70, 80]\n"
+        "    vol_threshold: [0.3, 0.5]\n");
+    REQUIRE(filters);
+    std::set<std::string> labels;
+    for (size_t i = 0; i < filters->size(); ++i) labels.insert(filters->label(i));
+    REQUIRE(labels.size() == 6);
+    REQUIRE(filters->label(5) == "strategy.entry.rsi_overbought=80,strategy.entry.vol_threshold=0.5");
+    
+    // Same text is served from the cache
+    REQUIRE(ConfigParser::parse_grid_string(yaml) == grid);
+    
+    // JSON with the same nesting gives the same configs
+    auto json = ConfigParser::parse_grid_string(
+        "{\"strategy\": {\"name\": \"sweep demo\", \"entry\": {\"fast\": [5, 10], \"slow\": 30}},"
+        " \"execution\": {\"slippage\": {\"base_ticks\": 2}}, \"regime\": null}");
+    REQUIRE(json);
+    REQUIRE(json->size() == 2);
+    REQUIRE(json->at(1).fast_sma == 10);
+    REQUIRE(json->base.slow_sma == 30);
+    REQUIRE(json->base.slippage.base_ticks == 2);
+}
+
+TEST_CASE("Config parser reports malformed documents", "[config]") {
+    ConfigNode root;
+    std::string error;
+    REQUIRE_FALSE(ConfigNode::parse_yaml("a:\n  b: 1\n   c: 2\n", root, error));
+    REQUIRE(error.find("line 3") != std::string::npos);
+    REQUIRE_FALSE(ConfigNode::parse_yaml("a: [1, 2\n", root, error));
+    REQUIRE_FALSE(ConfigNode::parse_yaml("a: [5..1]\n", root, error));
+    REQUIRE_FALSE(ConfigNode::parse_json("{\"a\": [1, 2,]}", root, error));
+    
+    // Block lists, including maps opening on the dash line
+    REQUIRE(ConfigNode::parse_yaml("items:\n- 1\n- name: x\n  size: 2\nnext: 'it''s'\n", root, error));
+    const ConfigNode* items = root.find("items");
+    REQUIRE(items);
+    REQUIRE(items->items.size() == 2);
+    REQUIRE(items->items[1].find("size")->value == "2");
+    REQUIRE(root.find("next")->value == "it's");
+    
+    // Non-numeric values for numeric keys and swept names are rejected
+    REQUIRE_FALSE(ConfigParser::parse_grid_string("strategy:\n  entry:\n    fast: abc\n"));
+    REQUIRE_FALSE(ConfigParser::parse_grid_string("strategy:\n  name: [a, b]\n"));
+}
+
+TEST_CASE("Risk limits resize entries and trip the kill switch", "[risk]") {
+    auto bars = make_bars(3000);
+    
+    // Symbol cap: prices stay above 94, so entries shrink to <= 53 units
+    StrategyConfig capped = make_config();
+    capped.risk.max_symbol_exposure = 5000.0;
+    BacktestRunner runner(capped);
+    int largest = 0;
+    runner.set_fill_callback([&](const Fill& fill, Regime) { largest = std::max(largest, fill.filled_size); });
+    for (const auto& bar : bars) runner.on_bar(bar);
+    REQUIRE(runner.summary().total_trades > 0);
+    REQUIRE(largest > 0);
+    REQUIRE(largest <= 5000.0 / 94.0);
+    REQUIRE(runner.get_risk().resized_entries() > 0);
+    REQUIRE(runner.get_risk().rejected_entries() == 0);
+    
+    // Vol targeting replaces position_size
+    StrategyConfig targeted = make_config();
+    targeted.risk.target_vol = 0.05;
+    BacktestRunner sized(targeted);
+    std::vector<int> sizes;
+    sized.set_fill_callback([&](const Fill& fill, Regime) { sizes.push_back(fill.filled_size); });
+    for (const auto& bar : bars) sized.on_bar(bar);
+    REQUIRE(!sizes.empty());
+    REQUIRE(std::any_of(sizes.begin(), sizes.end(), [](int s) { return s != 100; }));
+    
+    // A tiny drawdown budget halts trading after the first losing move
+    StrategyConfig halted = make_config();
+    halted.risk.max_drawdown_pct = 0.01;
+    BacktestRunner stopped(halted);
+    for (const auto& bar : bars) stopped.on_bar(bar);
+    REQUIRE(stopped.get_risk().halted());
+    REQUIRE(stopped.get_executor().get_position().size == 0);
+    REQUIRE(stopped.get_risk().rejected_entries() > 0);
+    REQUIRE(stopped.summary().total_trades < runner.summary().total_trades);
+}
+
+TEST_CASE("Shared risk manager keeps portfolio exposure incrementally", "[risk]") {
+    StrategyConfig::RiskConfig limits;
+    limits.max_gross_exposure = 2.0e6;
+    limits.max_net_exposure = 5.0e5;
+    RiskManager risk(limits, 1.0e6);
+    
+    const size_t symbols = 1000;
+    std::vector<int> position(symbols, 0);
+    std::vector<double> price(symbols, 0.0);
+    for (size_t s = 0; s < symbols; ++s) {
+        REQUIRE(risk.add_symbol() == s);
+        price[s] = 10.0 + s % 90;
+        risk.mark(s, price[s]);
+    }
+    
+    uint32_t seed = 12345;
+    auto next = [&]() { return seed = seed * 1664525u + 1013904223u; };
+    for (int step = 0; step < 20000; ++step) {
+        size_t s = next() % symbols;
+        if (next() % 3 == 0) {
+            price[s] *= 1.0 + (static_cast<int>(next() % 201) - 100) * 1e-4;
+            risk.mark(s, price[s]);
+            continue;
+        }
+        int side = next() % 2 == 0 ? 1 : -1;
+        int approved = risk.size_entry(s, side, 1 + next() % 200, price[s], 0.0);
+        if (approved > 0) {
+            risk.on_fill(s, side * approved, price[s]);
+            position[s] += side * approved;
+        }
+    }
+    
+    double gross = 0.0;
+    double net = 0.0;
+    for (size_t s = 0; s < symbols; ++s) {
+        REQUIRE(risk.position(s) == position[s]);
+        gross += std::fabs(position[s] * price[s]);
+        net += position[s] * price[s];
+    }
+    REQUIRE(gross > 0.0);
+    REQUIRE(risk.gross_exposure() == Approx(gross));
+    REQUIRE(risk.net_exposure() == Approx(net).margin(1e-6 * gross));
+    REQUIRE(gross <= limits.max_gross_exposure * 1.01); // marks may drift past the limit
+    REQUIRE(std::fabs(net) <= limits.max_net_exposure * 1.01);
+}
+
+TEST_CASE("Commission schedules apply tiers, minimums and caps", "[costs]") {
+    auto grid = ConfigParser::parse_grid_string(
+        "strategy:\n"
+        "  name: costs\n"
+        "costs:\n"
+        "  commission_max_pct: 0.5   # overrides the preset regardless of order\n"
+        "  venue: tiered\n"
+        "  sell_fee_bps: 1\n");
+    REQUIRE(grid);
+    const StrategyConfig::CostConfig& config = grid->base.costs;
+    REQUIRE(config.venue == "tiered");
+    REQUIRE(config.tier_count == 4);
+    REQUIRE(config.commission_max_pct == 0.5);
+    REQUIRE(config.commission_min == 0.35);
+    
+    CostModel model(config);
+    // 0.0035 per share, plus 0.003 exchange fee
+    FillCosts first = model.on_fill(false, 1000, 50.0);
+    REQUIRE(first.commission == Approx(3.5));
+    REQUIRE(first.fees == Approx(3.0));
+    // Minimum commission, and the sell fee on 10 * 50 notional
+    FillCosts small = model.on_fill(true, 10, 50.0);
+    REQUIRE(small.commission == Approx(0.35));
+    REQUIRE(small.fees == Approx(0.03 + 500.0 * 1e-4));
+    // 1000 shares at 0.10: capped at 0.5% of the 100 notional
+    REQUIRE(model.on_fill(false, 1000, 0.1).commission == Approx(0.5));
+    // Past 300k shares the second tier applies
+    model.on_fill(false, 300000, 50.0);
+    REQUIRE(model.on_fill(false, 1000, 50.0).commission == Approx(2.0));
+    
+    StrategyConfig::CostConfig bad;
+    REQUIRE_FALSE(CostModel::parse_tiers("100:0.01, 50:0.02", bad));
+    REQUIRE_FALSE(CostModel::apply_venue("nowhere", bad));
+}
+
+TEST_CASE("Trading costs come out of cash and trade PnL by category", "[costs]") {
+    // Hourly bars over several days so positions are held overnight
+    auto bars = make_bars(3000);
+    int64_t start = 0;
+    REQUIRE(parse_timestamp("2024-01-02 00:00:00", start));
+    for (size_t i = 0; i < bars.size(); ++i) {
+        bars[i].timestamp = format_timestamp(start + static_cast<int64_t>(i) * 3600, ' ');
+    }
+    
+    StrategyConfig free_config = make_config();
+    StrategyConfig costly = make_config();
+    costly.costs.commission_per_share = 0.01;
+    costly.costs.commission_min = 1.0;
+    costly.costs.exchange_fee_bps = 0.5;
+    costly.costs.borrow_rate_pct = 3.0;
+    costly.costs.financing_rate_pct = 5.0;
+    
+    BacktestRunner free_run(free_config);
+    BacktestRunner cost_run(costly);
+    for (const auto& bar : bars) {
+        free_run.on_bar(bar);
+        cost_run.on_bar(bar);
+    }
+    
+    BacktestSummary free_summary = free_run.summary();
+    BacktestSummary cost_summary = cost_run.summary();
+    REQUIRE(free_summary.commission == 0.0);
+    REQUIRE(cost_summary.total_trades == free_summary.total_trades); // costs don't change signals
+    REQUIRE(cost_summary.commission > 0.0);
+    REQUIRE(cost_summary.exchange_fees > 0.0);
+    REQUIRE(cost_summary.borrow_cost > 0.0);
+    REQUIRE(cost_summary.financing_cost > 0.0);
+    
+    double total = cost_summary.commission + cost_summary.exchange_fees +
+                   cost_summary.borrow_cost + cost_summary.financing_cost;
+    REQUIRE(free_run.get_executor().get_cash() - cost_run.get_executor().get_cash() == Approx(total));
+    
+    double free_pnl = 0.0;
+    double cost_pnl = 0.0;
+    for (const auto& trade : free_run.get_analytics().get_trades()) free_pnl += trade.pnl;
+    for (const auto& trade : cost_run.get_analytics().get_trades()) cost_pnl += trade.pnl;
+    REQUIRE(cost_pnl < free_pnl);
+    REQUIRE(free_pnl - cost_pnl <= total + 1e-9);
+}
+
+TEST_CASE("Lot accounting handles scale-ins, partial exits and reversals", "[analytics]") {
+    auto fill = [](Order::Type type, int size, double price, const char* ts) {
+        return Fill(Order(type, size, price), price, size, ts, 0.0);
+    };
+    
+    Analytics fifo;
+    fifo.record_fill(fill(Order::BUY, 100, 10.0, "t1"), Regime::TREND, 99000.0, 1000.0);
+    const Fill& added = fifo.record_fill(fill(Order::BUY, 100, 12.0, "t2"), Regime::SIDEWAYS, 97800.0, 2400.0);
+    REQUIRE(added.realized_pnl == 0.0);
+    REQUIRE(added.unrealized_pnl == Approx(2400.0 - 2200.0));
+    
+    // Partial exit closes the oldest lot, then part of the next
+    const Fill& partial = fifo.record_fill(fill(Order::SELL, 150, 13.0, "t3"), Regime::TREND, 99750.0, 650.0);
+    REQUIRE(partial.realized_pnl == Approx(300.0 + 50.0));
+    REQUIRE(partial.unrealized_pnl == Approx(650.0 - 600.0));
+    REQUIRE(fifo.open_quantity() == 50);
+    
+    // Reversal: close the last 50 long, open 100 short
+    const Fill& reversal = fifo.record_fill(fill(Order::SELL, 150, 14.0, "t4"), Regime::VOLATILE, 101850.0, -1400.0);
+    REQUIRE(reversal.realized_pnl == Approx(100.0));
+    REQUIRE(fifo.open_quantity() == -100);
+    fifo.record_fill(fill(Order::BUY, 100, 13.0, "t5"), Regime::TREND, 100550.0, 0.0);
+    REQUIRE(fifo.open_quantity() == 0);
+    
+    const auto& trades = fifo.get_trades();
+    REQUIRE(trades.size() == 4);
+    REQUIRE(trades[0].entry_timestamp == "t1");
+    REQUIRE(trades[0].size == 100);
+    REQUIRE(trades[1].entry_timestamp == "t2");
+    REQUIRE(trades[1].entry_regime == Regime::SIDEWAYS);
+    REQUIRE(trades[1].size == 50);
+    REQUIRE(trades[2].size == 50);
+    REQUIRE(trades[3].entry_timestamp == "t4");
+    REQUIRE(trades[3].pnl == Approx(100.0));
+    REQUIRE(fifo.realized_pnl() == Approx(550.0));
+    
+    // Average cost: one lot at 11, same realized total once flat
+    Analytics average;
+    average.set_lot_method(StrategyConfig::LotMethod::AVERAGE);
+    average.record_fill(fill(Order::BUY, 100, 10.0, "t1"), Regime::TREND, 99000.0, 1000.0);
+    average.record_fill(fill(Order::BUY, 100, 12.0, "t2"), Regime::TREND, 97800.0, 2400.0);
+    REQUIRE(average.record_fill(fill(Order::SELL, 150, 13.0, "t3"), Regime::TREND, 99750.0, 650.0).realized_pnl ==
+            Approx(150.0 * 2.0));
+    average.record_fill(fill(Order::SELL, 50, 13.0, "t4"), Regime::TREND, 100400.0, 0.0);
+    REQUIRE(average.realized_pnl() == Approx(300.0 + 100.0));
+    
+    // Entry costs are split pro rata across partial exits
+    Analytics costly;
+    Fill entry = fill(Order::BUY, 100, 10.0, "t1");
+    entry.commission = 2.0;
+    Fill first = fill(Order::SELL, 40, 11.0, "t2");
+    first.fees = 1.0;
+    Fill second = fill(Order::SELL, 60, 11.0, "t3");
+    second.fees = 1.0;
+    costly.record_fill(entry, Regime::TREND, 98998.0, 1000.0);
+    costly.record_fill(first, Regime::TREND, 99437.0, 660.0);
+    costly.record_fill(second, Regime::TREND, 100096.0, 0.0);
+    REQUIRE(costly.get_trades()[0].pnl == Approx(40.0 - 0.8 - 1.0));
+    REQUIRE(costly.get_trades()[1].pnl == Approx(60.0 - 1.2 - 1.0));
+    REQUIRE(costly.realized_pnl() == Approx(100.0 - 4.0));
+}
+
+TEST_CASE("Session calendar indexes trading days and annualizes from them", "[calendar]") {
+    // Two NSE sessions of 1-minute bars, Friday then Monday
+    std::vector<OHLCV> bars = make_bars(6);
+    const char* stamps[] = {"2024-01-05 09:15:00", "2024-01-05 09:16:00", "2024-01-05 15:29:00",
+                            "2024-01-08 09:15:00", "2024-01-08 09:16:00", "2024-01-08 09:17:00"};
+    for (size_t i = 0; i < bars.size(); ++i) bars[i].timestamp = stamps[i];
+    
+    StrategyConfig::CalendarConfig nse;
+    REQUIRE(SessionCalendar::apply_market("nse", nse));
+    REQUIRE_FALSE(SessionCalendar::apply_market("moon", nse));
+    SessionCalendar calendar(nse);
+    REQUIRE(calendar.bars_per_day() == 375.0);
+    calendar.index(bars);
+    REQUIRE(calendar.trading_days() == 2);
+    REQUIRE(calendar.years() == Approx(2.0 / 250.0));
+    REQUIRE(calendar.session_start(0));
+    REQUIRE_FALSE(calendar.overnight_gap(0));
+    REQUIRE_FALSE(calendar.session_start(2));
+    REQUIRE(calendar.session_start(3));
+    REQUIRE(calendar.overnight_gap(3));
+    REQUIRE(calendar.trading_day(5) == 1);
+    
+    // Round the clock: a new date is a new session but not a gap
+    StrategyConfig::CalendarConfig crypto;
+    SessionCalendar::apply_market("crypto", crypto);
+    std::vector<OHLCV> night = make_bars(2);
+    night[0].timestamp = "2024-01-05 23:59:00";
+    night[1].timestamp = "2024-01-06 00:00:00";
+    SessionCalendar clock(crypto);
+    clock.index(night);
+    REQUIRE(clock.session_start(1));
+    REQUIRE_FALSE(clock.overnight_gap(1));
+    
+    StrategyConfig::CalendarConfig custom;
+    REQUIRE(SessionCalendar::parse_session("09:00-17:30", custom));
+    REQUIRE(SessionCalendar(custom, 5).bars_per_day() == Approx(510.0 / 5.0));
+    REQUIRE_FALSE(SessionCalendar::parse_session("17:00-09:00", custom));
+    
+    // Realized vol scales with bars per year, cached or live alike
+    auto series = make_bars(300);
+    IndicatorCache cache;
+    cache.compute(series, IndicatorCache::REALIZED_VOL, 20);
+    IndicatorEngine live;
+    IndicatorEngine cached;
+    live.set_annualization(1440.0, 365.0);
+    cached.set_annualization(1440.0, 365.0);
+    cached.attach_cache(&cache);
+    IndicatorEngine standard;
+    for (const auto& bar : series) {
+        live.add_price(bar.close, bar.volume);
+        cached.add_price(bar.close, bar.volume);
+        standard.add_price(bar.close, bar.volume);
+    }
+    double scale = std::sqrt(1440.0 * 365.0 / (390.0 * 252.0));
+    REQUIRE(live.get_realized_vol(20) == Approx(standard.get_realized_vol(20) * scale));
+    REQUIRE(cached.get_realized_vol(20) == Approx(live.get_realized_vol(20)));
+    
+    // Summaries annualize over the sessions the run covered
+    BacktestRunner runner(make_config());
+    for (const auto& bar : bars) runner.on_bar(bar);
+    REQUIRE(runner.get_calendar().trading_days() == 2);
+    BacktestSummary summary = runner.summary();
+    REQUIRE(summary.annualized_return_pct ==
+            Approx((std::pow(summary.final_cash / summary.initial_cash, 252.0 / 2.0) - 1.0) * 100.0));
+}
+
+TEST_CASE("Session VWAP filters entries and benchmarks fills", "[vwap]") {
+    auto bars = make_bars(3000);
+    int64_t start = 0;
+    REQUIRE(parse_timestamp("2024-01-02 09:30:00", start));
+    for (size_t i = 0; i < bars.size(); ++i) {
+        bars[i].timestamp = format_timestamp(start + static_cast<int64_t>(i / 390) * 86400 + (i % 390) * 60, ' ');
+    }
+    
+    StrategyConfig plain = make_config();
+    StrategyConfig filtered = make_config();
+    filtered.vwap.max_entry_sigma = 0.5;
+    filtered.vwap.benchmark = true;
+    
+    BacktestRunner plain_run(plain);
+    BacktestRunner vwap_run(filtered);
+    size_t sessions = 0;
+    for (const auto& bar : bars) {
+        plain_run.on_bar(bar);
+        vwap_run.on_bar(bar);
+        sessions = vwap_run.get_calendar().trading_days();
+        // The profile only ever holds the current session
+        REQUIRE(vwap_run.get_indicators().get_session().volume() <= 390.0 * 1500.0);
+    }
+    REQUIRE(sessions == 8);
+    
+    BacktestSummary plain_summary = plain_run.summary();
+    BacktestSummary vwap_summary = vwap_run.summary();
+    REQUIRE(plain_summary.vwap_shortfall_bps == 0.0);
+    REQUIRE(vwap_summary.total_trades < plain_summary.total_trades);
+    REQUIRE(vwap_summary.vwap_shortfall_bps != 0.0);
+    for (const auto& fill : vwap_run.get_analytics().get_fills()) {
+        REQUIRE(fill.vwap > 0.0);
+    }
+}
+
+TEST_CASE("Run journal replays state at any timestamp", "[journal]") {
+    auto bars = make_bars(3000);
+    int64_t start = 0;
+    REQUIRE(parse_timestamp("2024-01-02 00:00:00", start));
+    for (size_t i = 0; i < bars.size(); ++i) {
+        bars[i].timestamp = format_timestamp(start + static_cast<int64_t>(i) * 3600, ' ');
+    }
+    
+    const std::string path = "test_run.fxj";
+    JournalWriter writer;
+    REQUIRE(writer.open(path, "test journal"));
+    BacktestRunner runner(make_config());
+    runner.attach_journal(&writer);
+    
+    // Snapshot the executor halfway through to check a mid-run replay
+    const size_t half = bars.size() / 2;
+    Position half_position;
+    double half_cash = 0.0;
+    for (size_t i = 0; i < bars.size(); ++i) {
+        runner.on_bar(bars[i]);
+        if (i == half) {
+            half_position = runner.get_executor().get_position();
+            half_cash = runner.get_executor().get_cash();
+        }
+    }
+    REQUIRE(writer.close());
+    
+    JournalReader reader;
+    REQUIRE(reader.open(path));
+    REQUIRE(reader.label() == "test journal");
+    REQUIRE(reader.size() == writer.events());
+    
+    std::vector<JournalEvent> events;
+    REQUIRE(reader.read(0, reader.size(), events));
+    size_t fills = 0;
+    for (size_t i = 0; i < events.size(); ++i) {
+        if (events[i].type == JournalEvent::FILL) ++fills;
+        if (i > 0) REQUIRE(events[i].time >= events[i - 1].time);
+    }
+    REQUIRE(fills == runner.get_analytics().get_fills().size());
+    REQUIRE(fills > 0);
+    
+    int64_t half_time = 0;
+    REQUIRE(parse_timestamp(bars[half].timestamp, half_time));
+    JournalReader::State state = reader.state_at(half_time);
+    REQUIRE(state.has_position);
+    REQUIRE(state.position == half_position.size);
+    REQUIRE(state.cash == half_cash);
+    
+    int64_t end_time = 0;
+    REQUIRE(parse_timestamp(bars.back().timestamp, end_time));
+    state = reader.state_at(end_time);
+    REQUIRE(state.position == runner.get_executor().get_position().size);
+    REQUIRE(state.cash == runner.get_executor().get_cash());
+    REQUIRE(state.realized_pnl == runner.get_executor().get_position().realized_pnl);
+    REQUIRE(state.has_regime);
+    
+    REQUIRE(reader.upper_bound(end_time) == reader.size());
+    REQUIRE(reader.upper_bound(start - 1) == 0);
+    REQUIRE_FALSE(reader.state_at(start - 1).has_position);
+    
+    // A label size past the end of the file is rejected before allocating
+    {
+        std::fstream corrupt(path, std::ios::in | std::ios::out | std::ios::binary);
+        uint32_t huge = 0xfffffff0u;
+        corrupt.seekp(8); // after magic and record size
+        corrupt.write(reinterpret_cast<const char*>(&huge), sizeof(huge));
+    }
+    JournalReader corrupt_reader;
+    REQUIRE_FALSE(corrupt_reader.open(path));
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Pipelined run matches a serial run bar for bar", "[pipeline]") {
+    // Several read batches, with malformed rows mixed in
+    std::string path = "test_engine_pipeline.csv";
+    auto bars = make_bars(60000);
+    {
+        std::ofstream out(path);
+        out << "timestamp,open,high,low,close,volume\n";
+        for (size_t i = 0; i < bars.size(); ++i) {
+            if (i % 20000 == 11) out << "garbage,row\n";
+            out << format_timestamp(1704186000 + static_cast<int64_t>(i) * 60, 'T') << "," << bars[i].open << ","
+                << bars[i].high << "," << bars[i].low << "," << bars[i].close << "," << bars[i].volume << "\n";
+        }
+    }
+    
+    StrategyConfig config = make_config();
+    BacktestRunner serial(config);
+    DataLoader serial_loader(path);
+    while (serial_loader.has_next()) serial.on_bar(serial_loader.next());
+    
+    BacktestRunner piped(config);
+    DataLoader piped_loader(path);
+    BacktestPipeline pipeline(piped);
+    pipeline.run(piped_loader);
+    std::remove(path.c_str());
+    std::remove(DataIndex::sidecar_path(path).c_str());
+    
+    REQUIRE(piped.get_tick_count() == bars.size());
+    REQUIRE(piped.get_tick_count() == serial.get_tick_count());
+    REQUIRE(pipeline.bad_rows() + piped_loader.get_bad_rows() == 3);
+    
+    const auto& expected = serial.get_analytics().get_fills();
+    const auto& actual = piped.get_analytics().get_fills();
+    REQUIRE(expected.size() > 10);
+    REQUIRE(actual.size() == expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        REQUIRE(actual[i].timestamp == expected[i].timestamp);
+        REQUIRE(actual[i].fill_price == expected[i].fill_price);
+    }
+    const auto& serial_trades = serial.get_analytics().get_trades();
+    const auto& piped_trades = piped.get_analytics().get_trades();
+    REQUIRE(piped_trades.size() == serial_trades.size());
+    for (size_t i = 0; i < serial_trades.size(); ++i) {
+        REQUIRE(piped_trades[i].entry_regime == serial_trades[i].entry_regime);
+        REQUIRE(piped_trades[i].exit_regime == serial_trades[i].exit_regime);
+    }
+    REQUIRE(piped.get_executor().get_cash() == serial.get_executor().get_cash());
+    REQUIRE(piped.summary().sharpe_ratio == serial.summary().sharpe_ratio);
+}
+
+TEST_CASE("Embedding API matches the runner and streams bar by bar", "[api]") {
+    const std::string yaml =
+        "strategy:\n"
+        "  name: embedded\n"
+        "  entry:\n"
+        "    fast: 5\n"
+        "    slow: 15\n"
+        "  exit:\n"
+        "    stop_loss_pct: 1.0\n"
+        "    take_profit_pct: 2.0\n";
+    
+    auto source = make_bars(3000);
+    std::vector<api::Bar> bars;
+    for (size_t i = 0; i < source.size(); ++i) {
+        api::Bar bar;
+        bar.time = 1704186000 + static_cast<int64_t>(i) * 60;
+        bar.open = source[i].open;
+        bar.high = source[i].high;
+        bar.low = source[i].low;
+        bar.close = i == 100 ? 0.0 : source[i].close; // one invalid bar
+        bar.volume = source[i].volume;
+        bars.push_back(bar);
+    }
+    
+    BacktestRunner reference(ConfigParser::parse_yaml_string(yaml));
+    for (const auto& bar : bars) {
+        OHLCV tick;
+        tick.timestamp = format_timestamp(bar.time, 'T');
+        tick.open = bar.open;
+        tick.high = bar.high;
+        tick.low = bar.low;
+        tick.close = bar.close;
+        tick.volume = static_cast<long>(bar.volume);
+        reference.on_bar(tick);
+    }
+    BacktestSummary expected = reference.summary();
+    const auto& expected_trades = reference.get_analytics().get_trades();
+    
+    std::string error;
+    auto backtest = api::Backtest::from_yaml(yaml, &error);
+    REQUIRE(backtest);
+    REQUIRE(backtest->name() == "embedded");
+    
+    api::Result result = backtest->run(bars);
+    REQUIRE(result.bars == bars.size());
+    REQUIRE(result.skipped_bars == 1);
+    REQUIRE(result.summary.total_trades == expected.total_trades);
+    REQUIRE(result.summary.total_trades > 5);
+    REQUIRE(result.summary.final_cash == expected.final_cash);
+    REQUIRE(result.summary.sharpe_ratio == expected.sharpe_ratio);
+    REQUIRE(result.trades.size() == expected_trades.size());
+    for (size_t i = 0; i < expected_trades.size(); ++i) {
+        REQUIRE(format_timestamp(result.trades[i].entry_time, 'T') == std::string_view(expected_trades[i].entry_timestamp));
+        REQUIRE(result.trades[i].pnl == expected_trades[i].pnl);
+        REQUIRE(static_cast<int>(result.trades[i].exit_regime) == static_cast<int>(expected_trades[i].exit_regime));
+    }
+    REQUIRE(result.equity_curve.size() == expected.equity_curve.size());
+    
+    // Streaming the same bars after a reset gives the same result
+    backtest->reset();
+    for (const auto& bar : api::BarSpan(bars.data(), bars.size())) backtest->add_bar(bar);
+    api::Result streamed = backtest->result();
+    REQUIRE(streamed.summary.final_cash == result.summary.final_cash);
+    REQUIRE(streamed.trades.size() == result.trades.size());
+    
+    // Starting cash carries into the summary
+    backtest->set_initial_cash(50000.0);
+    REQUIRE(backtest->run(bars).summary.initial_cash == 50000.0);
+    
+    REQUIRE_FALSE(api::Backtest::from_file("no_such_strategy.yaml", &error));
+    REQUIRE_FALSE(error.empty());
+}
+
+namespace {
+
+const char* SERVER_STRATEGY = "strategy:\\n  name: served\\n  entry:\\n    fast: 5\\n    slow: 15\\n";
+
+std::string server_csv(size_t count) {
+    auto bars = make_bars(count);
+    std::string csv = "timestamp,open,high,low,close,volume\n";
+    for (size_t i = 0; i < bars.size(); ++i) {
+        csv += format_timestamp(1704186000 + static_cast<int64_t>(i) * 60, 'T') + "," +
+               std::to_string(bars[i].open) + "," + std::to_string(bars[i].high) + "," +
+               std::to_string(bars[i].low) + "," + std::to_string(bars[i].close) + "," +
+               std::to_string(bars[i].volume) + "\n";
+    }
+    return csv;
+}
+
+#ifndef _WIN32
+
+// A server on a Unix socket, running on its own thread for one test
+struct ServerThread {
+    BacktestServer server;
+    std::thread thread;
+    
+    explicit ServerThread(const ServerOptions& options) : server(options), thread([this] { server.run(); }) {}
+    ~ServerThread() {
+        server.stop();
+        thread.join();
+    }
+};
+
+// Send `request` and read until the server closes the connection; retries
+// while the server is still starting
+std::string socket_request(const std::string& socket_path, const std::string& request) {
+    for (int attempt = 0; attempt < 300; ++attempt) {
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            ::close(fd);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+        size_t sent = 0;
+        while (sent < request.size()) {
+            ssize_t n = ::send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) break;
+            sent += static_cast<size_t>(n);
+        }
+        std::string reply;
+        char buffer[4096];
+        ssize_t n;
+        while ((n = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) reply.append(buffer, static_cast<size_t>(n));
+        ::close(fd);
+        return reply;
+    }
+    return "";
+}
+
+std::string http_post(const std::string& path, const std::string& body, const std::string& extra_headers = "") {
+    return "POST " + path + " HTTP/1.1\r\nHost: localhost\r\n" + extra_headers +
+           "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+}
+
+#endif
+
+} // namespace
+
+TEST_CASE("Server reads data_path only under its data root", "[server]") {
+    namespace fs = std::filesystem;
+    fs::path root = fs::absolute("test_engine_data_root");
+    fs::create_directories(root / "inner");
+    std::ofstream(root / "inner" / "bars.csv") << server_csv(300);
+    std::ofstream("test_engine_outside.csv") << server_csv(300);
+    
+    auto request = [](const std::string& data_path) {
+        return std::string("{\"strategy\": \"") + SERVER_STRATEGY + "\", \"data_path\": \"" + data_path + "\"}";
+    };
+    int status = 0;
+    
+    // No root configured: files are never opened, whatever the path
+    ServerOptions closed;
+    closed.port = 0;
+    BacktestServer inline_only(closed);
+    inline_only.handle("POST", "/api/backtest", request((root / "inner" / "bars.csv").string()), status);
+    REQUIRE(status == 403);
+    
+    ServerOptions options;
+    options.port = 0;
+    options.data_root = root.string();
+    BacktestServer server(options);
+    std::string body = server.handle("POST", "/api/backtest", request("inner/bars.csv"), status);
+    REQUIRE(status == 200);
+    REQUIRE(body.find("total_trades") != std::string::npos);
+    REQUIRE(server.handle("POST", "/api/backtest", request((root / "inner" / "bars.csv").string()), status) == body);
+    
+    // Escapes and missing files get the same answer
+    std::string denied = server.handle("POST", "/api/backtest", request("../test_engine_outside.csv"), status);
+    REQUIRE(status == 403);
+    REQUIRE(server.handle("POST", "/api/backtest", request(fs::absolute("test_engine_outside.csv").string()),
+                          status) == denied);
+    REQUIRE(server.handle("POST", "/api/backtest", request("inner/missing.csv"), status) == denied);
+    REQUIRE(server.handle("POST", "/api/backtest", request("inner"), status) == denied);
+    
+    // Regime model files follow the same rule
+    auto with_model = [](const std::string& model_path) {
+        return std::string("{\"strategy\": \"") + SERVER_STRATEGY + "regime:\\n  model: hmm\\n  model_path: " +
+               model_path + "\\n\", \"data_path\": \"inner/bars.csv\"}";
+    };
+    for (BacktestServer* target : {&inline_only, &server}) {
+        std::string refused = target->handle("POST", "/api/backtest", with_model("/etc/passwd"), status);
+        REQUIRE(status == 403);
+        REQUIRE(refused.find("model_path") != std::string::npos);
+        target->handle("POST", "/api/sweep", with_model("../test_engine_outside.csv"), status);
+        REQUIRE(status == 403);
+    }
+    // Not a model: falls back to threshold regimes, like the CLI
+    REQUIRE(server.handle("POST", "/api/backtest", with_model("inner/bars.csv"), status) == body);
+    REQUIRE(status == 200);
+    
+    // Inline data still works everywhere
+    std::string csv;
+    for (char c : server_csv(300)) csv += c == '\n' ? std::string("\\n") : std::string(1, c);
+    inline_only.handle("POST", "/api/backtest",
+                       std::string("{\"strategy\": \"") + SERVER_STRATEGY + "\", \"data\": \"" + csv + "\"}", status);
+    REQUIRE(status == 200);
+    
+    fs::remove_all(root);
+    fs::remove("test_engine_outside.csv");
+}
+
+TEST_CASE("Server decodes request strings and reports bad requests", "[server]") {
+    namespace fs = std::filesystem;
+    fs::path root = fs::absolute("test_engine_unicode_root");
+    fs::create_directories(root);
+    std::ofstream(root / "caf\xC3\xA9.csv") << server_csv(300);           // U+00E9
+    std::ofstream(root / "\xF0\x9F\x93\x88.csv") << server_csv(300);      // U+1F4C8, a surrogate pair in JSON
+    
+    ServerOptions options;
+    options.port = 0;
+    options.data_root = root.string();
+    BacktestServer server(options);
+    int status = 0;
+    auto post = [&](const std::string& fields) {
+        return server.handle("POST", "/api/backtest", std::string("{\"strategy\": \"") + SERVER_STRATEGY + "\", " + fields + "}",
+                             status);
+    };
+    
+    post("\"data_path\": \"caf\\u00e9.csv\"");
+    REQUIRE(status == 200);
+    post("\"data_path\": \"\\ud83d\\udcc8.csv\"");
+    REQUIRE(status == 200);
+    post("\"data_path\": \"\\/caf\\u00E9.csv\""); // "/café.csv" is outside the root
+    REQUIRE(status == 403);
+    
+    // Malformed strings are rejected, not guessed at
+    for (const char* bad : {"\"data_path\": \"\\ud83d.csv\"", "\"data_path\": \"\\udcc8.csv\"",
+                            "\"data_path\": \"\\u00zz.csv\"", "\"data_path\": \"\\x41.csv\"",
+                            "\"data_path\": \"unterminated"}) {
+        std::string body = post(bad);
+        REQUIRE(status == 400);
+        REQUIRE(body.find("Malformed JSON string") != std::string::npos);
+    }
+    
+    server.handle("POST", "/api/backtest", "{\"data\": \"x\"}", status);
+    REQUIRE(status == 400); // no strategy
+    std::string body = post("\"data\": \"timestamp,open,high,low,close,volume\\nnot,a,bar\\n\"");
+    REQUIRE(status == 400);
+    REQUIRE(body.find("No valid bars") != std::string::npos);
+    server.handle("GET", "/api/nothing", "", status);
+    REQUIRE(status == 404);
+    REQUIRE(server.handle("GET", "/health", "", status).find("\"datasets\": 2") != std::string::npos);
+    REQUIRE(status == 200);
+    
+    fs::remove_all(root);
+}
+
+TEST_CASE("Server bounds sweep grids and worker counts", "[server]") {
+    std::string csv;
+    for (char c : server_csv(300)) csv += c == '\n' ? std::string("\\n") : std::string(1, c);
+    auto request = [&](const std::string& entry, const std::string& parallel) {
+        return "{\"strategy\": \"strategy:\\n  name: swept\\n  entry:\\n" + entry + "\", \"data\": \"" + csv +
+               "\", \"parallel\": " + parallel + "}";
+    };
+    
+    ServerOptions options;
+    options.port = 0;
+    options.max_grid = 4;
+    BacktestServer server(options);
+    int status = 0;
+    
+    // 3 x 2 configs: refused before anything is expanded or run
+    server.handle("POST", "/api/sweep", request("    fast: [3, 4, 5]\\n    slow: [10, 15]\\n", "1"), status);
+    REQUIRE(status == 413);
+    
+    // Absurd thread counts are clamped rather than spawned
+    for (const char* parallel : {"1000000", "-5"}) {
+        std::string body = server.handle("POST", "/api/sweep", request("    fast: [3, 4, 5]\\n    slow: 15\\n", parallel),
+                                         status);
+        REQUIRE(status == 200);
+        size_t configs = 0;
+        for (size_t at = body.find("\"fast\""); at != std::string::npos; at = body.find("\"fast\"", at + 1)) {
+            configs++;
+        }
+        REQUIRE(configs == 3);
+    }
+}
+
+#ifndef _WIN32
+
+TEST_CASE("Server sends CORS headers only to the allowed origin", "[server]") {
+    ServerOptions options;
+    options.port = 0;
+    options.socket_path = "test_engine_cors.sock";
+    options.allowed_origin = "https://app.example.com";
+    ServerThread running(options);
+    
+    std::string preflight = "OPTIONS /api/backtest HTTP/1.1\r\nHost: localhost\r\n"
+                            "Origin: https://app.example.com\r\nAccess-Control-Request-Method: POST\r\n\r\n";
+    std::string reply = socket_request(options.socket_path, preflight);
+    REQUIRE(reply.rfind("HTTP/1.1 204", 0) == 0);
+    REQUIRE(reply.find("Access-Control-Allow-Origin: https://app.example.com\r\n") != std::string::npos);
+    
+    std::string get = "GET /health HTTP/1.1\r\nHost: localhost\r\nOrigin: https://evil.example\r\n\r\n";
+    reply = socket_request(options.socket_path, get);
+    REQUIRE(reply.rfind("HTTP/1.1 200", 0) == 0);
+    REQUIRE(reply.find("Access-Control-Allow-Origin") == std::string::npos);
+    
+    reply = socket_request(options.socket_path, "GET /health HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    REQUIRE(reply.find("Access-Control-Allow-Origin") == std::string::npos);
+    REQUIRE(reply.find("\"status\": \"ok\"") != std::string::npos);
+}
+
+TEST_CASE("Server times out slow clients and caps request sizes", "[server]") {
+    ServerOptions options;
+    options.port = 0;
+    options.socket_path = "test_engine_limits.sock";
+    options.request_timeout_ms = 200;
+    options.max_header_bytes = 1024;
+    options.max_body_bytes = 4096;
+    ServerThread running(options);
+    
+    // Headers never finish: answered once the timeout passes
+    auto start = std::chrono::steady_clock::now();
+    std::string reply = socket_request(options.socket_path, "POST /api/backtest HTTP/1.1\r\nHost: local");
+    REQUIRE(reply.rfind("HTTP/1.1 408", 0) == 0);
+    REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+    
+    // Body shorter than announced
+    reply = socket_request(options.socket_path, "POST /api/backtest HTTP/1.1\r\nContent-Length: 100\r\n\r\n{}");
+    REQUIRE(reply.rfind("HTTP/1.1 408", 0) == 0);
+    
+    // Oversized body refused from the header alone; oversized headers too
+    reply = socket_request(options.socket_path, "POST /api/backtest HTTP/1.1\r\nContent-Length: 1000000000\r\n\r\n");
+    REQUIRE(reply.rfind("HTTP/1.1 413", 0) == 0);
+    reply = socket_request(options.socket_path, "GET /health HTTP/1.1\r\nX-Padding: " + std::string(1500, 'x'));
+    REQUIRE(reply.rfind("HTTP/1.1 413", 0) == 0);
+    
+    // Requests within the limits are unaffected
+    reply = socket_request(options.socket_path, http_post("/api/backtest", "{\"strategy\": \"\"}"));
+    REQUIRE(reply.rfind("HTTP/1.1 400", 0) == 0);
+}
+
+#endif
+
+#ifdef __linux__
+
+TEST_CASE("Live runner follows appended rows and escapes its NDJSON", "[live]") {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "fluxback_live_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    fs::path feed = dir / "feed.csv";
+    
+    // Quotes and a backslash in the timestamps have to come out escaped
+    auto bars = make_bars(400);
+    std::vector<std::string> rows;
+    for (size_t i = 0; i < bars.size(); ++i) {
+        rows.push_back("bar \"" + std::to_string(i) + "\\x\"," + std::to_string(bars[i].open) + "," +
+                       std::to_string(bars[i].high) + "," + std::to_string(bars[i].low) + "," +
+                       std::to_string(bars[i].close) + "," + std::to_string(bars[i].volume));
+    }
+    
+    BacktestRunner expected(make_config());
+    for (const auto& row : rows) {
+        OHLCV bar;
+        REQUIRE(DataLoader::parse_line(row, bar));
+        expected.on_bar(bar);
+    }
+    const auto& fills = expected.get_analytics().get_fills();
+    REQUIRE(fills.size() > 2);
+    
+    {
+        std::ofstream csv(feed);
+        csv << "timestamp,open,high,low,close,volume\n";
+        for (size_t i = 0; i < rows.size() / 2; ++i) csv << rows[i] << "\n";
+    }
+    
+    std::FILE* out = std::tmpfile();
+    REQUIRE(out != nullptr);
+    LiveOptions options;
+    options.follow_path = feed.string();
+    LiveRunner live(make_config(), options, out);
+    std::thread follower([&] { live.run(); });
+    
+    // Output is flushed per fill, so once some shows up the file is watched
+    struct stat info{};
+    for (int i = 0; i < 500 && (::fstat(::fileno(out), &info) != 0 || info.st_size == 0); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE(info.st_size > 0);
+    {
+        std::ofstream csv(feed, std::ios::app);
+        for (size_t i = rows.size() / 2; i < rows.size(); ++i) csv << rows[i] << "\n";
+    }
+    
+    // Moving the file away ends the run once the appended rows are read
+    fs::rename(feed, dir / "feed.old");
+    follower.join();
+    REQUIRE(live.get_bar_count() == rows.size());
+    
+    std::rewind(out);
+    std::vector<std::string> lines;
+    char buffer[1024];
+    while (std::fgets(buffer, sizeof(buffer), out)) lines.push_back(buffer);
+    std::fclose(out);
+    
+    REQUIRE(lines.size() == 2 * fills.size());
+    for (size_t i = 0; i < fills.size(); ++i) {
+        const std::string& order = lines[2 * i];
+        const std::string& fill = lines[2 * i + 1];
+        REQUIRE(order.rfind("{\"type\":\"order\",", 0) == 0);
+        REQUIRE(fill.rfind("{\"type\":\"fill\",", 0) == 0);
+        REQUIRE(order.back() == '\n');
+        REQUIRE(order.find("}\n") == order.size() - 2);
+        
+        // bar "12\x" is written as "bar \"12\\x\""
+        std::string escaped(fills[i].timestamp);
+        REQUIRE(escaped.find('"') != std::string::npos);
+        size_t pos = 0;
+        while ((pos = escaped.find_first_of("\"\\", pos)) != std::string::npos) {
+            escaped.insert(pos, 1, '\\');
+            pos += 2;
+        }
+        REQUIRE(fill.find("\"timestamp\":\"" + escaped + "\",") != std::string::npos);
+        
+        char price[32];
+        std::snprintf(price, sizeof(price), "\"fill_price\":%.4f,", fills[i].fill_price);
+        REQUIRE(fill.find(price) != std::string::npos);
+    }
+    
+    fs::remove_all(dir);
+}
+
+TEST_CASE("Live runner keeps a half-written row when stopped by a signal", "[live]") {
+    namespace fs = std::filesystem;
+    fs::path feed = fs::temp_directory_path() / "fluxback_live_partial.csv";
+    {
+        // The last row is cut short in its volume field but still parses
+        std::ofstream csv(feed);
+        csv << "timestamp,open,high,low,close,volume\n";
+        for (int i = 0; i < 10; ++i) csv << "2024-01-02 09:" << 10 + i << ":00,100,101,99,100,1000\n";
+        csv << "2024-01-02 09:20:00,100,101,99,100,10";
+    }
+    
+    std::FILE* out = std::tmpfile();
+    REQUIRE(out != nullptr);
+    LiveOptions options;
+    options.follow_path = feed.string();
+    LiveRunner followed(make_config(), options, out);
+    std::thread follower([&] { followed.run(); });
+    for (int i = 0; i < 500 && followed.get_bar_count() < 10; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE(followed.get_bar_count() == 10);
+    std::raise(SIGINT); // run() has installed its handler by now
+    follower.join();
+    REQUIRE(followed.get_bar_count() == 10);
+    
+    // At a real end of input the trailing row is a complete bar
+    options.follow = false;
+    LiveRunner once(make_config(), options, out);
+    REQUIRE(once.run() == 0);
+    REQUIRE(once.get_bar_count() == 11);
+    
+    std::fclose(out);
+    fs::remove(feed);
+}
+
+#endif
+
+TEST_CASE("SPSC ring hands every value over in order under contention", "[concurrency]") {
+    const uint64_t count = 1000000;
+    SpscRing<uint64_t> ring(64);
+    std::thread producer([&]() {
+        for (uint64_t i = 1; i <= count; ++i) {
+            while (!ring.try_push(i)) std::this_thread::yield();
+        }
+    });
+    
+    uint64_t expected = 1;
+    uint64_t buffer[16];
+    while (expected <= count) {
+        size_t n = ring.pop_bulk(buffer, 16);
+        for (size_t i = 0; i < n; ++i) {
+            if (buffer[i] != expected) FAIL("out of order: " << buffer[i] << " != " << expected);
+            ++expected;
+        }
+        if (n == 0) std::this_thread::yield();
+    }
+    producer.join();
+    REQUIRE(ring.empty());
+}
+
+TEST_CASE("MPSC ring keeps each producer's order and loses nothing", "[concurrency]") {
+    const int producers = 4;
+    const uint64_t per_producer = 200000;
+    MpscRing<uint64_t> ring(128);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&ring, p, per_producer]() {
+            for (uint64_t i = 0; i < per_producer; ++i) {
+                uint64_t value = (static_cast<uint64_t>(p) << 32) | i;
+                while (!ring.try_push(value)) std::this_thread::yield();
+            }
+        });
+    }
+    
+    std::vector<uint64_t> next(producers, 0);
+    uint64_t received = 0;
+    while (received < producers * per_producer) {
+        uint64_t value;
+        if (!ring.try_pop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        size_t p = static_cast<size_t>(value >> 32);
+        if ((value & 0xffffffffu) != next[p]) FAIL("producer " << p << " out of order");
+        ++next[p];
+        ++received;
+    }
+    for (auto& t : threads) t.join();
+    for (uint64_t n : next) REQUIRE(n == per_producer);
+    uint64_t extra;
+    REQUIRE_FALSE(ring.try_pop(extra));
+}
+
+TEST_CASE("Thread pool runs every task once, nested, with worker-local state", "[concurrency]") {
+    // Fewer workers than slots, and every task waits on tasks of its own
+    ThreadPool pool(2);
+    const size_t outer = 64;
+    const size_t inner = 200;
+    std::vector<std::atomic<int>> hits(outer * inner);
+    for (auto& h : hits) h.store(0);
+    WorkerLocal<size_t> done(pool);
+    
+    pool.parallel_for(outer, 8, [&](size_t i) {
+        pool.parallel_for(inner, 4, [&](size_t j) {
+            hits[i * inner + j].fetch_add(1);
+            ++done.local();
+        });
+    });
+    for (const auto& h : hits) REQUIRE(h.load() == 1);
+    size_t total = 0;
+    done.for_each([&](size_t n) { total += n; });
+    REQUIRE(total == outer * inner);
+    
+    // Slots beyond the pool's size still all run
+    std::vector<int> slots(16, 0);
+    pool.run_workers(16, [&](int slot) { slots[static_cast<size_t>(slot)]++; });
+    for (int n : slots) REQUIRE(n == 1);
+    
+    // Groups wait for tasks submitted from inside other tasks
+    std::atomic<int> leaves{0};
+    {
+        TaskGroup group(pool);
+        for (int t = 0; t < 50; ++t) {
+            group.run([&]() {
+                TaskGroup children(pool);
+                for (int c = 0; c < 10; ++c) children.run([&]() { leaves.fetch_add(1); });
+            });
+        }
+        group.wait();
+        REQUIRE(leaves.load() == 500);
+    }
+}
+
+TEST_CASE("Async exporter runs every job and waits without polling", "[concurrency]") {
+    AsyncExporter exporter;
+    exporter.wait(); // nothing submitted yet
+    
+    // More jobs than the queue holds, from several threads, so submit()
+    // has to wait for room
+    std::atomic<int> ran{0};
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 4; ++p) {
+        producers.emplace_back([&]() {
+            for (int i = 0; i < 1000; ++i) exporter.submit([&]() { ran.fetch_add(1); });
+        });
+    }
+    for (auto& producer : producers) producer.join();
+    exporter.wait();
+    REQUIRE(ran.load() == 4000);
+    
+    // A slow job is still waited for after the worker went idle
+    exporter.submit([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ran.fetch_add(1);
+    });
+    exporter.wait();
+    REQUIRE(ran.load() == 4001);
+}
+
+// Not run by ctest; `test_engine "[benchmark]"` prints throughput
+TEST_CASE("Concurrency primitive throughput", "[.][benchmark]") {
+    using Clock = std::chrono::steady_clock;
+    auto rate = [](uint64_t ops, Clock::time_point start) {
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        return static_cast<double>(ops) / seconds / 1e6;
+    };
+    const uint64_t count = 20000000;
+    
+    {
+        SpscRing<uint64_t> ring(4096);
+        auto start = Clock::now();
+        std::thread producer([&]() {
+            for (uint64_t i = 0; i < count; ++i) {
+                while (!ring.try_push(i)) std::this_thread::yield();
+            }
+        });
+        uint64_t received = 0;
+        uint64_t buffer[256];
+        while (received < count) {
+            size_t n = ring.pop_bulk(buffer, 256);
+            received += n;
+            if (n == 0) std::this_thread::yield();
+        }
+        producer.join();
+        std::cout << "SPSC ring:        " << rate(count, start) << " M values/s\n";
+    }
+    
+    for (int producers : {1, 4}) {
+        MpscRing<uint64_t> ring(4096);
+        uint64_t per_producer = count / 4 / static_cast<uint64_t>(producers);
+        auto start = Clock::now();
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&]() {
+                for (uint64_t i = 0; i < per_producer; ++i) {
+                    while (!ring.try_push(i)) std::this_thread::yield();
+                }
+            });
+        }
+        uint64_t received = 0;
+        uint64_t value;
+        while (received < per_producer * producers) {
+            if (ring.try_pop(value)) {
+                ++received;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        for (auto& t : threads) t.join();
+        std::cout << "MPSC ring, " << producers << " producer(s): " << rate(received, start) << " M values/s\n";
+    }
+    
+    {
+        ThreadPool& pool = ThreadPool::shared();
+        const uint64_t tasks = 1000000;
+        std::atomic<uint64_t> sum{0};
+        auto start = Clock::now();
+        {
+            TaskGroup group(pool);
+            for (uint64_t i = 0; i < tasks; ++i) {
+                group.run([&sum]() { sum.fetch_add(1, std::memory_order_relaxed); });
+            }
+        }
+        std::cout << "Thread pool (" << pool.size() << " workers): " << rate(tasks, start) << " M tasks/s\n";
+        REQUIRE(sum.load() == tasks);
+    }
+}
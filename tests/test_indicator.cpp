@@ -1,7 +1,9 @@
 #define CATCH_CONFIG_MAIN
 #include <catch2/catch.hpp>
 #include "indicators/IndicatorEngine.h"
+#include "regime/RegimeModel.h"
 #include <cmath>
+#include <cstdio>
 #include <vector>
 
 using namespace fluxback;
@@ -93,3 +95,120 @@ TEST_CASE("Indicator Reset", "[indicators]") {
     REQUIRE(sma == 0.0);
 }
 
+TEST_CASE("Session VWAP and volume profile", "[indicators]") {
+    IndicatorEngine ie;
+    ie.track_session(0.1); // buckets of 0.1 around 100.02
+    ie.add_price(100.02, 100);
+    ie.add_price(101.03, 300);
+    ie.add_price(100.06, 50);
+    
+    const SessionProfile& session = ie.get_session();
+    double vwap = (100.02 * 100 + 101.03 * 300 + 100.06 * 50) / 450.0;
+    REQUIRE(session.vwap() == Approx(vwap));
+    double variance = (100 * std::pow(100.02 - vwap, 2) + 300 * std::pow(101.03 - vwap, 2) +
+                       50 * std::pow(100.06 - vwap, 2)) / 450.0;
+    REQUIRE(session.stddev() == Approx(std::sqrt(variance)));
+    REQUIRE(session.upper_band(2.0) == Approx(vwap + 2.0 * std::sqrt(variance)));
+    REQUIRE(std::fabs(session.point_of_control() - 101.03) <= session.bucket_width() / 2.0);
+    
+    // 60% of the volume sits in the 101.03 bucket alone
+    double low = 0.0, high = 0.0;
+    REQUIRE(session.value_area(0.6, low, high));
+    REQUIRE(low <= 101.03);
+    REQUIRE(high > 101.03);
+    REQUIRE(high - low == Approx(session.bucket_width()));
+    REQUIRE(session.value_area(1.0, low, high));
+    REQUIRE(low <= 100.02);
+    REQUIRE(high > 101.03);
+    
+    // Prices past the histogram's range merge buckets instead of growing it
+    ie.add_price(180.0, 10);
+    ie.add_price(60.0, 10);
+    REQUIRE(session.bucket_width() > 0.1);
+    REQUIRE(session.volume() == 470.0);
+    REQUIRE(session.point_of_control() > 100.0);
+    REQUIRE(session.point_of_control() < 102.0);
+    
+    ie.start_session();
+    REQUIRE(session.vwap() == 0.0);
+    REQUIRE_FALSE(session.value_area(0.7, low, high));
+    ie.add_price(50.0, 10);
+    REQUIRE(session.vwap() == Approx(50.0));
+}
+
+namespace {
+
+// 5000-bar stretches cycling through three activity levels (calm, moderate,
+// volatile); `volume_noise` adds a per-bar wobble to the volume
+std::vector<OHLCV> make_regime_bars(size_t count, long volume_noise = 0) {
+    const double step_pct[] = {0.0005, 0.0015, 0.004};
+    const double wick[] = {0.02, 0.08, 0.3};
+    const long volume[] = {1000, 2500, 5000};
+    std::vector<OHLCV> bars;
+    double price = 100.0;
+    for (size_t i = 0; i < count; ++i) {
+        size_t level = (i / 5000) % 3;
+        double step = step_pct[level] * std::sin(i * 1.7) * price;
+        price += step;
+        OHLCV bar;
+        bar.close = price;
+        bar.open = price - step;
+        bar.high = std::max(bar.open, bar.close) + wick[level];
+        bar.low = std::min(bar.open, bar.close) - wick[level];
+        bar.volume = volume[level] + (volume_noise > 0 ? static_cast<long>((i * 37) % volume_noise) : 0);
+        bars.push_back(bar);
+    }
+    return bars;
+}
+
+} // namespace
+
+TEST_CASE("Fitted regime model separates calm, moderate and volatile stretches", "[regime]") {
+    const Regime expected[] = {Regime::SIDEWAYS, Regime::TREND, Regime::VOLATILE};
+    std::vector<OHLCV> bars = make_regime_bars(150000);
+    
+    RegimeModel serial, parallel;
+    REQUIRE(serial.fit(bars, 1));
+    REQUIRE(parallel.fit(bars, 4));
+    REQUIRE(serial.mean == parallel.mean); // chunked fitting ignores the thread count
+    REQUIRE(serial.transition == parallel.transition);
+    
+    const char* path = "test_regimes.model";
+    REQUIRE(serial.save(path));
+    RegimeModel loaded;
+    REQUIRE(loaded.load(path));
+    std::remove(path);
+    REQUIRE(loaded.label == serial.label);
+    REQUIRE(loaded.mean[0][0] == Approx(serial.mean[0][0]));
+    
+    for (RegimeBackend backend : {RegimeBackend::HMM, RegimeBackend::KMEANS}) {
+        RegimeDetector detector(20, std::pmr::get_default_resource(), backend, &loaded);
+        size_t right = 0, scored = 0;
+        for (size_t i = 0; i < 30000; ++i) {
+            Regime regime = detector.update_and_get(bars[i]);
+            if (i % 5000 < 100) continue; // let the window catch up after a switch
+            scored++;
+            if (regime == expected[(i / 5000) % 3]) right++;
+        }
+        REQUIRE(right > scored * 9 / 10);
+    }
+}
+
+TEST_CASE("Batch regime labels match the per-tick detector", "[regime]") {
+    std::vector<OHLCV> bars = make_regime_bars(140000, 300);
+    bars[70000].close = 0.0; // bad print: no log return into or out of it
+    
+    RegimeModel model;
+    REQUIRE(model.fit(bars, 2));
+    for (RegimeBackend backend : {RegimeBackend::THRESHOLD, RegimeBackend::HMM, RegimeBackend::KMEANS}) {
+        RegimeDetector detector(20, std::pmr::get_default_resource(), backend, &model);
+        std::vector<uint8_t> expected;
+        for (const auto& bar : bars) {
+            expected.push_back(static_cast<uint8_t>(detector.update_and_get(bar)));
+        }
+    
+        // Several chunk boundaries, in any thread order
+        REQUIRE(RegimeDetector::label_series(bars, 1, 20, backend, &model) == expected);
+        REQUIRE(RegimeDetector::label_series(bars, 3, 20, backend, &model) == expected);
+    }
+}